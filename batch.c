@@ -0,0 +1,805 @@
+/*
+ * batch.c - Struct-of-arrays simulator for many matches at once
+ * Amiga Pong - OS-friendly implementation
+ *
+ * Mirrors UpdateGame() step for step, but runs each step as its
+ * own pass over all lanes so the arrays are streamed through once
+ * per step. Any change to the physics in game.c must be repeated
+ * here; bench -verify checks the two stay bit-identical.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <exec/types.h>
+#include "game.h"
+#include "graphics.h"
+#include "batch.h"
+
+/* SSE2 is baseline on x86-64; AVX2 is picked at run time if present */
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#define PADDLE_MIN_Y  (PADDLE_HEIGHT / 2)
+#define PADDLE_MAX_Y  (SCREEN_HEIGHT - PADDLE_HEIGHT / 2)
+#define AI_PADDLE_X   (SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH)
+
+/*
+ * Where BounceBallOffPaddle() can hit: the ball overlapping the
+ * paddle's columns, or its centre crossing the contact line this step
+ */
+#define PLAYER_CONTACT_X (PLAYER_PADDLE_FACE_X + BALL_SIZE / 2)
+#define PLAYER_REACH_X   (PADDLE_OFFSET - BALL_SIZE / 2)
+#define AI_CONTACT_X     (AI_PADDLE_FACE_X - BALL_SIZE / 2)
+#define AI_REACH_X       (AI_PADDLE_FACE_X + PADDLE_WIDTH + BALL_SIZE / 2)
+
+BOOL AllocBatch(BatchGame *batch, LONG count)
+{
+    size_t n = (size_t)count;
+
+    batch->count = count;
+    batch->ballX = (LONG *)calloc(n, sizeof(LONG));
+    batch->ballY = (LONG *)calloc(n, sizeof(LONG));
+    batch->ballVX = (LONG *)calloc(n, sizeof(LONG));
+    batch->ballVY = (LONG *)calloc(n, sizeof(LONG));
+    batch->playerY = (WORD *)calloc(n, sizeof(WORD));
+    batch->playerTargetY = (WORD *)calloc(n, sizeof(WORD));
+    batch->aiY = (WORD *)calloc(n, sizeof(WORD));
+    batch->aiTargetY = (WORD *)calloc(n, sizeof(WORD));
+    batch->playerScore = (WORD *)calloc(n, sizeof(WORD));
+    batch->aiScore = (WORD *)calloc(n, sizeof(WORD));
+    batch->rallies = (WORD *)calloc(n, sizeof(WORD));
+    batch->aiUpdateTimer = (WORD *)calloc(n, sizeof(WORD));
+    batch->state = (UBYTE *)calloc(n, sizeof(UBYTE));
+    batch->difficulty = (UBYTE *)calloc(n, sizeof(UBYTE));
+    batch->servingPlayer = (UBYTE *)calloc(n, sizeof(UBYTE));
+    batch->ai = (AISettings *)calloc(n, sizeof(AISettings));
+    batch->rng = (RandomState *)calloc(n, sizeof(RandomState));
+    batch->startY = (LONG *)calloc(n, sizeof(LONG));
+    batch->contact = (UBYTE *)calloc(n, sizeof(UBYTE));
+    batch->scored = (UBYTE *)calloc(n, sizeof(UBYTE));
+
+    if (!batch->ballX || !batch->ballY || !batch->ballVX || !batch->ballVY ||
+        !batch->playerY || !batch->playerTargetY || !batch->aiY ||
+        !batch->aiTargetY || !batch->playerScore || !batch->aiScore ||
+        !batch->rallies || !batch->aiUpdateTimer || !batch->state ||
+        !batch->difficulty || !batch->servingPlayer || !batch->ai ||
+        !batch->rng || !batch->startY || !batch->contact || !batch->scored) {
+        FreeBatch(batch);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void FreeBatch(BatchGame *batch)
+{
+    free(batch->ballX);
+    free(batch->ballY);
+    free(batch->ballVX);
+    free(batch->ballVY);
+    free(batch->playerY);
+    free(batch->playerTargetY);
+    free(batch->aiY);
+    free(batch->aiTargetY);
+    free(batch->playerScore);
+    free(batch->aiScore);
+    free(batch->rallies);
+    free(batch->aiUpdateTimer);
+    free(batch->state);
+    free(batch->difficulty);
+    free(batch->servingPlayer);
+    free(batch->ai);
+    free(batch->rng);
+    free(batch->startY);
+    free(batch->contact);
+    free(batch->scored);
+    batch->count = 0;
+}
+
+/* Same as ResetBall() */
+static void ResetLaneBall(BatchGame *b, LONG i)
+{
+    LONG speed = BALL_INITIAL_SPEED;
+    LONG angle;
+
+    b->ballX[i] = INT_TO_FP(SCREEN_WIDTH / 2);
+    b->ballY[i] = INT_TO_FP(SCREEN_HEIGHT / 2);
+    b->rallies[i] = 0;
+
+    angle = INT_TO_FP((LONG)(NextRandom(&b->rng[i], 256) - 128) >> 1) >> 6;
+
+    b->ballVX[i] = b->servingPlayer[i] ? -speed : speed;
+    b->ballVY[i] = angle;
+    ScheduleAIReaction(&b->aiUpdateTimer[i], &b->ai[i]);
+}
+
+void StartBatchLane(BatchGame *batch, LONG lane, Difficulty diff, const RandomState *rng)
+{
+    if (diff > DIFFICULTY_HARD) diff = DIFFICULTY_MEDIUM;
+
+    batch->rng[lane] = *rng;
+    batch->difficulty[lane] = (UBYTE)diff;
+    batch->ai[lane] = difficultySettings[diff];
+
+    batch->playerScore[lane] = 0;
+    batch->aiScore[lane] = 0;
+    batch->servingPlayer[lane] = TRUE;
+    batch->playerY[lane] = SCREEN_HEIGHT / 2;
+    batch->playerTargetY[lane] = SCREEN_HEIGHT / 2;
+    batch->aiY[lane] = SCREEN_HEIGHT / 2;
+    batch->aiTargetY[lane] = SCREEN_HEIGHT / 2;
+    batch->aiUpdateTimer[lane] = 0;
+
+    ResetLaneBall(batch, lane);
+    batch->state[lane] = STATE_PLAYING;
+}
+
+void GetBatchLane(const BatchGame *batch, LONG lane, GameContext *ctx)
+{
+    ctx->state = (GameState)batch->state[lane];
+    ctx->difficulty = (Difficulty)batch->difficulty[lane];
+    ctx->ball.x = batch->ballX[lane];
+    ctx->ball.y = batch->ballY[lane];
+    ctx->ball.vx = batch->ballVX[lane];
+    ctx->ball.vy = batch->ballVY[lane];
+    ctx->playerPaddle.y = batch->playerY[lane];
+    ctx->playerPaddle.targetY = batch->playerTargetY[lane];
+    ctx->aiPaddle.y = batch->aiY[lane];
+    ctx->aiPaddle.targetY = batch->aiTargetY[lane];
+    ctx->playerScore = batch->playerScore[lane];
+    ctx->aiScore = batch->aiScore[lane];
+    ctx->rallies = batch->rallies[lane];
+    ctx->servingPlayer = batch->servingPlayer[lane];
+    ctx->aiUpdateTimer = batch->aiUpdateTimer[lane];
+    ctx->ai = batch->ai[lane];
+    ctx->rng = batch->rng[lane];
+    ctx->subStepShift = 0;
+}
+
+static WORD ClampW(WORD value, WORD min, WORD max)
+{
+    if (value < min) return min;
+    if (value > max) return max;
+    return value;
+}
+
+/* A reaction falls due: aim as UpdateAIPaddle() does */
+static void ReactLane(BatchGame *b, LONG i)
+{
+    const AISettings *ai = &b->ai[i];
+
+    if (b->ballVX[i] > 0) {
+        WORD predictedY = PredictIntercept(b->ballX[i], b->ballY[i],
+                                           b->ballVX[i], b->ballVY[i], AI_PADDLE_X);
+
+        if (ai->errorMargin > 0) {
+            predictedY += NextRandom(&b->rng[i], ai->errorMargin * 2 + 1) -
+                          ai->errorMargin;
+        }
+
+        b->aiTargetY[i] = ClampW(predictedY, PADDLE_MIN_Y, PADDLE_MAX_Y);
+    } else {
+        b->aiTargetY[i] = SCREEN_HEIGHT / 2;
+    }
+}
+
+/*
+ * Pass 1: player paddle follows the mouse, AI paddle as UpdateAIPaddle().
+ * Neighbouring lanes are unrelated matches, so a branch on per-lane
+ * data is mispredicted about as often as it goes either way. Only the
+ * rare reaction falls due behind a branch; the timer and the paddle
+ * move are computed the same way for every lane.
+ */
+static void PaddlesScalar(BatchGame *b, const WORD *mouseY, LONG from, LONG to)
+{
+    /* Stores through the UBYTE arrays may alias b: keep the arrays local */
+    const UBYTE *state = b->state;
+    const AISettings *ai = b->ai;
+    const LONG *ballY = b->ballY;
+    const WORD *aiTargetY = b->aiTargetY;
+    LONG *startY = b->startY;
+    WORD *playerY = b->playerY, *aiY = b->aiY, *aiUpdateTimer = b->aiUpdateTimer;
+    LONG i;
+
+    for (i = from; i < to; i++) {
+        WORD timer, diff, step, speed;
+
+        if (state[i] != STATE_PLAYING) continue;
+
+        playerY[i] = ClampW(mouseY[i], PADDLE_MIN_Y, PADDLE_MAX_Y);
+        startY[i] = ballY[i];
+
+        /* timer > 0 && --timer == 0 */
+        timer = aiUpdateTimer[i];
+        aiUpdateTimer[i] = timer - (timer > 0);
+        if (timer == 1) ReactLane(b, i);
+
+        /* At most speed towards the target, nothing inside the dead zone */
+        speed = ai[i].speed;
+        diff = aiTargetY[i] - aiY[i];
+        step = ClampW(diff, (WORD)-speed, speed);
+        step &= -(WORD)((UWORD)(diff + AI_DEAD_ZONE) > 2 * AI_DEAD_ZONE);
+        aiY[i] = ClampW((WORD)(aiY[i] + step), PADDLE_MIN_Y, PADDLE_MAX_Y);
+    }
+}
+
+/*
+ * Pass 2: integrate ball position and bounce off the top/bottom walls,
+ * flagging in b->contact the lanes the collision pass has to look at.
+ * Lanes that are not playing are left untouched.
+ */
+static void MoveBallsScalar(BatchGame *b, LONG from, LONG to)
+{
+    const UBYTE *state = b->state;
+    const LONG *ballVX = b->ballVX;
+    LONG *ballX = b->ballX, *ballY = b->ballY, *ballVY = b->ballVY;
+    UBYTE *contact = b->contact;
+    LONG i;
+
+    for (i = from; i < to; i++) {
+        LONG x0, x, y, vx;
+        WORD px, py;
+        BOOL top, bottom, player, ai;
+
+        contact[i] = BATCH_CONTACT_NONE;
+        if (state[i] != STATE_PLAYING) continue;
+
+        x0 = ballX[i];
+        vx = ballVX[i];
+        x = x0 + vx;
+        y = ballY[i] + ballVY[i];
+        ballX[i] = x;
+
+        px = FP_TO_INT(x);
+        py = FP_TO_INT(y);
+
+        /* Selects rather than branches, as the SIMD kernels do */
+        top = py - BALL_SIZE / 2 <= 48;
+        bottom = py + BALL_SIZE / 2 >= SCREEN_HEIGHT;
+        y = bottom ? INT_TO_FP(SCREEN_HEIGHT - BALL_SIZE / 2) : y;
+        ballY[i] = top ? INT_TO_FP(48 + BALL_SIZE / 2) : y;
+        ballVY[i] = (top | bottom) ? -ballVY[i] : ballVY[i];
+
+        player = (vx < 0) &
+                 (((px >= PLAYER_REACH_X) & (px <= PLAYER_CONTACT_X)) |
+                  ((x0 > INT_TO_FP(PLAYER_CONTACT_X)) & (x <= INT_TO_FP(PLAYER_CONTACT_X))));
+        ai = (vx > 0) &
+             (((px >= AI_CONTACT_X) & (px <= AI_REACH_X)) |
+              ((x0 < INT_TO_FP(AI_CONTACT_X)) & (x >= INT_TO_FP(AI_CONTACT_X))));
+        contact[i] = (UBYTE)((top | bottom) * BATCH_CONTACT_WALL +
+                             (player | ai) * BATCH_CONTACT_PADDLE);
+    }
+}
+
+/*
+ * Pass 3: paddle bounces (shared with UpdateGame()), AI reaction
+ * scheduling, for the lanes the ball stage flagged. Neighbouring lanes
+ * are unrelated matches, so testing each lane here would mispredict;
+ * the flags leave one rarely taken branch.
+ */
+static void CollideBatchPaddles(BatchGame *b)
+{
+    const UBYTE *flags = b->contact;
+    LONG i;
+
+    for (i = 0; i < b->count; i++) {
+        UBYTE contact = flags[i];
+        WORD ballX;
+        Ball ball;
+        BOOL hit = FALSE;
+
+        if (contact == BATCH_CONTACT_NONE) continue;
+
+        /* The ball stage bounced it off a wall: the AI reacts to that */
+        if (contact & BATCH_CONTACT_WALL) {
+            ScheduleAIReaction(&b->aiUpdateTimer[i], &b->ai[i]);
+        }
+        if (!(contact & BATCH_CONTACT_PADDLE)) continue;
+
+        ballX = FP_TO_INT(b->ballX[i]);
+        ball.x = (FIXED)b->ballX[i];
+        ball.y = (FIXED)b->ballY[i];
+        ball.vx = (FIXED)b->ballVX[i];
+        ball.vy = (FIXED)b->ballVY[i];
+
+        /* The walls only move the ball vertically: it started at x - vx */
+        if (ball.vx < 0 && ballX < SCREEN_WIDTH / 2) {
+            hit = BounceBallOffPaddle(&ball, (FIXED)(b->ballX[i] - b->ballVX[i]),
+                                      (FIXED)b->startY[i], b->playerY[i], FALSE, 0);
+        } else if (ball.vx > 0 && ballX > SCREEN_WIDTH / 2) {
+            hit = BounceBallOffPaddle(&ball, (FIXED)(b->ballX[i] - b->ballVX[i]),
+                                      (FIXED)b->startY[i], b->aiY[i], TRUE, 0);
+        }
+        if (!hit) continue;
+
+        b->ballX[i] = ball.x;
+        b->ballY[i] = ball.y;
+        b->ballVX[i] = ball.vx;
+        b->ballVY[i] = ball.vy;
+        b->rallies[i]++;
+        ScheduleAIReaction(&b->aiUpdateTimer[i], &b->ai[i]);
+    }
+}
+
+/*
+ * Pass 4: clamp vertical speed, detect scoring and apply the safety
+ * clamp, flagging scoring lanes in b->scored for ApplyBatchScores().
+ * Scoring tests the post-collision X: a paddle hit only happens
+ * on-screen and leaves the ball on-screen, so this matches the
+ * pre-collision test UpdateGame() makes. The safety clamp runs
+ * before the serve reset here, which is harmless because a serve
+ * puts the ball back in the middle of the screen.
+ */
+static void ScoreBallsScalar(BatchGame *b, LONG from, LONG to)
+{
+    const UBYTE *state = b->state;
+    const LONG *ballX = b->ballX;
+    LONG *ballY = b->ballY, *ballVY = b->ballVY;
+    UBYTE *scored = b->scored;
+    LONG i;
+
+    for (i = from; i < to; i++) {
+        WORD px;
+        LONG vy, y;
+
+        scored[i] = BATCH_SCORED_NONE;
+        if (state[i] != STATE_PLAYING) continue;
+
+        vy = ballVY[i];
+        vy = vy > INT_TO_FP(4) ? INT_TO_FP(4) : vy;
+        ballVY[i] = vy < INT_TO_FP(-4) ? INT_TO_FP(-4) : vy;
+
+        px = FP_TO_INT(ballX[i]);
+
+        if (px < -BALL_SIZE || ballX[i] < INT_TO_FP(-50)) {
+            scored[i] = BATCH_SCORED_AI;
+        } else if (px > SCREEN_WIDTH + BALL_SIZE || ballX[i] > INT_TO_FP(SCREEN_WIDTH + 50)) {
+            scored[i] = BATCH_SCORED_PLAYER;
+        }
+
+        y = ballY[i];
+        y = y < INT_TO_FP(-50) ? INT_TO_FP(-50) : y;
+        ballY[i] = y > INT_TO_FP(SCREEN_HEIGHT + 50) ? INT_TO_FP(SCREEN_HEIGHT + 50) : y;
+    }
+}
+
+#ifdef BATCH_SIMD_X86
+
+/* Playing-lane mask for 4 lanes from the UBYTE state array */
+static __m128i LiveMask4(const UBYTE *state)
+{
+    ULONG packed;
+    __m128i v;
+
+    memcpy(&packed, state, 4);
+    v = _mm_cvtsi32_si128((int)packed);
+    v = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+    v = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+    return _mm_cmpeq_epi32(v, _mm_set1_epi32(STATE_PLAYING));
+}
+
+/* mask ? a : b */
+static __m128i Select4(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/* Store the low byte of each 32-bit lane (all values are 0..3) */
+static void StoreBytes4(UBYTE *dst, __m128i v)
+{
+    ULONG packed;
+
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    packed = (ULONG)_mm_cvtsi128_si32(v);
+    memcpy(dst, &packed, 4);
+}
+
+/*
+ * Pass 1 eight lanes at a time in 16-bit lanes. The reactions that
+ * fall due (rare) are handled lane by lane first, as they set the
+ * target the paddle then moves towards. AVX2 gains nothing here: the
+ * per-lane AI speed is gathered from the AISettings one lane at a time.
+ */
+static void PaddlesSSE2(BatchGame *b, const WORD *mouseY, LONG from, LONG to)
+{
+    const __m128i minY = _mm_set1_epi16(PADDLE_MIN_Y);
+    const __m128i maxY = _mm_set1_epi16(PADDLE_MAX_Y);
+    const __m128i deadZone = _mm_set1_epi16(AI_DEAD_ZONE);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    const AISettings *ai;
+    LONG i, k;
+
+    for (i = from; i + 8 <= to; i += 8) {
+        __m128i live = _mm_cmpeq_epi16(
+            _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)&b->state[i]), zero),
+            _mm_set1_epi16(STATE_PLAYING));
+        __m128i timer = _mm_loadu_si128((const __m128i *)&b->aiUpdateTimer[i]);
+        __m128i mouse = _mm_loadu_si128((const __m128i *)&mouseY[i]);
+        __m128i playerY = _mm_loadu_si128((const __m128i *)&b->playerY[i]);
+        __m128i aiY, diff, speed, step, outside;
+        int due;
+
+        /* timer > 0 && --timer == 0: only timers at 1 react */
+        due = _mm_movemask_epi8(_mm_and_si128(live, _mm_cmpeq_epi16(timer, one)));
+        for (k = 0; due; k++, due >>= 2) {
+            if (due & 1) ReactLane(b, i + k);
+        }
+        timer = _mm_sub_epi16(timer, _mm_and_si128(_mm_cmpgt_epi16(timer, zero), one));
+        _mm_storeu_si128((__m128i *)&b->aiUpdateTimer[i],
+                         Select4(live, timer,
+                                 _mm_loadu_si128((const __m128i *)&b->aiUpdateTimer[i])));
+
+        mouse = _mm_min_epi16(_mm_max_epi16(mouse, minY), maxY);
+        _mm_storeu_si128((__m128i *)&b->playerY[i], Select4(live, mouse, playerY));
+
+        /* Scratch: dead lanes may get anything */
+        _mm_storeu_si128((__m128i *)&b->startY[i],
+                         _mm_loadu_si128((const __m128i *)&b->ballY[i]));
+        _mm_storeu_si128((__m128i *)&b->startY[i + 4],
+                         _mm_loadu_si128((const __m128i *)&b->ballY[i + 4]));
+
+        ai = &b->ai[i];
+        speed = _mm_set_epi16(ai[7].speed, ai[6].speed, ai[5].speed, ai[4].speed,
+                              ai[3].speed, ai[2].speed, ai[1].speed, ai[0].speed);
+        aiY = _mm_loadu_si128((const __m128i *)&b->aiY[i]);
+        diff = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)&b->aiTargetY[i]), aiY);
+        step = _mm_max_epi16(_mm_min_epi16(diff, speed), _mm_sub_epi16(zero, speed));
+        outside = _mm_or_si128(_mm_cmpgt_epi16(diff, deadZone),
+                               _mm_cmplt_epi16(diff, _mm_sub_epi16(zero, deadZone)));
+        step = _mm_and_si128(outside, step);
+        _mm_storeu_si128((__m128i *)&b->aiY[i],
+                         Select4(live, _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(aiY, step),
+                                                                   minY), maxY), aiY));
+    }
+
+    PaddlesScalar(b, mouseY, i, to);
+}
+
+static void MoveBallsSSE2(BatchGame *b, LONG from, LONG to)
+{
+    const __m128i top = _mm_set1_epi32(48 + BALL_SIZE / 2);
+    const __m128i bottom = _mm_set1_epi32(SCREEN_HEIGHT - BALL_SIZE / 2 - 1);
+    const __m128i topY = _mm_set1_epi32(INT_TO_FP(48 + BALL_SIZE / 2));
+    const __m128i bottomY = _mm_set1_epi32(INT_TO_FP(SCREEN_HEIGHT - BALL_SIZE / 2));
+    const __m128i playerReach = _mm_set1_epi32(PLAYER_REACH_X);
+    const __m128i playerContact = _mm_set1_epi32(PLAYER_CONTACT_X);
+    const __m128i playerFace = _mm_set1_epi32(INT_TO_FP(PLAYER_CONTACT_X));
+    const __m128i aiContact = _mm_set1_epi32(AI_CONTACT_X);
+    const __m128i aiReach = _mm_set1_epi32(AI_REACH_X);
+    const __m128i aiFace = _mm_set1_epi32(INT_TO_FP(AI_CONTACT_X));
+    const __m128i zero = _mm_setzero_si128();
+    LONG i;
+
+    for (i = from; i + 4 <= to; i += 4) {
+        __m128i live = LiveMask4(&b->state[i]);
+        __m128i x0 = _mm_loadu_si128((const __m128i *)&b->ballX[i]);
+        __m128i y = _mm_loadu_si128((const __m128i *)&b->ballY[i]);
+        __m128i vx = _mm_loadu_si128((const __m128i *)&b->ballVX[i]);
+        __m128i vy = _mm_loadu_si128((const __m128i *)&b->ballVY[i]);
+        __m128i x, px, py, hitTop, hitBottom, bounce, player, ai, flags;
+
+        x = _mm_add_epi32(x0, vx);
+        y = _mm_add_epi32(y, vy);
+        px = _mm_srai_epi32(x, FP_SHIFT);
+        py = _mm_srai_epi32(y, FP_SHIFT);
+
+        /* ballY - 3 <= 48  <=>  !(ballY > 51); bottom test likewise */
+        hitTop = _mm_andnot_si128(_mm_cmpgt_epi32(py, top), _mm_set1_epi32(-1));
+        hitBottom = _mm_andnot_si128(hitTop, _mm_cmpgt_epi32(py, bottom));
+        bounce = _mm_or_si128(hitTop, hitBottom);
+
+        y = Select4(hitTop, topY, Select4(hitBottom, bottomY, y));
+        vy = Select4(bounce, _mm_sub_epi32(zero, vy), vy);
+
+        /* Over a paddle's columns, or across its contact line */
+        player = _mm_or_si128(
+            _mm_andnot_si128(_mm_or_si128(_mm_cmplt_epi32(px, playerReach),
+                                          _mm_cmpgt_epi32(px, playerContact)),
+                             _mm_set1_epi32(-1)),
+            _mm_andnot_si128(_mm_cmpgt_epi32(x, playerFace), _mm_cmpgt_epi32(x0, playerFace)));
+        ai = _mm_or_si128(
+            _mm_andnot_si128(_mm_or_si128(_mm_cmplt_epi32(px, aiContact),
+                                          _mm_cmpgt_epi32(px, aiReach)),
+                             _mm_set1_epi32(-1)),
+            _mm_andnot_si128(_mm_cmplt_epi32(x, aiFace), _mm_cmplt_epi32(x0, aiFace)));
+        player = _mm_and_si128(player, _mm_cmplt_epi32(vx, zero));
+        ai = _mm_and_si128(ai, _mm_cmpgt_epi32(vx, zero));
+
+        flags = _mm_or_si128(_mm_and_si128(bounce, _mm_set1_epi32(BATCH_CONTACT_WALL)),
+                             _mm_and_si128(_mm_or_si128(player, ai),
+                                           _mm_set1_epi32(BATCH_CONTACT_PADDLE)));
+        StoreBytes4(&b->contact[i], _mm_and_si128(live, flags));
+
+        _mm_storeu_si128((__m128i *)&b->ballX[i], Select4(live, x, x0));
+        _mm_storeu_si128((__m128i *)&b->ballY[i],
+                         Select4(live, y, _mm_loadu_si128((const __m128i *)&b->ballY[i])));
+        _mm_storeu_si128((__m128i *)&b->ballVY[i],
+                         Select4(live, vy, _mm_loadu_si128((const __m128i *)&b->ballVY[i])));
+    }
+
+    MoveBallsScalar(b, i, to);
+}
+
+static void ScoreBallsSSE2(BatchGame *b, LONG from, LONG to)
+{
+    const __m128i vyMax = _mm_set1_epi32(INT_TO_FP(4));
+    const __m128i vyMin = _mm_set1_epi32(INT_TO_FP(-4));
+    const __m128i yMax = _mm_set1_epi32(INT_TO_FP(SCREEN_HEIGHT + 50));
+    const __m128i yMin = _mm_set1_epi32(INT_TO_FP(-50));
+    const __m128i leftX = _mm_set1_epi32(-BALL_SIZE);
+    const __m128i leftFP = _mm_set1_epi32(INT_TO_FP(-50));
+    const __m128i rightX = _mm_set1_epi32(SCREEN_WIDTH + BALL_SIZE);
+    const __m128i rightFP = _mm_set1_epi32(INT_TO_FP(SCREEN_WIDTH + 50));
+    LONG i;
+
+    for (i = from; i + 4 <= to; i += 4) {
+        __m128i live = LiveMask4(&b->state[i]);
+        __m128i x = _mm_loadu_si128((const __m128i *)&b->ballX[i]);
+        __m128i y = _mm_loadu_si128((const __m128i *)&b->ballY[i]);
+        __m128i vy = _mm_loadu_si128((const __m128i *)&b->ballVY[i]);
+        __m128i px = _mm_srai_epi32(x, FP_SHIFT);
+        __m128i aiScores, playerScores, flags;
+
+        vy = Select4(_mm_cmpgt_epi32(vy, vyMax), vyMax, vy);
+        vy = Select4(_mm_cmpgt_epi32(vyMin, vy), vyMin, vy);
+
+        aiScores = _mm_or_si128(_mm_cmplt_epi32(px, leftX), _mm_cmplt_epi32(x, leftFP));
+        playerScores = _mm_andnot_si128(aiScores,
+                       _mm_or_si128(_mm_cmpgt_epi32(px, rightX), _mm_cmpgt_epi32(x, rightFP)));
+
+        y = Select4(_mm_cmplt_epi32(y, yMin), yMin, y);
+        y = Select4(_mm_cmpgt_epi32(y, yMax), yMax, y);
+
+        flags = _mm_or_si128(_mm_and_si128(aiScores, _mm_set1_epi32(BATCH_SCORED_AI)),
+                             _mm_and_si128(playerScores, _mm_set1_epi32(BATCH_SCORED_PLAYER)));
+        StoreBytes4(&b->scored[i], _mm_and_si128(live, flags));
+
+        _mm_storeu_si128((__m128i *)&b->ballY[i],
+                         Select4(live, y, _mm_loadu_si128((const __m128i *)&b->ballY[i])));
+        _mm_storeu_si128((__m128i *)&b->ballVY[i],
+                         Select4(live, vy, _mm_loadu_si128((const __m128i *)&b->ballVY[i])));
+    }
+
+    ScoreBallsScalar(b, i, to);
+}
+
+#define AVX2_FN __attribute__((target("avx2")))
+
+AVX2_FN static __m256i LiveMask8(const UBYTE *state)
+{
+    __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)state));
+    return _mm256_cmpeq_epi32(v, _mm256_set1_epi32(STATE_PLAYING));
+}
+
+AVX2_FN static void MoveBallsAVX2(BatchGame *b, LONG from, LONG to)
+{
+    const __m256i top = _mm256_set1_epi32(48 + BALL_SIZE / 2);
+    const __m256i bottom = _mm256_set1_epi32(SCREEN_HEIGHT - BALL_SIZE / 2 - 1);
+    const __m256i topY = _mm256_set1_epi32(INT_TO_FP(48 + BALL_SIZE / 2));
+    const __m256i bottomY = _mm256_set1_epi32(INT_TO_FP(SCREEN_HEIGHT - BALL_SIZE / 2));
+    const __m256i playerReach = _mm256_set1_epi32(PLAYER_REACH_X - 1);
+    const __m256i playerContact = _mm256_set1_epi32(PLAYER_CONTACT_X);
+    const __m256i playerFace = _mm256_set1_epi32(INT_TO_FP(PLAYER_CONTACT_X));
+    const __m256i aiContact = _mm256_set1_epi32(AI_CONTACT_X - 1);
+    const __m256i aiReach = _mm256_set1_epi32(AI_REACH_X);
+    const __m256i aiFace = _mm256_set1_epi32(INT_TO_FP(AI_CONTACT_X));
+    const __m256i zero = _mm256_setzero_si256();
+    LONG i;
+
+    for (i = from; i + 8 <= to; i += 8) {
+        __m256i live = LiveMask8(&b->state[i]);
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)&b->ballX[i]);
+        __m256i y0 = _mm256_loadu_si256((const __m256i *)&b->ballY[i]);
+        __m256i vx = _mm256_loadu_si256((const __m256i *)&b->ballVX[i]);
+        __m256i vy0 = _mm256_loadu_si256((const __m256i *)&b->ballVY[i]);
+        __m256i x, y, vy, px, py, hitTop, hitBottom, bounce, player, ai, flags;
+        __m128i packed;
+
+        x = _mm256_add_epi32(x0, vx);
+        y = _mm256_add_epi32(y0, vy0);
+        px = _mm256_srai_epi32(x, FP_SHIFT);
+        py = _mm256_srai_epi32(y, FP_SHIFT);
+
+        hitTop = _mm256_xor_si256(_mm256_cmpgt_epi32(py, top), _mm256_set1_epi32(-1));
+        hitBottom = _mm256_andnot_si256(hitTop, _mm256_cmpgt_epi32(py, bottom));
+        bounce = _mm256_or_si256(hitTop, hitBottom);
+
+        y = _mm256_blendv_epi8(y, topY, hitTop);
+        y = _mm256_blendv_epi8(y, bottomY, hitBottom);
+        vy = _mm256_blendv_epi8(vy0, _mm256_sub_epi32(zero, vy0), bounce);
+
+        /* Over a paddle's columns (lo - 1 < px <= hi), or across its contact line */
+        player = _mm256_or_si256(
+            _mm256_andnot_si256(_mm256_cmpgt_epi32(px, playerContact),
+                                _mm256_cmpgt_epi32(px, playerReach)),
+            _mm256_andnot_si256(_mm256_cmpgt_epi32(x, playerFace),
+                                _mm256_cmpgt_epi32(x0, playerFace)));
+        ai = _mm256_or_si256(
+            _mm256_andnot_si256(_mm256_cmpgt_epi32(px, aiReach),
+                                _mm256_cmpgt_epi32(px, aiContact)),
+            _mm256_andnot_si256(_mm256_cmpgt_epi32(aiFace, x),
+                                _mm256_cmpgt_epi32(aiFace, x0)));
+        player = _mm256_and_si256(player, _mm256_cmpgt_epi32(zero, vx));
+        ai = _mm256_and_si256(ai, _mm256_cmpgt_epi32(vx, zero));
+
+        flags = _mm256_or_si256(_mm256_and_si256(bounce, _mm256_set1_epi32(BATCH_CONTACT_WALL)),
+                                _mm256_and_si256(_mm256_or_si256(player, ai),
+                                                 _mm256_set1_epi32(BATCH_CONTACT_PADDLE)));
+        flags = _mm256_and_si256(live, flags);
+        packed = _mm_packs_epi32(_mm256_castsi256_si128(flags),
+                                 _mm256_extracti128_si256(flags, 1));
+        packed = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64((__m128i *)&b->contact[i], packed);
+
+        _mm256_storeu_si256((__m256i *)&b->ballX[i], _mm256_blendv_epi8(x0, x, live));
+        _mm256_storeu_si256((__m256i *)&b->ballY[i], _mm256_blendv_epi8(y0, y, live));
+        _mm256_storeu_si256((__m256i *)&b->ballVY[i], _mm256_blendv_epi8(vy0, vy, live));
+    }
+
+    MoveBallsScalar(b, i, to);
+}
+
+AVX2_FN static void ScoreBallsAVX2(BatchGame *b, LONG from, LONG to)
+{
+    const __m256i vyMax = _mm256_set1_epi32(INT_TO_FP(4));
+    const __m256i vyMin = _mm256_set1_epi32(INT_TO_FP(-4));
+    const __m256i yMax = _mm256_set1_epi32(INT_TO_FP(SCREEN_HEIGHT + 50));
+    const __m256i yMin = _mm256_set1_epi32(INT_TO_FP(-50));
+    const __m256i leftX = _mm256_set1_epi32(-BALL_SIZE);
+    const __m256i leftFP = _mm256_set1_epi32(INT_TO_FP(-50));
+    const __m256i rightX = _mm256_set1_epi32(SCREEN_WIDTH + BALL_SIZE);
+    const __m256i rightFP = _mm256_set1_epi32(INT_TO_FP(SCREEN_WIDTH + 50));
+    LONG i;
+
+    for (i = from; i + 8 <= to; i += 8) {
+        __m256i live = LiveMask8(&b->state[i]);
+        __m256i x = _mm256_loadu_si256((const __m256i *)&b->ballX[i]);
+        __m256i y0 = _mm256_loadu_si256((const __m256i *)&b->ballY[i]);
+        __m256i vy0 = _mm256_loadu_si256((const __m256i *)&b->ballVY[i]);
+        __m256i px = _mm256_srai_epi32(x, FP_SHIFT);
+        __m256i aiScores, playerScores, flags, y, vy;
+        __m128i packed;
+
+        vy = _mm256_max_epi32(_mm256_min_epi32(vy0, vyMax), vyMin);
+        y = _mm256_max_epi32(_mm256_min_epi32(y0, yMax), yMin);
+
+        aiScores = _mm256_or_si256(_mm256_cmpgt_epi32(leftX, px),
+                                   _mm256_cmpgt_epi32(leftFP, x));
+        playerScores = _mm256_andnot_si256(aiScores,
+                       _mm256_or_si256(_mm256_cmpgt_epi32(px, rightX),
+                                       _mm256_cmpgt_epi32(x, rightFP)));
+
+        flags = _mm256_or_si256(_mm256_and_si256(aiScores, _mm256_set1_epi32(BATCH_SCORED_AI)),
+                                _mm256_and_si256(playerScores, _mm256_set1_epi32(BATCH_SCORED_PLAYER)));
+        flags = _mm256_and_si256(live, flags);
+        packed = _mm_packs_epi32(_mm256_castsi256_si128(flags),
+                                 _mm256_extracti128_si256(flags, 1));
+        packed = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64((__m128i *)&b->scored[i], packed);
+
+        _mm256_storeu_si256((__m256i *)&b->ballY[i], _mm256_blendv_epi8(y0, y, live));
+        _mm256_storeu_si256((__m256i *)&b->ballVY[i], _mm256_blendv_epi8(vy0, vy, live));
+    }
+
+    ScoreBallsScalar(b, i, to);
+}
+
+#endif /* BATCH_SIMD_X86 */
+
+/* Serve the lanes flagged by the score pass */
+static void ApplyBatchScores(BatchGame *b)
+{
+    const UBYTE *scored = b->scored;
+    LONG i;
+
+    for (i = 0; i < b->count; i++) {
+        if (scored[i] == BATCH_SCORED_AI) {
+            b->aiScore[i]++;
+            b->servingPlayer[i] = TRUE;
+            ResetLaneBall(b, i);
+            if (b->aiScore[i] >= WINNING_SCORE) b->state[i] = STATE_GAMEOVER;
+        } else if (scored[i] == BATCH_SCORED_PLAYER) {
+            b->playerScore[i]++;
+            b->servingPlayer[i] = FALSE;
+            ResetLaneBall(b, i);
+            if (b->playerScore[i] >= WINNING_SCORE) b->state[i] = STATE_GAMEOVER;
+        }
+    }
+}
+
+/* Kernel selection */
+static BatchKernel activeKernel = BATCH_KERNEL_SCALAR;
+static BOOL kernelChosen = FALSE;
+
+static BOOL KernelSupported(BatchKernel kernel)
+{
+    switch (kernel) {
+        case BATCH_KERNEL_SCALAR:
+            return TRUE;
+#ifdef BATCH_SIMD_X86
+        case BATCH_KERNEL_SSE2:
+            return TRUE;
+        case BATCH_KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+#endif
+        default:
+            return FALSE;
+    }
+}
+
+BatchKernel SetBatchKernel(BatchKernel kernel)
+{
+    if (kernel == BATCH_KERNEL_BEST) {
+        kernel = BATCH_KERNEL_AVX2;
+        while (!KernelSupported(kernel)) kernel = (BatchKernel)(kernel - 1);
+    } else if (!KernelSupported(kernel)) {
+        kernel = BATCH_KERNEL_SCALAR;
+    }
+
+    activeKernel = kernel;
+    kernelChosen = TRUE;
+    return kernel;
+}
+
+BatchKernel GetBatchKernel(void)
+{
+    if (!kernelChosen) SetBatchKernel(BATCH_KERNEL_BEST);
+    return activeKernel;
+}
+
+const char *BatchKernelName(BatchKernel kernel)
+{
+    switch (kernel) {
+        case BATCH_KERNEL_SCALAR: return "scalar";
+        case BATCH_KERNEL_SSE2:   return "sse2";
+        case BATCH_KERNEL_AVX2:   return "avx2";
+        default:                  return "best";
+    }
+}
+
+void MoveBatchBalls(BatchGame *batch)
+{
+    switch (GetBatchKernel()) {
+#ifdef BATCH_SIMD_X86
+        case BATCH_KERNEL_AVX2: MoveBallsAVX2(batch, 0, batch->count); break;
+        case BATCH_KERNEL_SSE2: MoveBallsSSE2(batch, 0, batch->count); break;
+#endif
+        default:                MoveBallsScalar(batch, 0, batch->count); break;
+    }
+}
+
+void ScoreBatchBalls(BatchGame *batch)
+{
+    switch (GetBatchKernel()) {
+#ifdef BATCH_SIMD_X86
+        case BATCH_KERNEL_AVX2: ScoreBallsAVX2(batch, 0, batch->count); break;
+        case BATCH_KERNEL_SSE2: ScoreBallsSSE2(batch, 0, batch->count); break;
+#endif
+        default:                ScoreBallsScalar(batch, 0, batch->count); break;
+    }
+}
+
+static void UpdateBatchPaddles(BatchGame *batch, const WORD *mouseY)
+{
+#ifdef BATCH_SIMD_X86
+    if (GetBatchKernel() != BATCH_KERNEL_SCALAR) {
+        PaddlesSSE2(batch, mouseY, 0, batch->count);
+        return;
+    }
+#endif
+    PaddlesScalar(batch, mouseY, 0, batch->count);
+}
+
+void UpdateBatch(BatchGame *batch, const WORD *mouseY)
+{
+    UpdateBatchPaddles(batch, mouseY);
+    MoveBatchBalls(batch);
+    CollideBatchPaddles(batch);
+    ScoreBatchBalls(batch);
+    ApplyBatchScores(batch);
+}
@@ -0,0 +1,101 @@
+/*
+ * batch.h - Struct-of-arrays simulator for many matches at once
+ * Amiga Pong - OS-friendly implementation
+ *
+ * A BatchGame holds N independent matches ("lanes") as parallel
+ * arrays and advances all of them with one UpdateBatch() call.
+ * Each lane carries its own RNG state and AI settings, so a lane
+ * evolves bit-identically to a GameContext driven by UpdateGame()
+ * from the same RNG state, difficulty and mouse input. Lanes move
+ * the ball in one step a frame (a subStepShift of 0).
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <exec/types.h>
+#include "game.h"
+
+typedef struct {
+    LONG count;          /* Number of lanes */
+
+    /* Ball (fixed-point) */
+    LONG *ballX;
+    LONG *ballY;
+    LONG *ballVX;
+    LONG *ballVY;
+
+    /* Paddles */
+    WORD *playerY;
+    WORD *playerTargetY;
+    WORD *aiY;
+    WORD *aiTargetY;
+
+    /* Match state */
+    WORD *playerScore;
+    WORD *aiScore;
+    WORD *rallies;
+    WORD *aiUpdateTimer;
+    UBYTE *state;        /* GameState */
+    UBYTE *difficulty;   /* Difficulty */
+    UBYTE *servingPlayer;
+
+    /* Per-lane AI settings and RNG */
+    AISettings *ai;
+    RandomState *rng;
+
+    /* Scratch: ball Y before this frame's move */
+    LONG *startY;
+    /* Scratch: what the ball stage left for the collision pass (BATCH_CONTACT_...) */
+    UBYTE *contact;
+    /* Scratch: who scored this frame (BATCH_SCORED_...) */
+    UBYTE *scored;
+} BatchGame;
+
+#define BATCH_CONTACT_NONE   0
+#define BATCH_CONTACT_PADDLE 1   /* Close enough that a paddle may hit it */
+#define BATCH_CONTACT_WALL   2   /* Bounced off a wall: the AI reacts */
+
+#define BATCH_SCORED_NONE   0
+#define BATCH_SCORED_AI     1
+#define BATCH_SCORED_PLAYER 2
+
+/* Implementations of the paddle and ball stages (paddles stop at SSE2) */
+typedef enum {
+    BATCH_KERNEL_SCALAR = 0,
+    BATCH_KERNEL_SSE2 = 1,
+    BATCH_KERNEL_AVX2 = 2,
+    BATCH_KERNEL_BEST = 3   /* Widest one this machine supports */
+} BatchKernel;
+
+/* Allocate a batch of count lanes (all lanes start in STATE_TITLE) */
+BOOL AllocBatch(BatchGame *batch, LONG count);
+
+/* Free a batch allocated with AllocBatch() */
+void FreeBatch(BatchGame *batch);
+
+/* Start a new match in one lane, as InitGame() from the given RNG state */
+void StartBatchLane(BatchGame *batch, LONG lane, Difficulty diff, const RandomState *rng);
+
+/* Advance every playing lane by one frame; mouseY has one entry per lane */
+void UpdateBatch(BatchGame *batch, const WORD *mouseY);
+
+/* Copy one lane into a GameContext (for inspection and verification) */
+void GetBatchLane(const BatchGame *batch, LONG lane, GameContext *ctx);
+
+/* Select the stage kernels; returns the one actually used */
+BatchKernel SetBatchKernel(BatchKernel kernel);
+BatchKernel GetBatchKernel(void);
+const char *BatchKernelName(BatchKernel kernel);
+
+/*
+ * Ball stage of UpdateBatch(), exposed for kernel verification:
+ * MoveBatchBalls() adds velocity, bounces off the walls and sets
+ * batch->contact for lanes that bounced or may reach a paddle,
+ * ScoreBatchBalls() clamps vy, applies the safety clamp and sets
+ * batch->scored for lanes where a point was scored.
+ */
+void MoveBatchBalls(BatchGame *batch);
+void ScoreBatchBalls(BatchGame *batch);
+
+#endif /* BATCH_H */
@@ -0,0 +1,117 @@
+/*
+ * dirty.c - Dirty rectangle tracker
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+
+#include "dirty.h"
+
+void ClearDirty(DirtyList *d)
+{
+    d->count = 0;
+}
+
+static ULONG Area(const DirtyRect *r)
+{
+    return (ULONG)(r->x1 - r->x0 + 1) * (ULONG)(r->y1 - r->y0 + 1);
+}
+
+static void Grow(DirtyRect *r, const DirtyRect *by)
+{
+    if (by->x0 < r->x0) r->x0 = by->x0;
+    if (by->y0 < r->y0) r->y0 = by->y0;
+    if (by->x1 > r->x1) r->x1 = by->x1;
+    if (by->y1 > r->y1) r->y1 = by->y1;
+}
+
+/*
+ * Overlapping or side by side, and no bigger together than apart: the
+ * two are better repainted as one. A dash of the center line across a
+ * line of text is not - the box around both is mostly empty.
+ */
+static BOOL ShouldMerge(const DirtyRect *a, const DirtyRect *b)
+{
+    DirtyRect both = *a;
+
+    if (a->x0 > b->x1 + 1 || b->x0 > a->x1 + 1 ||
+        a->y0 > b->y1 + 1 || b->y0 > a->y1 + 1) {
+        return FALSE;
+    }
+    Grow(&both, b);
+    return Area(&both) <= Area(a) + Area(b);
+}
+
+void AddDirty(DirtyList *d, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    DirtyRect add;
+    WORD i, best;
+    ULONG growth, bestGrowth;
+    BOOL merged;
+
+    if (x0 > x1 || y0 > y1) return;
+    add.x0 = x0;
+    add.y0 = y0;
+    add.x1 = x1;
+    add.y1 = y1;
+
+    /* Take in every rectangle it should; growing may reach more */
+    do {
+        merged = FALSE;
+        for (i = 0; i < d->count; i++) {
+            if (ShouldMerge(&add, &d->rects[i])) {
+                Grow(&add, &d->rects[i]);
+                d->rects[i] = d->rects[--d->count];
+                merged = TRUE;
+                break;
+            }
+        }
+    } while (merged);
+
+    if (d->count < DIRTY_RECTS) {
+        d->rects[d->count++] = add;
+        return;
+    }
+
+    /* Full: into the rectangle it grows least, which may then touch others */
+    best = 0;
+    bestGrowth = 0xFFFFFFFFUL;
+    for (i = 0; i < d->count; i++) {
+        DirtyRect r = d->rects[i];
+
+        Grow(&r, &add);
+        growth = Area(&r) - Area(&d->rects[i]);
+        if (growth < bestGrowth) {
+            bestGrowth = growth;
+            best = i;
+        }
+    }
+    Grow(&add, &d->rects[best]);
+    d->rects[best] = d->rects[--d->count];
+    AddDirty(d, add.x0, add.y0, add.x1, add.y1);
+}
+
+BOOL IsDirty(const DirtyList *d, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    WORD i;
+
+    for (i = 0; i < d->count; i++) {
+        const DirtyRect *r = &d->rects[i];
+
+        if (x0 <= r->x1 && r->x0 <= x1 && y0 <= r->y1 && r->y0 <= y1) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+ULONG DirtyPixels(const DirtyList *d)
+{
+    ULONG pixels = 0;
+    WORD i;
+
+    for (i = 0; i < d->count; i++) {
+        pixels += Area(&d->rects[i]);
+    }
+    return pixels;
+}
@@ -0,0 +1,40 @@
+/*
+ * dirty.h - Dirty rectangle tracker
+ * Amiga Pong - OS-friendly implementation
+ *
+ * A short list of rectangles to repaint. A rectangle added over or
+ * against one already listed is merged with it when the box around
+ * both is no bigger than the two apart, and when the list is full the
+ * new one goes into whichever rectangle it grows least. Rectangles
+ * may still overlap a little, so the area of the list is a fair upper
+ * count of the pixels that changed, and each rectangle is one blit.
+ */
+
+#ifndef DIRTY_H
+#define DIRTY_H
+
+#include <exec/types.h>
+
+#define DIRTY_RECTS 16
+
+/* Corners are inclusive */
+typedef struct {
+    WORD x0, y0;
+    WORD x1, y1;
+} DirtyRect;
+
+typedef struct {
+    WORD count;
+    DirtyRect rects[DIRTY_RECTS];
+} DirtyList;
+
+void ClearDirty(DirtyList *d);
+void AddDirty(DirtyList *d, WORD x0, WORD y0, WORD x1, WORD y1);
+
+/* TRUE if the rectangle overlaps any in the list */
+BOOL IsDirty(const DirtyList *d, WORD x0, WORD y0, WORD x1, WORD y1);
+
+/* Pixels the list covers, overlaps counted twice */
+ULONG DirtyPixels(const DirtyList *d);
+
+#endif /* DIRTY_H */
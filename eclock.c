@@ -0,0 +1,53 @@
+/*
+ * eclock.c - Profiler clock: timer.device's E clock
+ * Amiga Pong - OS-friendly implementation
+ *
+ * The timer request is only used to open the device and find
+ * TimerBase for ReadEClock(); no I/O is ever sent, so it needs no
+ * reply port. The low 32 bits of the E clock are enough: the
+ * profiler only takes differences, and they wrap after an hour and
+ * a half.
+ */
+
+#include <exec/types.h>
+#include <devices/timer.h>
+
+#include <proto/exec.h>
+#include <proto/timer.h>
+
+#include "profile.h"
+
+struct Device *TimerBase = NULL;
+
+static struct timerequest timerIO;
+static WORD users = 0;           /* The profiler and the overlay share it */
+
+ULONG OpenProfileClock(void)
+{
+    struct EClockVal now;
+
+    if (users == 0) {
+        if (OpenDevice(TIMERNAME, UNIT_ECLOCK, (struct IORequest *)&timerIO, 0) != 0) {
+            return 0;
+        }
+        TimerBase = timerIO.tr_node.io_Device;
+    }
+    users++;
+    return ReadEClock(&now);
+}
+
+ULONG ReadProfileClock(void)
+{
+    struct EClockVal now;
+
+    ReadEClock(&now);
+    return now.ev_lo;
+}
+
+void CloseProfileClock(void)
+{
+    if (users > 0 && --users == 0) {
+        CloseDevice((struct IORequest *)&timerIO);
+        TimerBase = NULL;
+    }
+}
@@ -6,38 +6,79 @@
 #include <exec/types.h>
 #include "game.h"
 #include "graphics.h"
+#include "tables.h"
 
-/* Simple pseudo-random number generator */
-static ULONG randomSeed = 12345;
+/* Pseudo-random number generator: 64-bit LCG (Knuth's MMIX constants) */
+#define RANDOM_MUL 6364136223846793005ULL
+#define RANDOM_ADD 1442695040888963407ULL
 
-static WORD Random(WORD max)
+void SeedRandom(RandomState *rng, ULONG seed)
 {
+    *rng = (RandomState)seed * RANDOM_MUL + RANDOM_ADD;
+}
+
+WORD NextRandom(RandomState *rng, WORD max)
+{
+    UWORD r;
+    const DivMagic *m;
+
     if (max <= 0) return 0;
-    randomSeed = randomSeed * 1103515245 + 12345;
-    return (WORD)((randomSeed >> 16) % (UWORD)max);
+    *rng = *rng * RANDOM_MUL + RANDOM_ADD;
+    /* Top 15 bits - the low bits of an LCG are poor */
+    r = (UWORD)(*rng >> 49);
+
+    /* r % max by multiply-shift; plain DIVU for unusually large ranges */
+    if (max > MODULO_MAX) return (WORD)(r % (UWORD)max);
+    m = &moduloTable[max];
+    return (WORD)(r - (UWORD)max * (UWORD)(((ULONG)r * m->mul) >> m->shift));
 }
 
-/* AI difficulty settings per level */
-typedef struct {
-    WORD speed;          /* Max pixels AI can move per frame */
-    WORD errorMargin;    /* Random error in prediction */
-    WORD updateInterval; /* Frames between target recalculation */
-} AISettings;
+void JumpRandom(RandomState *rng, RandomState steps)
+{
+    RandomState mul = RANDOM_MUL, add = RANDOM_ADD;
+    RandomState accMul = 1, accAdd = 0;
+
+    /* Compose the step function with itself by repeated squaring */
+    while (steps) {
+        if (steps & 1) {
+            accMul *= mul;
+            accAdd = accAdd * mul + add;
+        }
+        add = (mul + 1) * add;
+        mul *= mul;
+        steps >>= 1;
+    }
+
+    *rng = accMul * *rng + accAdd;
+}
 
-static const AISettings difficultySettings[3] = {
-    { 3, 40, 20 },  /* EASY: slow, inaccurate, updates rarely */
+void SplitRandom(RandomState *stream, const RandomState *master, ULONG index)
+{
+    *stream = *master;
+    JumpRandom(stream, (RandomState)index << RANDOM_STREAM_BITS);
+}
+
+static WORD Random(GameContext *ctx, WORD max)
+{
+    return NextRandom(&ctx->rng, max);
+}
+
+void SetRandomSeed(GameContext *ctx, ULONG seed)
+{
+    SeedRandom(&ctx->rng, seed);
+}
+
+const AISettings difficultySettings[3] = {
+    { 3, 40, 20 },  /* EASY: slow, inaccurate, reacts late */
     { 4, 24, 12 },  /* MEDIUM: moderate speed and accuracy */
-    { 6, 8,  6 }    /* HARD: fast, accurate, updates frequently */
+    { 6, 8,  6 }    /* HARD: fast, accurate, reacts quickly */
 };
 
-/* Current AI settings (set by difficulty) */
-static AISettings currentAI = { 4, 24, 12 };
-
 void SetDifficulty(GameContext *ctx, Difficulty diff)
 {
     if (diff > DIFFICULTY_HARD) diff = DIFFICULTY_MEDIUM;
     ctx->difficulty = diff;
-    currentAI = difficultySettings[diff];
+    ctx->ai = difficultySettings[diff];
 }
 
 void InitGame(GameContext *ctx)
@@ -53,7 +94,7 @@ void InitGame(GameContext *ctx)
     if (ctx->difficulty > DIFFICULTY_HARD) {
         ctx->difficulty = DIFFICULTY_MEDIUM;
     }
-    currentAI = difficultySettings[ctx->difficulty];
+    ctx->ai = difficultySettings[ctx->difficulty];
 
     /* Center paddles */
     ctx->playerPaddle.y = SCREEN_HEIGHT / 2;
@@ -64,6 +105,12 @@ void InitGame(GameContext *ctx)
     ResetBall(ctx);
 }
 
+void StartMatch(GameContext *ctx)
+{
+    InitGame(ctx);
+    ctx->state = STATE_PLAYING;
+}
+
 void ResetBall(GameContext *ctx)
 {
     LONG speed;
@@ -77,8 +124,8 @@ void ResetBall(GameContext *ctx)
     ctx->rallies = 0;
     speed = BALL_INITIAL_SPEED;
 
-    /* Random vertical angle (-1 to 1 in fixed point) */
-    angle = INT_TO_FP(Random(256) - 128) / 128;
+    /* Random vertical angle: (r - 128) / 128 pixels, in 1/64 pixel steps */
+    angle = INT_TO_FP((LONG)(Random(ctx, 256) - 128) >> 1) >> 6;
 
     /* Set velocity based on who's serving */
     if (ctx->servingPlayer) {
@@ -89,8 +136,8 @@ void ResetBall(GameContext *ctx)
 
     ctx->ball.vy = angle;
 
-    /* Reset AI update timer so it recalculates on next serve */
-    ctx->aiUpdateTimer = 0;
+    /* New trajectory: the AI reacts to the serve */
+    ScheduleAIReaction(&ctx->aiUpdateTimer, &ctx->ai);
 }
 
 /* Clamp a value to a range */
@@ -113,38 +160,101 @@ static WORD AbsW(WORD x)
     return (x < 0) ? -x : x;
 }
 
-/* Update AI paddle */
-static void UpdateAI(GameContext *ctx)
+/* Ball centre travel band between the walls, as UpdateGame() bounces it */
+#define BAND_TOP    (48 + BALL_SIZE / 2)
+#define BAND_BOTTOM (SCREEN_HEIGHT - BALL_SIZE / 2)
+#define BAND_SPAN   (BAND_BOTTOM - BAND_TOP)
+
+WORD PredictIntercept(LONG x, LONG y, LONG vx, LONG vy, WORD faceX)
+{
+    WORD dist;
+    UWORD speed;
+    ULONG t16;
+    WORD u;
+
+    /* Pixels the ball centre has to travel to touch the paddle face */
+    if (vx > 0) {
+        dist = (faceX - BALL_SIZE / 2) - FP_TO_INT(x);
+        speed = (UWORD)(vx >> (FP_SHIFT - 4));
+    } else {
+        dist = FP_TO_INT(x) - (faceX + BALL_SIZE / 2);
+        speed = (UWORD)((-vx) >> (FP_SHIFT - 4));
+    }
+    if (dist < 0) dist = 0;
+    if (speed >= RECIP_SIZE) speed = RECIP_SIZE - 1;
+
+    /* Time to reach it in 1/16 frames: dist * 256 / speed */
+    t16 = ((ULONG)(UWORD)dist * recipTable[speed]) >> 8;
+    if (t16 > 0x7FFF) t16 = 0x7FFF;
+
+    /* Unfolded Y at that time (in 1/64 px), relative to the top of the band */
+    u = (WORD)((FP_TO_64THS(y) + (((LONG)(WORD)FP_TO_64THS(vy) * (WORD)t16) >> 4)) >> 6) -
+        BAND_TOP;
+
+    /*
+     * A ball slower than a pixel a frame vertically sticks to the top
+     * wall once it gets there: UpdateGame() snaps it to BAND_TOP, and
+     * the next step still rounds down onto the wall and bounces it back.
+     */
+    if (vy > -FP_ONE && vy < FP_ONE && (u <= 0 || FP_TO_INT(y + vy) <= BAND_TOP)) {
+        return BAND_TOP;
+    }
+
+    /* Fold the straight path back into the band: period 2 * span */
+    while (u < 0) u += 2 * BAND_SPAN;
+    while (u >= 2 * BAND_SPAN) u -= 2 * BAND_SPAN;
+    if (u > BAND_SPAN) u = 2 * BAND_SPAN - u;
+
+    return BAND_TOP + u;
+}
+
+WORD PredictInterceptLinear(LONG x, LONG y, LONG vx, LONG vy, WORD faceX)
+{
+    LONG timeToReach;
+    LONG vxShifted;
+
+    /* Safe division - avoid divide by zero */
+    if (vx > 0) {
+        vxShifted = vx >> (FP_SHIFT - 4);
+        if (vxShifted < 1) vxShifted = 1;
+        timeToReach = (INT_TO_FP(faceX) - x) / vxShifted;
+    } else {
+        vxShifted = (-vx) >> (FP_SHIFT - 4);
+        if (vxShifted < 1) vxShifted = 1;
+        timeToReach = (x - INT_TO_FP(faceX)) / vxShifted;
+    }
+    if (timeToReach < 0) timeToReach = 0;
+    if (timeToReach > 128) timeToReach = 128;
+
+    return FP_TO_INT(y + (vy * timeToReach) / 16);
+}
+
+void ScheduleAIReaction(WORD *timer, const AISettings *ai)
+{
+    if (*timer == 0) *timer = ai->reactionDelay;
+}
+
+void UpdateAIPaddle(GameContext *ctx, Paddle *paddle, WORD *timer,
+                    const AISettings *ai, BOOL rightSide)
 {
     WORD diff;
 
-    /* Only recalculate target periodically to reduce jitter */
-    ctx->aiUpdateTimer++;
-    if (ctx->aiUpdateTimer >= currentAI.updateInterval) {
-        ctx->aiUpdateTimer = 0;
-
-        /* Only track when ball is moving towards AI */
-        if (ctx->ball.vx > 0) {
-            /* Predict where ball will be when it reaches AI paddle */
-            LONG timeToReach;
-            LONG aiPaddleX = INT_TO_FP(SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH);
-            LONG vxShifted;
+    /* Recalculate target only once a scheduled reaction falls due */
+    if (*timer > 0 && --(*timer) == 0) {
+
+        /* Only track when ball is moving towards this paddle */
+        if (rightSide ? ctx->ball.vx > 0 : ctx->ball.vx < 0) {
+            /* Predict where ball will be when it reaches the paddle */
             WORD predictedY;
             WORD error;
 
-            /* Safe division - avoid divide by zero */
-            vxShifted = ctx->ball.vx >> 4;
-            if (vxShifted < 1) vxShifted = 1;
-
-            timeToReach = (aiPaddleX - ctx->ball.x) / vxShifted;
-            if (timeToReach < 0) timeToReach = 0;
-            if (timeToReach > 128) timeToReach = 128;
-
-            predictedY = FP_TO_INT(ctx->ball.y + (ctx->ball.vy * timeToReach) / 16);
+            predictedY = PredictIntercept(ctx->ball.x, ctx->ball.y,
+                                          ctx->ball.vx, ctx->ball.vy,
+                                          rightSide ? AI_PADDLE_FACE_X : PLAYER_PADDLE_FACE_X);
 
             /* Add some error based on difficulty */
-            if (currentAI.errorMargin > 0) {
-                error = Random(currentAI.errorMargin * 2 + 1) - currentAI.errorMargin;
+            if (ai->errorMargin > 0) {
+                error = Random(ctx, ai->errorMargin * 2 + 1) - ai->errorMargin;
                 predictedY += error;
             }
 
@@ -152,15 +262,15 @@ static void UpdateAI(GameContext *ctx)
             predictedY = Clamp(predictedY, PADDLE_HEIGHT / 2,
                               SCREEN_HEIGHT - PADDLE_HEIGHT / 2);
 
-            ctx->aiPaddle.targetY = predictedY;
+            paddle->targetY = predictedY;
         } else {
             /* Ball moving away - return to center slowly */
-            ctx->aiPaddle.targetY = SCREEN_HEIGHT / 2;
+            paddle->targetY = SCREEN_HEIGHT / 2;
         }
     }
 
     /* Calculate difference to target */
-    diff = ctx->aiPaddle.targetY - ctx->aiPaddle.y;
+    diff = paddle->targetY - paddle->y;
 
     /* Dead zone: don't move if close enough to target (reduces jitter) */
     if (AbsW(diff) <= AI_DEAD_ZONE) {
@@ -168,24 +278,24 @@ static void UpdateAI(GameContext *ctx)
     }
 
     /* Move towards target with limited speed */
-    if (diff > currentAI.speed) {
-        ctx->aiPaddle.y += currentAI.speed;
-    } else if (diff < -currentAI.speed) {
-        ctx->aiPaddle.y -= currentAI.speed;
+    if (diff > ai->speed) {
+        paddle->y += ai->speed;
+    } else if (diff < -ai->speed) {
+        paddle->y -= ai->speed;
     } else {
-        ctx->aiPaddle.y = ctx->aiPaddle.targetY;
+        paddle->y = paddle->targetY;
     }
 
     /* Clamp to screen bounds */
-    ctx->aiPaddle.y = Clamp(ctx->aiPaddle.y, PADDLE_HEIGHT / 2,
-                            SCREEN_HEIGHT - PADDLE_HEIGHT / 2);
+    paddle->y = Clamp(paddle->y, PADDLE_HEIGHT / 2,
+                      SCREEN_HEIGHT - PADDLE_HEIGHT / 2);
 }
 
 /* Check paddle collision and return TRUE if hit */
-static BOOL CheckPaddleCollision(GameContext *ctx, WORD paddleX, WORD paddleY)
+static BOOL CheckPaddleCollision(const Ball *ball, WORD paddleX, WORD paddleY)
 {
-    WORD ballX = FP_TO_INT(ctx->ball.x);
-    WORD ballY = FP_TO_INT(ctx->ball.y);
+    WORD ballX = FP_TO_INT(ball->x);
+    WORD ballY = FP_TO_INT(ball->y);
     WORD ballLeft = ballX - BALL_SIZE / 2;
     WORD ballRight = ballX + BALL_SIZE / 2;
     WORD ballTop = ballY - BALL_SIZE / 2;
@@ -207,85 +317,148 @@ static BOOL CheckPaddleCollision(GameContext *ctx, WORD paddleX, WORD paddleY)
 static LONG CalculateSpin(WORD ballY, WORD paddleY)
 {
     WORD offset = ballY - paddleY;
-    LONG spin;
 
     /* Offset ranges from -PADDLE_HEIGHT/2 to +PADDLE_HEIGHT/2 */
-    /* Convert to fixed-point spin (-2 to +2) */
-    spin = (offset * INT_TO_FP(3)) / (PADDLE_HEIGHT / 2);
+    /* Fixed-point spin (-3 to +3), clamped, from the table */
+    if (offset < -SPIN_RANGE) offset = -SPIN_RANGE;
+    if (offset > SPIN_RANGE) offset = SPIN_RANGE;
 
-    /* Clamp spin */
-    if (spin > INT_TO_FP(3)) spin = INT_TO_FP(3);
-    if (spin < INT_TO_FP(-3)) spin = INT_TO_FP(-3);
+    return spinTable[offset + SPIN_RANGE];
+}
 
-    return spin;
+/*
+ * Motion in sub-step k of a frame split 1 << shift ways: the steps
+ * add up to exactly v, however it divides
+ */
+static FIXED SubStep(FIXED v, WORD k, WORD shift)
+{
+    if (shift == 0) return v;
+    return (FIXED)((((LONG)v * (k + 1)) >> shift) - (((LONG)v * k) >> shift));
 }
 
-void UpdateGame(GameContext *ctx, WORD playerMouseY)
+BOOL BounceBallOffWalls(Ball *ball)
 {
-    WORD ballX, ballY;
-    LONG speed;
+    WORD ballY = FP_TO_INT(ball->y);
 
-    if (ctx->state != STATE_PLAYING) {
-        return;
+    /* Keep ball below score area (y=48 minimum to stay below scores at y=45) */
+    if (ballY - BALL_SIZE / 2 <= 48) {
+        ball->y = INT_TO_FP(48 + BALL_SIZE / 2);
+        ball->vy = -ball->vy;
+        return TRUE;
+    } else if (ballY + BALL_SIZE / 2 >= SCREEN_HEIGHT) {
+        ball->y = INT_TO_FP(SCREEN_HEIGHT - BALL_SIZE / 2);
+        ball->vy = -ball->vy;
+        return TRUE;
     }
+    return FALSE;
+}
 
-    /* Update player paddle to follow mouse */
-    ctx->playerPaddle.y = Clamp(playerMouseY, PADDLE_HEIGHT / 2,
-                                 SCREEN_HEIGHT - PADDLE_HEIGHT / 2);
+BOOL BounceBallOffPaddle(Ball *ball, FIXED x0, FIXED y0, WORD paddleY, BOOL rightSide,
+                         WORD stepShift)
+{
+    WORD paddleX = rightSide ? AI_PADDLE_FACE_X : PADDLE_OFFSET;
+    WORD contactX = rightSide ? AI_PADDLE_FACE_X - BALL_SIZE / 2
+                              : PLAYER_PADDLE_FACE_X + BALL_SIZE / 2;
+    LONG face = INT_TO_FP((LONG)contactX);
+    LONG before = rightSide ? face - x0 : x0 - face;
+    LONG after = rightSide ? face - ball->x : ball->x - face;
+    LONG hitY64 = FP_TO_64THS((LONG)ball->y);
+    UWORD rest = 0;    /* Part of the step left after the hit, 1/256ths */
+    LONG speed;
 
-    /* Update AI */
-    UpdateAI(ctx);
+    if (before > 0 && after <= 0) {
+        /* Swept: the centre crossed the contact line this step */
+        UWORD n = (UWORD)(Abs(ball->x - x0) >> (FP_SHIFT - 4));
+        ULONG t256;
+        LONG y064 = FP_TO_64THS((LONG)y0);
 
-    /* Move ball */
-    ctx->ball.x += ctx->ball.vx;
-    ctx->ball.y += ctx->ball.vy;
+        if (n < 2) n = 2;
+        if (n >= RECIP_SIZE) n = RECIP_SIZE - 1;
 
-    ballX = FP_TO_INT(ctx->ball.x);
-    ballY = FP_TO_INT(ctx->ball.y);
+        /* Time of impact: distance (1/64 px) over speed (1/16 px) */
+        t256 = ((ULONG)FP_TO_64THS(before) * recipTable[n]) >> 10;
+        if (t256 > 256) t256 = 256;
 
-    /* Wall collision (top/bottom) */
-    /* Keep ball below score area (y=48 minimum to stay below scores at y=45) */
-    if (ballY - BALL_SIZE / 2 <= 48) {
-        ctx->ball.y = INT_TO_FP(48 + BALL_SIZE / 2);
-        ctx->ball.vy = -ctx->ball.vy;
-    } else if (ballY + BALL_SIZE / 2 >= SCREEN_HEIGHT) {
-        ctx->ball.y = INT_TO_FP(SCREEN_HEIGHT - BALL_SIZE / 2);
-        ctx->ball.vy = -ctx->ball.vy;
+        hitY64 = y064 + (((FP_TO_64THS((LONG)ball->y) - y064) * (LONG)t256) >> 8);
+        if (AbsW((WORD)((hitY64 >> 6) - paddleY)) > PADDLE_HEIGHT / 2 + BALL_SIZE / 2) {
+            hitY64 = FP_TO_64THS((LONG)ball->y);
+        } else {
+            rest = (UWORD)(256 - t256);
+        }
     }
 
-    /* Player paddle collision */
-    if (ctx->ball.vx < 0 && ballX < SCREEN_WIDTH / 2) {
-        if (CheckPaddleCollision(ctx, PADDLE_OFFSET, ctx->playerPaddle.y)) {
-            /* Bounce with spin */
-            ctx->ball.vx = -ctx->ball.vx;
-            ctx->ball.x = INT_TO_FP(PADDLE_OFFSET + PADDLE_WIDTH + BALL_SIZE / 2);
-            ctx->ball.vy += CalculateSpin(ballY, ctx->playerPaddle.y);
-
-            /* Speed up */
-            ctx->rallies++;
-            speed = Abs(ctx->ball.vx) + BALL_SPEED_INCREASE;
-            if (speed > BALL_MAX_SPEED) speed = BALL_MAX_SPEED;
-            ctx->ball.vx = speed;
-
-            /* Reset AI timer so it recalculates after player hit */
-            ctx->aiUpdateTimer = currentAI.updateInterval;
-        }
+    if (rest == 0) {
+        /* Discrete: the ball overlaps the paddle where it ended up */
+        if (!CheckPaddleCollision(ball, paddleX, paddleY)) return FALSE;
     }
 
-    /* AI paddle collision */
-    if (ctx->ball.vx > 0 && ballX > SCREEN_WIDTH / 2) {
-        if (CheckPaddleCollision(ctx, SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH,
-                                  ctx->aiPaddle.y)) {
-            /* Bounce with spin */
-            ctx->ball.vx = -ctx->ball.vx;
-            ctx->ball.x = INT_TO_FP(SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH - BALL_SIZE / 2);
-            ctx->ball.vy += CalculateSpin(ballY, ctx->aiPaddle.y);
-
-            /* Speed up */
-            ctx->rallies++;
-            speed = Abs(ctx->ball.vx) + BALL_SPEED_INCREASE;
-            if (speed > BALL_MAX_SPEED) speed = BALL_MAX_SPEED;
-            ctx->ball.vx = -speed;
+    /* Bounce with spin */
+    ball->vy += CalculateSpin((WORD)(hitY64 >> 6), paddleY);
+
+    /* Speed up */
+    speed = Abs(ball->vx) + BALL_SPEED_INCREASE;
+    if (speed > BALL_MAX_SPEED) speed = BALL_MAX_SPEED;
+    ball->vx = rightSide ? -speed : speed;
+
+    /* Contact point, then the rest of the step's motion away from it */
+    ball->x = face + FP_FROM_64THS((FP_TO_64THS(ball->vx) * (LONG)rest) >> (8 + stepShift));
+    ball->y = FP_FROM_64THS(hitY64 +
+                            ((FP_TO_64THS((LONG)ball->vy) * (LONG)rest) >> (8 + stepShift)));
+    if (rest) BounceBallOffWalls(ball);
+
+    return TRUE;
+}
+
+/* Move the ball for one frame once both paddles have moved, and score */
+static void UpdateBall(GameContext *ctx)
+{
+    WORD ballX = 0;
+    WORD steps, k;
+    FIXED x0, y0;
+
+    /* Move the ball a sub-step at a time, colliding after each one */
+    if (ctx->subStepShift > MAX_SUBSTEP_SHIFT) ctx->subStepShift = MAX_SUBSTEP_SHIFT;
+    steps = (WORD)(1 << ctx->subStepShift);
+
+    for (k = 0; k < steps; k++) {
+        x0 = ctx->ball.x;
+        y0 = ctx->ball.y;
+        ctx->ball.x += SubStep(ctx->ball.vx, k, ctx->subStepShift);
+        ctx->ball.y += SubStep(ctx->ball.vy, k, ctx->subStepShift);
+
+        ballX = FP_TO_INT(ctx->ball.x);
+
+        /*
+         * Wall collision (top/bottom). A sub-stepped ball can take a few
+         * steps to leave the wall after a bounce, so it only bounces
+         * while heading into the wall; a whole-frame step keeps the
+         * original rule.
+         */
+        if ((steps == 1 || (ctx->ball.vy < 0) == (ctx->ball.y < INT_TO_FP(SCREEN_HEIGHT / 2))) &&
+            BounceBallOffWalls(&ctx->ball)) {
+            ScheduleAIReaction(&ctx->aiUpdateTimer, &ctx->ai);
+        }
+
+        /* Player paddle collision */
+        if (ctx->ball.vx < 0 && ballX < SCREEN_WIDTH / 2) {
+            if (BounceBallOffPaddle(&ctx->ball, x0, y0, ctx->playerPaddle.y,
+                                    FALSE, ctx->subStepShift)) {
+                ctx->rallies++;
+
+                /* Ball heading for the AI: it reacts after its delay */
+                ScheduleAIReaction(&ctx->aiUpdateTimer, &ctx->ai);
+            }
+        }
+
+        /* AI paddle collision */
+        if (ctx->ball.vx > 0 && ballX > SCREEN_WIDTH / 2) {
+            if (BounceBallOffPaddle(&ctx->ball, x0, y0, ctx->aiPaddle.y,
+                                    TRUE, ctx->subStepShift)) {
+                ctx->rallies++;
+
+                /* Ball heading away: AI drifts back to the centre */
+                ScheduleAIReaction(&ctx->aiUpdateTimer, &ctx->ai);
+            }
         }
     }
 
@@ -319,6 +492,134 @@ void UpdateGame(GameContext *ctx, WORD playerMouseY)
     if (ctx->ball.y > INT_TO_FP(SCREEN_HEIGHT + 50)) ctx->ball.y = INT_TO_FP(SCREEN_HEIGHT + 50);
 }
 
+void UpdateGame(GameContext *ctx, WORD playerMouseY)
+{
+    if (ctx->state != STATE_PLAYING) {
+        return;
+    }
+
+    /* Update player paddle to follow mouse */
+    ctx->playerPaddle.y = Clamp(playerMouseY, PADDLE_HEIGHT / 2,
+                                 SCREEN_HEIGHT - PADDLE_HEIGHT / 2);
+
+    /* Update AI */
+    UpdateAIPaddle(ctx, &ctx->aiPaddle, &ctx->aiUpdateTimer, &ctx->ai, TRUE);
+
+    UpdateBall(ctx);
+}
+
+void UpdateVersus(GameContext *ctx, WORD leftMouseY, WORD rightMouseY)
+{
+    if (ctx->state != STATE_PLAYING) {
+        return;
+    }
+
+    ctx->playerPaddle.y = Clamp(leftMouseY, PADDLE_HEIGHT / 2,
+                                 SCREEN_HEIGHT - PADDLE_HEIGHT / 2);
+    ctx->aiPaddle.y = Clamp(rightMouseY, PADDLE_HEIGHT / 2,
+                             SCREEN_HEIGHT - PADDLE_HEIGHT / 2);
+
+    UpdateBall(ctx);
+}
+
+ULONG ChecksumGame(ULONG sum, const GameContext *ctx)
+{
+    ULONG values[14];
+    WORD i;
+
+    values[0] = (ULONG)FP_TO_64THS((LONG)ctx->ball.x);
+    values[1] = (ULONG)FP_TO_64THS((LONG)ctx->ball.y);
+    values[2] = (ULONG)FP_TO_64THS((LONG)ctx->ball.vx);
+    values[3] = (ULONG)FP_TO_64THS((LONG)ctx->ball.vy);
+    values[4] = (ULONG)ctx->playerPaddle.y;
+    values[5] = (ULONG)ctx->aiPaddle.y;
+    values[6] = (ULONG)(ctx->playerScore * 256 + ctx->aiScore);
+    values[7] = (ULONG)ctx->state;
+    values[8] = (ULONG)ctx->playerPaddle.targetY;
+    values[9] = (ULONG)ctx->aiPaddle.targetY;
+    values[10] = (ULONG)(ctx->rallies * 256 + (ctx->servingPlayer ? 1 : 0));
+    values[11] = (ULONG)ctx->aiUpdateTimer;
+    values[12] = (ULONG)(ctx->rng >> 32);
+    values[13] = (ULONG)ctx->rng;
+    for (i = 0; i < 14; i++) sum = (sum ^ values[i]) * 16777619UL;
+    return sum;
+}
+
+static UBYTE *PackWord(UBYTE *p, WORD w)
+{
+    p[0] = (UBYTE)((UWORD)w >> 8);
+    p[1] = (UBYTE)w;
+    return p + 2;
+}
+
+static UBYTE *PackLong(UBYTE *p, ULONG l)
+{
+    return PackWord(PackWord(p, (WORD)(l >> 16)), (WORD)l);
+}
+
+static WORD UnpackWord(const UBYTE *p)
+{
+    return (WORD)((p[0] << 8) | p[1]);
+}
+
+static ULONG UnpackLong(const UBYTE *p)
+{
+    return ((ULONG)(UWORD)UnpackWord(p) << 16) | (UWORD)UnpackWord(p + 2);
+}
+
+void PackGame(const GameContext *ctx, UBYTE *image)
+{
+    UBYTE *p = image;
+
+    p = PackLong(p, (ULONG)FP_TO_64THS((LONG)ctx->ball.x));
+    p = PackLong(p, (ULONG)FP_TO_64THS((LONG)ctx->ball.y));
+    p = PackLong(p, (ULONG)FP_TO_64THS((LONG)ctx->ball.vx));
+    p = PackLong(p, (ULONG)FP_TO_64THS((LONG)ctx->ball.vy));
+    p = PackWord(p, ctx->playerPaddle.y);
+    p = PackWord(p, ctx->playerPaddle.targetY);
+    p = PackWord(p, ctx->aiPaddle.y);
+    p = PackWord(p, ctx->aiPaddle.targetY);
+    p = PackWord(p, ctx->playerScore);
+    p = PackWord(p, ctx->aiScore);
+    p = PackWord(p, ctx->rallies);
+    p = PackWord(p, (WORD)ctx->servingPlayer);
+    p = PackWord(p, ctx->aiUpdateTimer);
+    p = PackWord(p, (WORD)ctx->state);
+    p = PackWord(p, (WORD)ctx->difficulty);
+    p = PackWord(p, ctx->ai.speed);
+    p = PackWord(p, ctx->ai.errorMargin);
+    p = PackWord(p, ctx->ai.reactionDelay);
+    p = PackWord(p, ctx->subStepShift);
+    p = PackLong(p, (ULONG)(ctx->rng >> 32));
+    PackLong(p, (ULONG)ctx->rng);
+}
+
+void UnpackGame(GameContext *ctx, const UBYTE *image)
+{
+    const UBYTE *w = image + 16;
+
+    ctx->ball.x = (FIXED)FP_FROM_64THS((LONG)UnpackLong(image));
+    ctx->ball.y = (FIXED)FP_FROM_64THS((LONG)UnpackLong(image + 4));
+    ctx->ball.vx = (FIXED)FP_FROM_64THS((LONG)UnpackLong(image + 8));
+    ctx->ball.vy = (FIXED)FP_FROM_64THS((LONG)UnpackLong(image + 12));
+    ctx->playerPaddle.y = UnpackWord(w);
+    ctx->playerPaddle.targetY = UnpackWord(w + 2);
+    ctx->aiPaddle.y = UnpackWord(w + 4);
+    ctx->aiPaddle.targetY = UnpackWord(w + 6);
+    ctx->playerScore = UnpackWord(w + 8);
+    ctx->aiScore = UnpackWord(w + 10);
+    ctx->rallies = UnpackWord(w + 12);
+    ctx->servingPlayer = (BOOL)UnpackWord(w + 14);
+    ctx->aiUpdateTimer = UnpackWord(w + 16);
+    ctx->state = (GameState)UnpackWord(w + 18);
+    ctx->difficulty = (Difficulty)UnpackWord(w + 20);
+    ctx->ai.speed = UnpackWord(w + 22);
+    ctx->ai.errorMargin = UnpackWord(w + 24);
+    ctx->ai.reactionDelay = UnpackWord(w + 26);
+    ctx->subStepShift = UnpackWord(w + 28);
+    ctx->rng = ((RandomState)UnpackLong(w + 30) << 32) | UnpackLong(w + 34);
+}
+
 BOOL IsGameOver(GameContext *ctx)
 {
     return (ctx->playerScore >= WINNING_SCORE || ctx->aiScore >= WINNING_SCORE);
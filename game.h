@@ -8,12 +8,29 @@
 
 #include <exec/types.h>
 
-/* Fixed-point 8.8 format */
+/*
+ * Fixed-point ball coordinates: 8.8 in a LONG by default, or with
+ * PONG_FIXED16 10.6 in a WORD, which the 68000 adds, compares and
+ * multiplies (MULS.W) in one go. (8.8 cannot be a WORD: x runs from
+ * -50 to 370.) Everything the game computes is a multiple of 1/64
+ * pixel, so both formats play identically.
+ */
+#ifdef PONG_FIXED16
+#define FP_SHIFT 6
+typedef WORD FIXED;
+#else
 #define FP_SHIFT 8
+typedef LONG FIXED;
+#endif
+
 #define FP_ONE   (1 << FP_SHIFT)
 #define INT_TO_FP(x) ((x) << FP_SHIFT)
 #define FP_TO_INT(x) ((x) >> FP_SHIFT)
 
+/* Fixed-point value in 1/64 pixels, the same in both formats, and back */
+#define FP_TO_64THS(x)   ((x) >> (FP_SHIFT - 6))
+#define FP_FROM_64THS(x) ((x) * (FP_ONE / 64))
+
 /* Game states */
 typedef enum {
     STATE_TITLE,
@@ -32,10 +49,10 @@ typedef enum {
 
 /* Ball structure with fixed-point position/velocity */
 typedef struct {
-    LONG x;      /* Fixed-point X position */
-    LONG y;      /* Fixed-point Y position */
-    LONG vx;     /* Fixed-point X velocity */
-    LONG vy;     /* Fixed-point Y velocity */
+    FIXED x;     /* Fixed-point X position */
+    FIXED y;     /* Fixed-point Y position */
+    FIXED vx;    /* Fixed-point X velocity */
+    FIXED vy;    /* Fixed-point Y velocity */
 } Ball;
 
 /* Paddle structure */
@@ -44,6 +61,26 @@ typedef struct {
     WORD targetY; /* AI target position */
 } Paddle;
 
+/*
+ * Random generator state: a 64-bit LCG, one per context. Streams
+ * for independent matches are split off a master state by jumping
+ * ahead RANDOM_STREAM_BITS draws per stream, so up to 2^24 streams
+ * of 2^40 draws each never overlap.
+ */
+typedef unsigned long long RandomState;
+
+#define RANDOM_STREAM_BITS 40
+
+/* AI difficulty settings per level */
+typedef struct {
+    WORD speed;          /* Max pixels AI can move per frame */
+    WORD errorMargin;    /* Random error in prediction */
+    WORD reactionDelay;  /* Frames from a trajectory change to the AI reacting */
+} AISettings;
+
+/* Preset AI settings, indexed by Difficulty */
+extern const AISettings difficultySettings[3];
+
 /* Game context */
 typedef struct {
     GameState state;
@@ -55,18 +92,52 @@ typedef struct {
     WORD aiScore;
     WORD rallies;        /* Count of paddle hits for speed increase */
     BOOL servingPlayer;  /* TRUE if player serves */
-    WORD aiUpdateTimer;  /* Timer for AI target recalculation */
+    WORD aiUpdateTimer;  /* Frames until the AI reacts (0 = nothing pending) */
+    AISettings ai;       /* AI settings (set by difficulty) */
+    RandomState rng;     /* Random generator state */
+    WORD subStepShift;   /* Ball moves in 1 << subStepShift steps a frame */
 } GameContext;
 
 /* Initialize game state */
 void InitGame(GameContext *ctx);
 
+/*
+ * Start a match at the context's difficulty: a fresh InitGame() in
+ * STATE_PLAYING. The match then depends only on the RNG state,
+ * difficulty and subStepShift going in, and the mouse input.
+ */
+void StartMatch(GameContext *ctx);
+
 /* Reset ball to center with serve direction */
 void ResetBall(GameContext *ctx);
 
-/* Update game logic - called once per frame */
+/* Update game logic - called once per simulation step (see timing.h) */
 void UpdateGame(GameContext *ctx, WORD playerMouseY);
 
+/*
+ * Two-player step: the right paddle follows a second mouse instead of
+ * the AI (see netplay.h), so a versus match depends only on the setup
+ * going in and both players' input.
+ */
+void UpdateVersus(GameContext *ctx, WORD leftMouseY, WORD rightMouseY);
+
+/*
+ * Fold a match's state into a running checksum (FNV-1a style). Ball
+ * values go in as 1/64 pixels, so the LONG 8.8 and WORD 10.6 builds
+ * give the same checksum for the same match.
+ */
+#define CHECKSUM_START 2166136261UL
+ULONG ChecksumGame(ULONG sum, const GameContext *ctx);
+
+/*
+ * The whole context as a fixed big-endian byte image, ball values in
+ * 1/64 pixels: the same bytes from both FIXED builds and any CPU.
+ * Replay keyframes and the rewind history store it.
+ */
+#define GAME_IMAGE_SIZE 54
+void PackGame(const GameContext *ctx, UBYTE *image);
+void UnpackGame(GameContext *ctx, const UBYTE *image);
+
 /* Check if game is over (someone reached 11) */
 BOOL IsGameOver(GameContext *ctx);
 
@@ -76,15 +147,86 @@ BOOL PlayerWon(GameContext *ctx);
 /* Set difficulty level */
 void SetDifficulty(GameContext *ctx, Difficulty diff);
 
+/* Seed the context's random generator (for reproducible runs) */
+void SetRandomSeed(GameContext *ctx, ULONG seed);
+
+/* Default seed for a freshly started program */
+#define RANDOM_DEFAULT_SEED 12345
+
+/* Set a generator state from a 32-bit seed */
+void SeedRandom(RandomState *rng, ULONG seed);
+
+/* Advance a generator and return a value in 0..max-1 */
+WORD NextRandom(RandomState *rng, WORD max);
+
+/* Skip a generator ahead by steps draws in O(log steps) */
+void JumpRandom(RandomState *rng, RandomState steps);
+
+/* Make stream number index of master (master itself is stream 0) */
+void SplitRandom(RandomState *stream, const RandomState *master, ULONG index);
+
+/*
+ * Schedule an AI reaction after a trajectory change (serve, wall
+ * bounce, paddle hit), unless one is already pending
+ */
+void ScheduleAIReaction(WORD *timer, const AISettings *ai);
+
+/*
+ * Move an AI-controlled paddle towards its predicted intercept,
+ * re-predicting only when a scheduled reaction falls due.
+ * UpdateGame() does this for the AI paddle; call it for the player
+ * paddle (rightSide = FALSE) to have the computer play both sides.
+ */
+void UpdateAIPaddle(GameContext *ctx, Paddle *paddle, WORD *timer,
+                    const AISettings *ai, BOOL rightSide);
+
+/* X of the paddle face the ball bounces off, per side */
+#define PLAYER_PADDLE_FACE_X (PADDLE_OFFSET + PADDLE_WIDTH)
+#define AI_PADDLE_FACE_X     (SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH)
+
+/*
+ * Predict the ball's pixel Y when it reaches the paddle face at faceX,
+ * folding the straight-line path between the top and bottom walls so
+ * bounces are accounted for. Uses a reciprocal table and 16x16 bit
+ * multiplies only. vx must point towards faceX.
+ */
+WORD PredictIntercept(LONG x, LONG y, LONG vx, LONG vy, WORD faceX);
+
+/*
+ * Bounce the ball off the top/bottom walls if it has reached one;
+ * returns TRUE if it did
+ */
+BOOL BounceBallOffWalls(Ball *ball);
+
+/*
+ * Bounce the ball off a paddle (the AI's if rightSide) after it has
+ * moved from (x0, y0) to where it is now. The move is swept against
+ * the paddle face, so a fast ball cannot pass through it: on a hit
+ * the ball is put at the point of contact, given its new velocity
+ * (spin from the contact offset, speed-up) and carried on for the
+ * rest of the step. A paddle that has moved onto the ball still
+ * counts as a hit, with the ball put back at the face. stepShift is
+ * the move's share of a frame, 1 / (1 << stepShift), when sub-stepping.
+ * Returns TRUE on a hit.
+ */
+BOOL BounceBallOffPaddle(Ball *ball, FIXED x0, FIXED y0, WORD paddleY, BOOL rightSide,
+                         WORD stepShift);
+
+/* The original predictor: linear, no bounces, 8 frames lookahead (for comparison) */
+WORD PredictInterceptLinear(LONG x, LONG y, LONG vx, LONG vy, WORD faceX);
+
 /* AI dead zone - don't move if within this many pixels of target */
 #define AI_DEAD_ZONE 4
 
 /* Ball speed settings */
 #define BALL_INITIAL_SPEED INT_TO_FP(2)
 #define BALL_MAX_SPEED     INT_TO_FP(12)
-#define BALL_SPEED_INCREASE 48  /* Added each rally (fixed-point) */
+#define BALL_SPEED_INCREASE (FP_ONE * 3 / 16)  /* Added each rally */
 
 /* Win condition */
 #define WINNING_SCORE 11
 
+/* Most sub-steps per frame: 1 << MAX_SUBSTEP_SHIFT */
+#define MAX_SUBSTEP_SHIFT 3
+
 #endif /* GAME_H */
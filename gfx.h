@@ -0,0 +1,89 @@
+/*
+ * gfx.h - Drawing backend beneath graphics.c
+ * Amiga Pong - OS-friendly implementation
+ *
+ * graphics.c draws every screen through these calls and nothing else.
+ * gfxamiga.c implements them with graphics.library on a double
+ * buffered Intuition screen and hardware sprites. host/gfxsoft.c
+ * renders into two 320x256x3 planar bitmaps in memory with the sprites
+ * kept as an overlay, so the screens can be checked and timed on the
+ * build machine.
+ */
+
+#ifndef GFX_H
+#define GFX_H
+
+#include <exec/types.h>
+#include <intuition/intuition.h>
+
+#include "dirty.h"
+
+typedef enum {
+    GFX_SPRITE_BALL,     /* 8x8 */
+    GFX_SPRITE_PLAYER,   /* 8x36, the paddle in rows 2-33 */
+    GFX_SPRITE_AI,
+    GFX_SPRITES
+} GfxSprite;
+
+/* Open the display with the given RGB4 colours; FALSE if it could not be */
+BOOL GfxOpen(const UWORD *palette, WORD colors);
+void GfxClose(void);
+
+/* Window for IDCMP input (NULL in the software backend) */
+struct Window *GfxWindow(void);
+
+/* Playfield drawing; rectangles are inclusive and clipped to the screen */
+void GfxClear(UBYTE color);
+void GfxRectFill(WORD x0, WORD y0, WORD x1, WORD y1, UBYTE color);
+
+/* 8x8 text with its baseline at y (the top is y - 6), on the background colour */
+void GfxText(WORD x, WORD y, const char *text, WORD length, UBYTE color);
+
+/*
+ * Glyphs: count images up to GFX_GLYPH_WIDTH pixels wide and height
+ * rows tall, one UWORD a row (leftmost pixel in the top bit), glyph
+ * after glyph. They are copied once into a strip (chip RAM on the
+ * Amiga) and each is then drawn with a single blit: set bits in the
+ * colour, clear bits in the background colour, so a glyph replaces
+ * whatever was in its cell. Loading again replaces the strip.
+ */
+#define GFX_GLYPH_WIDTH 16
+BOOL GfxLoadGlyphs(const UWORD *rows, WORD count, WORD height);
+
+/* Glyph top-left corner; the cell must lie across the screen */
+void GfxGlyph(WORD glyph, WORD x, WORD y, UBYTE color);
+
+/*
+ * Off-screen copies of the playfield, each the size of the screen.
+ * GfxSave() copies a rectangle of the screen to the same place in the
+ * copy and GfxRestore() copies it back, each as one blit.
+ */
+typedef enum {
+    GFX_COPY_COURT,      /* The empty court, restored for a full redraw */
+    GFX_COPY_UNDER,      /* What the pause text covers */
+    GFX_COPIES
+} GfxCopy;
+
+void GfxSave(GfxCopy copy, WORD x0, WORD y0, WORD x1, WORD y1);
+void GfxRestore(GfxCopy copy, WORD x0, WORD y0, WORD x1, WORD y1);
+
+/*
+ * Show what has been drawn. Drawing goes to a back buffer while the
+ * other is shown; after the swap the rectangles in changed (all that
+ * was drawn since the last swap) are copied into the new back buffer
+ * before it is drawn into or read, so both hold the same picture. The
+ * software backend swaps the same way. With one buffer (the Amiga
+ * before V39) drawing is already on screen and this does nothing.
+ */
+void GfxSwap(const DirtyList *changed);
+
+/* Sprite top-left corner in screen pixels; off screen hides it */
+void GfxMoveSprite(GfxSprite sprite, WORD x, WORD y);
+
+/* Wait for the beam to pass the bottom of the screen (WaitBOVP()) */
+void GfxWaitBeam(void);
+
+/* Wait for the next vertical blank (WaitTOF()) */
+void GfxWaitFrame(void);
+
+#endif /* GFX_H */
@@ -0,0 +1,677 @@
+/*
+ * gfxamiga.c - Drawing backend on graphics.library
+ * Amiga Pong - OS-friendly implementation
+ *
+ * A custom screen with a backdrop window for input. The ball and
+ * paddles are hardware sprites - flicker-free! On Kickstart 3 the
+ * playfield is double buffered with AllocScreenBuffer(): drawing goes
+ * to the buffer not shown and ChangeScreenBuffer() shows it at the
+ * next vertical blank. Before that it is drawn on screen directly.
+ */
+
+#include <exec/types.h>
+#include <exec/memory.h>
+#include <intuition/intuition.h>
+#include <intuition/screens.h>
+#include <graphics/gfx.h>
+#include <graphics/gfxbase.h>
+#include <graphics/view.h>
+#include <graphics/rastport.h>
+#include <graphics/sprite.h>
+
+#include <proto/exec.h>
+#include <proto/intuition.h>
+#include <proto/graphics.h>
+
+#include "gfx.h"
+#include "graphics.h"
+#include "dirty.h"
+
+/* External library bases */
+extern struct IntuitionBase *IntuitionBase;
+extern struct GfxBase *GfxBase;
+
+/* Screen and window */
+static struct Screen *gameScreen = NULL;
+static struct Window *gameWindow = NULL;
+static struct RastPort *screenRP = NULL;
+
+/* Hardware sprites */
+static struct SimpleSprite ballSprite;
+static struct SimpleSprite playerSprite;
+static struct SimpleSprite aiSprite;
+static WORD ballSpriteNum = -1;
+static WORD playerSpriteNum = -1;
+static WORD aiSpriteNum = -1;
+
+/* Sprite image data (must be in CHIP memory) */
+static UWORD *ballSpriteData = NULL;
+static UWORD *playerSpriteData = NULL;
+static UWORD *aiSpriteData = NULL;
+
+/* Blank pointer for hiding mouse */
+static UWORD *blankPointer = NULL;
+
+/*
+ * Glyph strip (CHIP memory): one row of every glyph after another, so
+ * glyph g starts at word g and the template modulo is the strip width
+ */
+static UWORD *glyphStrip = NULL;
+static ULONG glyphStripSize = 0;
+static WORD glyphCount = 0;
+static WORD glyphHeight = 0;
+
+/* Off-screen copies of the playfield (planes from AllocRaster(), V37) */
+static struct BitMap copies[GFX_COPIES];
+
+/*
+ * Double buffering (V39). buffers[drawBuffer] is drawn into through
+ * backRP while the other is shown. After a change the safe message
+ * says the old buffer may be drawn into, and the disp message that the
+ * change is on screen and another may be made.
+ */
+static struct ScreenBuffer *buffers[2] = { NULL, NULL };
+static struct MsgPort *safePort = NULL;
+static struct MsgPort *dispPort = NULL;
+static struct RastPort backRP;
+static WORD drawBuffer = 0;
+static BOOL doubleBuffered = FALSE;  /* AllocDoubleBuffer() got everything */
+static BOOL safeToWrite = TRUE;
+static BOOL safeToChange = TRUE;
+static DirtyList unshown;        /* Drawn since the last change that worked */
+static DirtyList pendingSync;    /* To copy from the shown buffer before drawing */
+
+/* Direct sprite position update - faster than MoveSprite() */
+static void SetSpritePosition(UWORD *spriteData, WORD x, WORD y, WORD height)
+{
+    /* Convert to hardware coordinates */
+    /* X needs +128 offset, Y needs screen offset (varies by PAL/NTSC) */
+    WORD hstart = x + 128;
+    WORD vstart = y + 44;  /* PAL vertical offset */
+    WORD vstop = vstart + height;
+
+    /* Encode into sprite control words */
+    /* Word 0: VSTART[7:0] | HSTART[8:1] */
+    /* Word 1: VSTOP[7:0] | ATT | VSTART[8] | VSTOP[8] | HSTART[0] | 0000 */
+    spriteData[0] = ((vstart & 0xFF) << 8) | ((hstart >> 1) & 0xFF);
+    spriteData[1] = ((vstop & 0xFF) << 8) |
+                    ((vstart >> 8) & 1) << 2 |
+                    ((vstop >> 8) & 1) << 1 |
+                    (hstart & 1);
+}
+
+/* Sprite data sizes */
+#define BALL_SPRITE_HEIGHT 8
+#define PADDLE_SPRITE_HEIGHT 36  /* 32 + some margin */
+
+/* Create ball sprite data (8x8 white square) */
+static UWORD *CreateBallSprite(void)
+{
+    UWORD *data;
+    int i;
+
+    /* Sprite format: 2 control words + height * 2 words + 2 terminator words */
+    data = (UWORD *)AllocMem((2 + BALL_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD), MEMF_CHIP | MEMF_CLEAR);
+    if (!data) return NULL;
+
+    /* Control words (will be set by system) */
+    data[0] = 0;
+    data[1] = 0;
+
+    /* Image data - 8x8 solid block */
+    /* Each line: plane0 word, plane1 word */
+    /* For white (color 3 in sprite), both planes = 1 */
+    for (i = 0; i < BALL_SPRITE_HEIGHT; i++) {
+        data[2 + i * 2] = 0xFF00;     /* Plane 0: 8 pixels set */
+        data[2 + i * 2 + 1] = 0xFF00; /* Plane 1: 8 pixels set */
+    }
+
+    /* Terminator */
+    data[2 + BALL_SPRITE_HEIGHT * 2] = 0;
+    data[2 + BALL_SPRITE_HEIGHT * 2 + 1] = 0;
+
+    return data;
+}
+
+/* Create paddle sprite data (8x32 solid block) */
+static UWORD *CreatePaddleSprite(BOOL isPlayer)
+{
+    UWORD *data;
+    int i;
+    UWORD plane0, plane1;
+
+    data = (UWORD *)AllocMem((2 + PADDLE_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD), MEMF_CHIP | MEMF_CLEAR);
+    if (!data) return NULL;
+
+    data[0] = 0;
+    data[1] = 0;
+
+    /* Player = white (color 3), AI = color 1 (will set sprite colors) */
+    if (isPlayer) {
+        plane0 = 0xFF00;
+        plane1 = 0xFF00;
+    } else {
+        /* For AI, use color 1 in sprite palette */
+        plane0 = 0xFF00;
+        plane1 = 0x0000;
+    }
+
+    for (i = 0; i < PADDLE_SPRITE_HEIGHT; i++) {
+        if (i >= 2 && i < PADDLE_SPRITE_HEIGHT - 2) {
+            data[2 + i * 2] = plane0;
+            data[2 + i * 2 + 1] = plane1;
+        } else {
+            data[2 + i * 2] = 0;
+            data[2 + i * 2 + 1] = 0;
+        }
+    }
+
+    data[2 + PADDLE_SPRITE_HEIGHT * 2] = 0;
+    data[2 + PADDLE_SPRITE_HEIGHT * 2 + 1] = 0;
+
+    return data;
+}
+
+static void FreeSprites(void)
+{
+    if (ballSpriteNum >= 0) {
+        FreeSprite(ballSpriteNum);
+        ballSpriteNum = -1;
+    }
+    if (playerSpriteNum >= 0) {
+        FreeSprite(playerSpriteNum);
+        playerSpriteNum = -1;
+    }
+    if (aiSpriteNum >= 0) {
+        FreeSprite(aiSpriteNum);
+        aiSpriteNum = -1;
+    }
+    if (ballSpriteData) {
+        FreeMem(ballSpriteData, (2 + BALL_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD));
+        ballSpriteData = NULL;
+    }
+    if (playerSpriteData) {
+        FreeMem(playerSpriteData, (2 + PADDLE_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD));
+        playerSpriteData = NULL;
+    }
+    if (aiSpriteData) {
+        FreeMem(aiSpriteData, (2 + PADDLE_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD));
+        aiSpriteData = NULL;
+    }
+}
+
+static BOOL InitSprites(void)
+{
+    /* Create sprite image data */
+    ballSpriteData = CreateBallSprite();
+    playerSpriteData = CreatePaddleSprite(TRUE);
+    aiSpriteData = CreatePaddleSprite(FALSE);
+
+    if (!ballSpriteData || !playerSpriteData || !aiSpriteData) {
+        FreeSprites();
+        return FALSE;
+    }
+
+    /* Get sprites from system */
+    ballSpriteNum = GetSprite(&ballSprite, 2);
+    if (ballSpriteNum < 0) {
+        /* Try another sprite number */
+        ballSpriteNum = GetSprite(&ballSprite, -1);
+    }
+
+    playerSpriteNum = GetSprite(&playerSprite, 4);
+    if (playerSpriteNum < 0) {
+        playerSpriteNum = GetSprite(&playerSprite, -1);
+    }
+
+    aiSpriteNum = GetSprite(&aiSprite, 6);
+    if (aiSpriteNum < 0) {
+        aiSpriteNum = GetSprite(&aiSprite, -1);
+    }
+
+    if (ballSpriteNum < 0 || playerSpriteNum < 0 || aiSpriteNum < 0) {
+        FreeSprites();
+        return FALSE;
+    }
+
+    /* Set up sprite structures */
+    ballSprite.posctldata = ballSpriteData;
+    ballSprite.height = BALL_SPRITE_HEIGHT;
+    ballSprite.x = 0;
+    ballSprite.y = 0;
+
+    playerSprite.posctldata = playerSpriteData;
+    playerSprite.height = PADDLE_SPRITE_HEIGHT;
+    playerSprite.x = 0;
+    playerSprite.y = 0;
+
+    aiSprite.posctldata = aiSpriteData;
+    aiSprite.height = PADDLE_SPRITE_HEIGHT;
+    aiSprite.x = 0;
+    aiSprite.y = 0;
+
+    /* Set sprite colors */
+    /* Sprites 2-3 use colors 21-23, sprites 4-5 use 25-27, sprites 6-7 use 29-31 */
+    /* But for SimpleSprite, colors are set in the ViewPort */
+
+    return TRUE;
+}
+
+static void FreeCopies(void)
+{
+    WORD c, p;
+
+    for (c = 0; c < GFX_COPIES; c++) {
+        for (p = 0; p < SCREEN_DEPTH; p++) {
+            if (copies[c].Planes[p]) {
+                FreeRaster(copies[c].Planes[p], SCREEN_WIDTH, SCREEN_HEIGHT);
+                copies[c].Planes[p] = NULL;
+            }
+        }
+    }
+}
+
+static BOOL AllocCopies(void)
+{
+    WORD c, p;
+
+    for (c = 0; c < GFX_COPIES; c++) {
+        InitBitMap(&copies[c], SCREEN_DEPTH, SCREEN_WIDTH, SCREEN_HEIGHT);
+        for (p = 0; p < SCREEN_DEPTH; p++) {
+            copies[c].Planes[p] = NULL;
+        }
+    }
+    for (c = 0; c < GFX_COPIES; c++) {
+        for (p = 0; p < SCREEN_DEPTH; p++) {
+            copies[c].Planes[p] = AllocRaster(SCREEN_WIDTH, SCREEN_HEIGHT);
+            if (!copies[c].Planes[p]) {
+                FreeCopies();
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+static void WaitForMessage(struct MsgPort *port)
+{
+    while (!GetMsg(port)) {
+        Wait(1L << port->mp_SigBit);
+    }
+}
+
+static void FreeDoubleBuffer(void)
+{
+    WORD i;
+
+    /*
+     * Only a complete set has reply ports on its buffers and may have
+     * changes in flight; after a partial allocation there is just
+     * memory to give back
+     */
+    if (doubleBuffered) {
+        /* Nothing may be pending when the buffers go */
+        if (!safeToWrite) {
+            WaitForMessage(safePort);
+            safeToWrite = TRUE;
+        }
+        if (!safeToChange) {
+            WaitForMessage(dispPort);
+            safeToChange = TRUE;
+        }
+
+        /* Leave the screen's own bitmap on show */
+        if (drawBuffer == 0 && ChangeScreenBuffer(gameScreen, buffers[0])) {
+            WaitForMessage(safePort);
+            WaitForMessage(dispPort);
+        }
+        screenRP = &gameScreen->RastPort;
+        doubleBuffered = FALSE;
+    }
+    for (i = 0; i < 2; i++) {
+        if (buffers[i]) {
+            FreeScreenBuffer(gameScreen, buffers[i]);
+            buffers[i] = NULL;
+        }
+    }
+    if (safePort) {
+        DeleteMsgPort(safePort);
+        safePort = NULL;
+    }
+    if (dispPort) {
+        DeleteMsgPort(dispPort);
+        dispPort = NULL;
+    }
+}
+
+/* FALSE leaves the screen single buffered, drawn through its own RastPort */
+static BOOL AllocDoubleBuffer(void)
+{
+    WORD i;
+
+    if (IntuitionBase->LibNode.lib_Version < 39) return FALSE;
+
+    safePort = CreateMsgPort();
+    dispPort = CreateMsgPort();
+    buffers[0] = AllocScreenBuffer(gameScreen, NULL, SB_SCREEN_BITMAP);
+    buffers[1] = AllocScreenBuffer(gameScreen, NULL, SB_COPY_BITMAP);
+    if (!safePort || !dispPort || !buffers[0] || !buffers[1]) {
+        FreeDoubleBuffer();
+        return FALSE;
+    }
+    for (i = 0; i < 2; i++) {
+        buffers[i]->sb_DBufInfo->dbi_SafeMessage.mn_ReplyPort = safePort;
+        buffers[i]->sb_DBufInfo->dbi_DispMessage.mn_ReplyPort = dispPort;
+    }
+
+    /* Buffer 0 is on screen: draw into buffer 1 */
+    InitRastPort(&backRP);
+    SetFont(&backRP, gameScreen->RastPort.Font);
+    drawBuffer = 1;
+    backRP.BitMap = buffers[drawBuffer]->sb_BitMap;
+    screenRP = &backRP;
+    ClearDirty(&unshown);
+    ClearDirty(&pendingSync);
+    doubleBuffered = TRUE;
+    return TRUE;
+}
+
+/*
+ * Before the back buffer is drawn into or read: wait until it is no
+ * longer shown, then bring it up to date with what the last frame
+ * changed in the other one
+ */
+static void SyncBackBuffer(void)
+{
+    struct BitMap *shown;
+    WORD i;
+
+    if (safeToWrite) return;
+
+    WaitForMessage(safePort);
+    safeToWrite = TRUE;
+
+    shown = buffers[drawBuffer ^ 1]->sb_BitMap;
+    for (i = 0; i < pendingSync.count; i++) {
+        const DirtyRect *r = &pendingSync.rects[i];
+
+        BltBitMap(shown, r->x0, r->y0, backRP.BitMap, r->x0, r->y0,
+                  r->x1 - r->x0 + 1, r->y1 - r->y0 + 1, 0xC0, 0xFF, NULL);
+    }
+    ClearDirty(&pendingSync);
+}
+
+BOOL GfxOpen(const UWORD *palette, WORD colors)
+{
+    struct NewScreen ns;
+    struct NewWindow nw;
+    int i;
+
+    blankPointer = (UWORD *)AllocMem(12, MEMF_CHIP | MEMF_CLEAR);
+    if (!blankPointer) return FALSE;
+
+    /* Open screen */
+    ns.LeftEdge = 0;
+    ns.TopEdge = 0;
+    ns.Width = SCREEN_WIDTH;
+    ns.Height = SCREEN_HEIGHT;
+    ns.Depth = SCREEN_DEPTH;
+    ns.DetailPen = COLOR_WHITE;
+    ns.BlockPen = COLOR_BACKGROUND;
+    ns.ViewModes = 0;
+    ns.Type = CUSTOMSCREEN | SCREENQUIET;
+    ns.Font = NULL;
+    ns.DefaultTitle = NULL;
+    ns.Gadgets = NULL;
+    ns.CustomBitMap = NULL;
+
+    gameScreen = OpenScreen(&ns);
+    if (!gameScreen) {
+        GfxClose();
+        return FALSE;
+    }
+
+    screenRP = &gameScreen->RastPort;
+
+    /* Set playfield palette */
+    for (i = 0; i < colors; i++) {
+        SetRGB4(&gameScreen->ViewPort, i,
+                (palette[i] >> 8) & 0xF,
+                (palette[i] >> 4) & 0xF,
+                palette[i] & 0xF);
+    }
+
+    /* Set sprite colors */
+    /* Sprite 2-3 colors are at index 21-23 */
+    SetRGB4(&gameScreen->ViewPort, 21, 0xF, 0xF, 0xF);  /* White */
+    SetRGB4(&gameScreen->ViewPort, 22, 0xF, 0xF, 0xF);  /* White */
+    SetRGB4(&gameScreen->ViewPort, 23, 0xF, 0xF, 0xF);  /* White */
+
+    /* Sprite 4-5 colors at 25-27 */
+    SetRGB4(&gameScreen->ViewPort, 25, 0xF, 0xF, 0xF);  /* White */
+    SetRGB4(&gameScreen->ViewPort, 26, 0xF, 0xF, 0xF);  /* White */
+    SetRGB4(&gameScreen->ViewPort, 27, 0xF, 0xF, 0xF);  /* White */
+
+    /* Sprite 6-7 colors at 29-31 */
+    SetRGB4(&gameScreen->ViewPort, 29, 0x0, 0xC, 0xF);  /* Cyan */
+    SetRGB4(&gameScreen->ViewPort, 30, 0x0, 0xC, 0xF);  /* Cyan */
+    SetRGB4(&gameScreen->ViewPort, 31, 0x0, 0xC, 0xF);  /* Cyan */
+
+    /* Initialize sprites */
+    if (!InitSprites()) {
+        GfxClose();
+        return FALSE;
+    }
+
+    if (!AllocCopies()) {
+        GfxClose();
+        return FALSE;
+    }
+
+    /* Clear screen */
+    SetRast(screenRP, COLOR_BACKGROUND);
+
+    /* Double buffer if the OS can; single buffered is no failure */
+    AllocDoubleBuffer();
+
+    /* Open window */
+    nw.LeftEdge = 0;
+    nw.TopEdge = 0;
+    nw.Width = SCREEN_WIDTH;
+    nw.Height = SCREEN_HEIGHT;
+    nw.DetailPen = COLOR_WHITE;
+    nw.BlockPen = COLOR_BACKGROUND;
+    nw.IDCMPFlags = IDCMP_MOUSEMOVE | IDCMP_MOUSEBUTTONS |
+                    IDCMP_RAWKEY | IDCMP_VANILLAKEY | IDCMP_CLOSEWINDOW;
+    nw.Flags = WFLG_BACKDROP | WFLG_BORDERLESS | WFLG_ACTIVATE |
+               WFLG_RMBTRAP | WFLG_REPORTMOUSE;
+    nw.FirstGadget = NULL;
+    nw.CheckMark = NULL;
+    nw.Title = NULL;
+    nw.Screen = gameScreen;
+    nw.BitMap = NULL;
+    nw.MinWidth = 0;
+    nw.MinHeight = 0;
+    nw.MaxWidth = 0;
+    nw.MaxHeight = 0;
+    nw.Type = CUSTOMSCREEN;
+
+    gameWindow = OpenWindow(&nw);
+    if (!gameWindow) {
+        GfxClose();
+        return FALSE;
+    }
+
+    SetPointer(gameWindow, blankPointer, 1, 1, 0, 0);
+
+    return TRUE;
+}
+
+static void FreeGlyphs(void)
+{
+    if (glyphStrip) {
+        FreeMem(glyphStrip, glyphStripSize);
+        glyphStrip = NULL;
+    }
+    glyphCount = 0;
+}
+
+void GfxClose(void)
+{
+    if (gameScreen) FreeDoubleBuffer();
+    FreeGlyphs();
+    FreeCopies();
+    FreeSprites();
+
+    if (gameWindow) {
+        ClearPointer(gameWindow);
+        CloseWindow(gameWindow);
+        gameWindow = NULL;
+    }
+    if (gameScreen) {
+        CloseScreen(gameScreen);
+        gameScreen = NULL;
+    }
+    if (blankPointer) {
+        FreeMem(blankPointer, 12);
+        blankPointer = NULL;
+    }
+    screenRP = NULL;
+}
+
+struct Window *GfxWindow(void)
+{
+    return gameWindow;
+}
+
+void GfxClear(UBYTE color)
+{
+    SyncBackBuffer();
+    SetRast(screenRP, color);
+}
+
+void GfxRectFill(WORD x0, WORD y0, WORD x1, WORD y1, UBYTE color)
+{
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= SCREEN_WIDTH) x1 = SCREEN_WIDTH - 1;
+    if (y1 >= SCREEN_HEIGHT) y1 = SCREEN_HEIGHT - 1;
+    if (x0 > x1 || y0 > y1) return;
+
+    SyncBackBuffer();
+    SetAPen(screenRP, color);
+    RectFill(screenRP, x0, y0, x1, y1);
+}
+
+void GfxText(WORD x, WORD y, const char *text, WORD length, UBYTE color)
+{
+    SyncBackBuffer();
+    SetAPen(screenRP, color);
+    Move(screenRP, x, y);
+    Text(screenRP, text, length);
+}
+
+BOOL GfxLoadGlyphs(const UWORD *rows, WORD count, WORD height)
+{
+    WORD g, r;
+
+    FreeGlyphs();
+
+    glyphStripSize = (ULONG)count * height * sizeof(UWORD);
+    glyphStrip = (UWORD *)AllocMem(glyphStripSize, MEMF_CHIP);
+    if (!glyphStrip) return FALSE;
+
+    for (g = 0; g < count; g++) {
+        for (r = 0; r < height; r++) {
+            glyphStrip[r * count + g] = rows[g * height + r];
+        }
+    }
+    glyphCount = count;
+    glyphHeight = height;
+    return TRUE;
+}
+
+void GfxGlyph(WORD glyph, WORD x, WORD y, UBYTE color)
+{
+    if (glyph < 0 || glyph >= glyphCount) return;
+
+    /* JAM2: the clear bits of the template paint the background */
+    SyncBackBuffer();
+    SetAPen(screenRP, color);
+    SetBPen(screenRP, COLOR_BACKGROUND);
+    SetDrMd(screenRP, JAM2);
+    BltTemplate((PLANEPTR)(glyphStrip + glyph), 0, glyphCount * sizeof(UWORD),
+                screenRP, x, y, GFX_GLYPH_WIDTH, glyphHeight);
+}
+
+void GfxSave(GfxCopy copy, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    SyncBackBuffer();
+    BltBitMap(screenRP->BitMap, x0, y0, &copies[copy], x0, y0,
+              x1 - x0 + 1, y1 - y0 + 1, 0xC0, 0xFF, NULL);
+}
+
+void GfxRestore(GfxCopy copy, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    SyncBackBuffer();
+    BltBitMap(&copies[copy], x0, y0, screenRP->BitMap, x0, y0,
+              x1 - x0 + 1, y1 - y0 + 1, 0xC0, 0xFF, NULL);
+}
+
+void GfxSwap(const DirtyList *changed)
+{
+    WORD i;
+
+    if (!doubleBuffered) return;     /* Single buffered: already on screen */
+
+    for (i = 0; i < changed->count; i++) {
+        const DirtyRect *r = &changed->rects[i];
+        AddDirty(&unshown, r->x0, r->y0, r->x1, r->y1);
+    }
+    if (unshown.count == 0) return;
+
+    /* Make sure the back buffer was drawn into, and the last change shown */
+    SyncBackBuffer();
+    if (!safeToChange) {
+        WaitForMessage(dispPort);
+        safeToChange = TRUE;
+    }
+
+    /* This fails while Intuition is busy with the screen: try next frame */
+    if (ChangeScreenBuffer(gameScreen, buffers[drawBuffer])) {
+        safeToWrite = FALSE;
+        safeToChange = FALSE;
+        drawBuffer ^= 1;
+        backRP.BitMap = buffers[drawBuffer]->sb_BitMap;
+        pendingSync = unshown;
+        ClearDirty(&unshown);
+    }
+}
+
+void GfxMoveSprite(GfxSprite sprite, WORD x, WORD y)
+{
+    /* MoveSprite() keeps the SimpleSprite in step with the hardware */
+    switch (sprite) {
+        case GFX_SPRITE_BALL:
+            MoveSprite(&gameScreen->ViewPort, &ballSprite, x, y);
+            break;
+        case GFX_SPRITE_PLAYER:
+            MoveSprite(&gameScreen->ViewPort, &playerSprite, x, y);
+            break;
+        case GFX_SPRITE_AI:
+            MoveSprite(&gameScreen->ViewPort, &aiSprite, x, y);
+            break;
+        default:
+            break;
+    }
+}
+
+void GfxWaitBeam(void)
+{
+    WaitBOVP(&gameScreen->ViewPort);
+}
+
+void GfxWaitFrame(void)
+{
+    WaitTOF();
+}
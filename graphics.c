@@ -2,78 +2,69 @@
  * graphics.c - Screen setup and drawing
  * Amiga Pong - OS-friendly implementation
  *
- * Uses hardware sprites for ball and paddles - flicker-free!
+ * Draws every screen of the game through the backend in gfx.h: the
+ * ball and paddles are sprites, everything else is the playfield.
  */
 
 #include <exec/types.h>
-#include <exec/memory.h>
-#include <intuition/intuition.h>
-#include <intuition/screens.h>
-#include <graphics/gfx.h>
-#include <graphics/gfxbase.h>
-#include <graphics/view.h>
-#include <graphics/rastport.h>
-#include <graphics/sprite.h>
-
-#include <proto/exec.h>
-#include <proto/intuition.h>
-#include <proto/graphics.h>
 
 #include "graphics.h"
+#include "gfx.h"
+#include "dirty.h"
+#include "profile.h"
+#include "hud.h"
+
+/* What is on screen now (see RenderState) */
+static RenderState render = { FALSE, TRUE, -1, -1, FALSE };
+
+/* Frame-time overlay on screen: bar lengths and dropped count shown */
+#define HUD_LEFT     20
+#define HUD_BUDGET_X (HUD_LEFT + 100)   /* 20 ms at 200 us a pixel */
+#define HUD_TEXT_X   168
+
+static BOOL hudDrawn = FALSE;
+static UWORD hudBars[PERF_HUD_BARS];
+static ULONG hudDropped;
+static const UBYTE hudColors[PERF_HUD_BARS] = {
+    COLOR_GREEN, COLOR_YELLOW, COLOR_CYAN, COLOR_DARK_GRAY
+};
+
+/* Pause text and the play screen it covers, saved while it is up */
+#define PAUSE_LEFT   96
+#define PAUSE_TOP    120
+#define PAUSE_RIGHT  223
+#define PAUSE_BOTTOM 163
+
+static BOOL pauseShown = FALSE;
 
-/* External library bases */
-extern struct IntuitionBase *IntuitionBase;
-extern struct GfxBase *GfxBase;
-
-/* Screen and window */
-static struct Screen *gameScreen = NULL;
-static struct Window *gameWindow = NULL;
-static struct RastPort *screenRP = NULL;
-
-/* Hardware sprites */
-static struct SimpleSprite ballSprite;
-static struct SimpleSprite playerSprite;
-static struct SimpleSprite aiSprite;
-static WORD ballSpriteNum = -1;
-static WORD playerSpriteNum = -1;
-static WORD aiSpriteNum = -1;
-
-/* Sprite image data (must be in CHIP memory) */
-static UWORD *ballSpriteData = NULL;
-static UWORD *playerSpriteData = NULL;
-static UWORD *aiSpriteData = NULL;
-
-/* Blank pointer for hiding mouse */
-static UWORD *blankPointer = NULL;
-
-/* State tracking */
-static BOOL staticScreenDrawn = FALSE;
-
-/* Direct sprite position update - faster than MoveSprite() */
-static void SetSpritePosition(UWORD *spriteData, WORD x, WORD y, WORD height)
-{
-    /* Convert to hardware coordinates */
-    /* X needs +128 offset, Y needs screen offset (varies by PAL/NTSC) */
-    WORD hstart = x + 128;
-    WORD vstart = y + 44;  /* PAL vertical offset */
-    WORD vstop = vstart + height;
-
-    /* Encode into sprite control words */
-    /* Word 0: VSTART[7:0] | HSTART[8:1] */
-    /* Word 1: VSTOP[7:0] | ATT | VSTART[8] | VSTOP[8] | HSTART[0] | 0000 */
-    spriteData[0] = ((vstart & 0xFF) << 8) | ((hstart >> 1) & 0xFF);
-    spriteData[1] = ((vstop & 0xFF) << 8) |
-                    ((vstart >> 8) & 1) << 2 |
-                    ((vstop >> 8) & 1) << 1 |
-                    (hstart & 1);
-}
-
-/* Sprite data sizes */
-#define BALL_SPRITE_HEIGHT 8
-#define PADDLE_SPRITE_HEIGHT 36  /* 32 + some margin */
+/*
+ * What is on the playfield, so a screen drawn again only repaints what
+ * changed. Text is kept as items: ClearDisplay() only marks them
+ * stale, DrawText() of the same text in the same place draws nothing
+ * (or just the characters that differ), and FlushDisplay() erases the
+ * stale ones nothing replaced. Everything else is kept as bounds and
+ * cleared by ClearDisplay(). No screen draws text over anything else.
+ */
+#define TEXT_ITEMS 32
+#define ITEM_CHARS (SCREEN_WIDTH / 8)
+
+typedef struct {
+    WORD x, y;           /* Baseline, as DrawText() */
+    WORD length;
+    UBYTE color;
+    BOOL live;           /* Drawn since the last ClearDisplay() */
+    char text[ITEM_CHARS];
+} TextItem;
+
+static TextItem items[TEXT_ITEMS];
+static WORD itemCount = 0;
+static DirtyList drawn;          /* On screen and not an item */
+static DirtyList erase;          /* To clear at the flush */
+static DirtyList frame;          /* Written this frame */
+static ULONG framePixels = 0;
 
 /* Screen colors (RGB4 format) */
-static UWORD palette[8] = {
+static const UWORD palette[8] = {
     0x000,  /* 0: Black - background */
     0xFFF,  /* 1: White - ball, player paddle */
     0x0CF,  /* 2: Cyan - AI paddle */
@@ -98,296 +89,210 @@ static const UBYTE digitPatterns[10][7] = {
     { 0x1F, 0x11, 0x11, 0x1F, 0x01, 0x01, 0x1F }
 };
 
-/* Create ball sprite data (8x8 white square) */
-static UWORD *CreateBallSprite(void)
-{
-    UWORD *data;
-    int i;
-
-    /* Sprite format: 2 control words + height * 2 words + 2 terminator words */
-    data = (UWORD *)AllocMem((2 + BALL_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD), MEMF_CHIP | MEMF_CLEAR);
-    if (!data) return NULL;
-
-    /* Control words (will be set by system) */
-    data[0] = 0;
-    data[1] = 0;
-
-    /* Image data - 8x8 solid block */
-    /* Each line: plane0 word, plane1 word */
-    /* For white (color 3 in sprite), both planes = 1 */
-    for (i = 0; i < BALL_SPRITE_HEIGHT; i++) {
-        data[2 + i * 2] = 0xFF00;     /* Plane 0: 8 pixels set */
-        data[2 + i * 2 + 1] = 0xFF00; /* Plane 1: 8 pixels set */
-    }
-
-    /* Terminator */
-    data[2 + BALL_SPRITE_HEIGHT * 2] = 0;
-    data[2 + BALL_SPRITE_HEIGHT * 2 + 1] = 0;
+/*
+ * Score digits as glyphs, made from digitPatterns at init: each cell
+ * is 2x2 pixels with a 1 pixel gap. One more glyph is left blank for
+ * an empty tens place, so a score is always two blits and no clears.
+ */
+#define DIGIT_BLANK  10
+#define DIGIT_GLYPHS 11
+#define DIGIT_HEIGHT 21
+#define DIGIT_STEP   18    /* Tens to units */
+#define SCORE_Y      16
+#define PLAYER_SCORE_X (SCREEN_WIDTH / 4 - 10)
+#define AI_SCORE_X     (3 * SCREEN_WIDTH / 4 - 10)
 
-    return data;
-}
+static UWORD digitGlyphs[DIGIT_GLYPHS][DIGIT_HEIGHT];
 
-/* Create paddle sprite data (8x32 solid block) */
-static UWORD *CreatePaddleSprite(BOOL isPlayer)
+static BOOL MakeDigitGlyphs(void)
 {
-    UWORD *data;
-    int i;
-    UWORD plane0, plane1;
-
-    data = (UWORD *)AllocMem((2 + PADDLE_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD), MEMF_CHIP | MEMF_CLEAR);
-    if (!data) return NULL;
-
-    data[0] = 0;
-    data[1] = 0;
-
-    /* Player = white (color 3), AI = color 1 (will set sprite colors) */
-    if (isPlayer) {
-        plane0 = 0xFF00;
-        plane1 = 0xFF00;
-    } else {
-        /* For AI, use color 1 in sprite palette */
-        plane0 = 0xFF00;
-        plane1 = 0x0000;
-    }
-
-    for (i = 0; i < PADDLE_SPRITE_HEIGHT; i++) {
-        if (i >= 2 && i < PADDLE_SPRITE_HEIGHT - 2) {
-            data[2 + i * 2] = plane0;
-            data[2 + i * 2 + 1] = plane1;
-        } else {
-            data[2 + i * 2] = 0;
-            data[2 + i * 2 + 1] = 0;
+    WORD digit, row, col;
+    UWORD bits;
+
+    for (digit = 0; digit < DIGIT_GLYPHS; digit++) {
+        for (row = 0; row < 7; row++) {
+            bits = 0;
+            if (digit != DIGIT_BLANK) {
+                for (col = 0; col < 5; col++) {
+                    if (digitPatterns[digit][row] & (0x10 >> col)) {
+                        bits |= (UWORD)(0xC000 >> (col * 3));
+                    }
+                }
+            }
+            digitGlyphs[digit][row * 3] = bits;
+            digitGlyphs[digit][row * 3 + 1] = bits;
+            digitGlyphs[digit][row * 3 + 2] = 0;
         }
     }
+    return GfxLoadGlyphs(&digitGlyphs[0][0], DIGIT_GLYPHS, DIGIT_HEIGHT);
+}
 
-    data[2 + PADDLE_SPRITE_HEIGHT * 2] = 0;
-    data[2 + PADDLE_SPRITE_HEIGHT * 2 + 1] = 0;
-
-    return data;
+/* Add a rectangle, clipped to the screen */
+static void Mark(DirtyList *d, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= SCREEN_WIDTH) x1 = SCREEN_WIDTH - 1;
+    if (y1 >= SCREEN_HEIGHT) y1 = SCREEN_HEIGHT - 1;
+    AddDirty(d, x0, y0, x1, y1);
 }
 
-static void FreeSprites(void)
+/* Backend drawing, with what it writes counted against the frame */
+static void Fill(WORD x0, WORD y0, WORD x1, WORD y1, UBYTE color)
 {
-    if (ballSpriteNum >= 0) {
-        FreeSprite(ballSpriteNum);
-        ballSpriteNum = -1;
-    }
-    if (playerSpriteNum >= 0) {
-        FreeSprite(playerSpriteNum);
-        playerSpriteNum = -1;
-    }
-    if (aiSpriteNum >= 0) {
-        FreeSprite(aiSpriteNum);
-        aiSpriteNum = -1;
-    }
-    if (ballSpriteData) {
-        FreeMem(ballSpriteData, (2 + BALL_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD));
-        ballSpriteData = NULL;
-    }
-    if (playerSpriteData) {
-        FreeMem(playerSpriteData, (2 + PADDLE_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD));
-        playerSpriteData = NULL;
-    }
-    if (aiSpriteData) {
-        FreeMem(aiSpriteData, (2 + PADDLE_SPRITE_HEIGHT * 2 + 2) * sizeof(UWORD));
-        aiSpriteData = NULL;
-    }
+    GfxRectFill(x0, y0, x1, y1, color);
+    Mark(&frame, x0, y0, x1, y1);
 }
 
-static BOOL InitSprites(void)
+static void PutText(WORD x, WORD y, const char *text, WORD length, UBYTE color)
 {
-    /* Create sprite image data */
-    ballSpriteData = CreateBallSprite();
-    playerSpriteData = CreatePaddleSprite(TRUE);
-    aiSpriteData = CreatePaddleSprite(FALSE);
+    GfxText(x, y, text, length, color);
+    Mark(&frame, x, y - 6, x + length * 8 - 1, y + 1);
+}
 
-    if (!ballSpriteData || !playerSpriteData || !aiSpriteData) {
-        FreeSprites();
-        return FALSE;
-    }
+static void PutGlyph(WORD glyph, WORD x, WORD y, UBYTE color)
+{
+    GfxGlyph(glyph, x, y, color);
+    Mark(&frame, x, y, x + GFX_GLYPH_WIDTH - 1, y + DIGIT_HEIGHT - 1);
+    Mark(&drawn, x, y, x + GFX_GLYPH_WIDTH - 1, y + DIGIT_HEIGHT - 1);
+}
 
-    /* Get sprites from system */
-    ballSpriteNum = GetSprite(&ballSprite, 2);
-    if (ballSpriteNum < 0) {
-        /* Try another sprite number */
-        ballSpriteNum = GetSprite(&ballSprite, -1);
-    }
+static void ItemBounds(const TextItem *item, DirtyRect *r)
+{
+    r->x0 = item->x;
+    r->y0 = item->y - 6;
+    r->x1 = item->x + item->length * 8 - 1;
+    r->y1 = item->y + 1;
+}
 
-    playerSpriteNum = GetSprite(&playerSprite, 4);
-    if (playerSpriteNum < 0) {
-        playerSpriteNum = GetSprite(&playerSprite, -1);
-    }
+/* Forget the items inside a rectangle that has been drawn over */
+static void DropItems(WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    DirtyRect r;
+    WORD i = 0;
 
-    aiSpriteNum = GetSprite(&aiSprite, 6);
-    if (aiSpriteNum < 0) {
-        aiSpriteNum = GetSprite(&aiSprite, -1);
+    while (i < itemCount) {
+        ItemBounds(&items[i], &r);
+        if (r.x0 >= x0 && r.y0 >= y0 && r.x1 <= x1 && r.y1 <= y1) {
+            items[i] = items[--itemCount];
+        } else {
+            i++;
+        }
     }
+}
 
-    if (ballSpriteNum < 0 || playerSpriteNum < 0 || aiSpriteNum < 0) {
-        FreeSprites();
+BOOL InitGraphics(void)
+{
+    if (!GfxOpen(palette, 8)) return FALSE;
+    if (!MakeDigitGlyphs()) {
+        GfxClose();
         return FALSE;
     }
 
-    /* Set up sprite structures */
-    ballSprite.posctldata = ballSpriteData;
-    ballSprite.height = BALL_SPRITE_HEIGHT;
-    ballSprite.x = 0;
-    ballSprite.y = 0;
-
-    playerSprite.posctldata = playerSpriteData;
-    playerSprite.height = PADDLE_SPRITE_HEIGHT;
-    playerSprite.x = 0;
-    playerSprite.y = 0;
-
-    aiSprite.posctldata = aiSpriteData;
-    aiSprite.height = PADDLE_SPRITE_HEIGHT;
-    aiSprite.x = 0;
-    aiSprite.y = 0;
-
-    /* Set sprite colors */
-    /* Sprites 2-3 use colors 21-23, sprites 4-5 use 25-27, sprites 6-7 use 29-31 */
-    /* But for SimpleSprite, colors are set in the ViewPort */
+    /* The empty court is drawn once and kept for full redraws */
+    GfxClear(COLOR_BACKGROUND);
+    ClearDirty(&drawn);
+    ClearDirty(&erase);
+    ClearDirty(&frame);
+    itemCount = 0;
+    DrawCenterLine();
+    GfxSave(GFX_COPY_COURT, 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1);
 
+    render.staticScreenDrawn = FALSE;
     return TRUE;
 }
 
-BOOL InitGraphics(void)
+void CleanupGraphics(void)
 {
-    struct NewScreen ns;
-    struct NewWindow nw;
-    int i;
-
-    blankPointer = (UWORD *)AllocMem(12, MEMF_CHIP | MEMF_CLEAR);
-    if (!blankPointer) return FALSE;
-
-    /* Open screen */
-    ns.LeftEdge = 0;
-    ns.TopEdge = 0;
-    ns.Width = SCREEN_WIDTH;
-    ns.Height = SCREEN_HEIGHT;
-    ns.Depth = SCREEN_DEPTH;
-    ns.DetailPen = COLOR_WHITE;
-    ns.BlockPen = COLOR_BACKGROUND;
-    ns.ViewModes = 0;
-    ns.Type = CUSTOMSCREEN | SCREENQUIET;
-    ns.Font = NULL;
-    ns.DefaultTitle = NULL;
-    ns.Gadgets = NULL;
-    ns.CustomBitMap = NULL;
-
-    gameScreen = OpenScreen(&ns);
-    if (!gameScreen) {
-        CleanupGraphics();
-        return FALSE;
-    }
+    GfxClose();
+}
 
-    screenRP = &gameScreen->RastPort;
+/* Show the frame; the backend waits for the last swap to be shown first */
+void SwapBuffers(void)
+{
+    PROFILE_BEGIN(PROFILE_WAIT_TOF);
+    HUD_MARK(HUD_WAIT);
+    GfxSwap(&frame);
+    HUD_MARK(HUD_RENDER);
+    PROFILE_END(PROFILE_WAIT_TOF);
+}
 
-    /* Set playfield palette */
-    for (i = 0; i < 8; i++) {
-        SetRGB4(&gameScreen->ViewPort, i,
-                (palette[i] >> 8) & 0xF,
-                (palette[i] >> 4) & 0xF,
-                palette[i] & 0xF);
-    }
+void ClearDisplay(void)
+{
+    WORD i;
 
-    /* Set sprite colors */
-    /* Sprite 2-3 colors are at index 21-23 */
-    SetRGB4(&gameScreen->ViewPort, 21, 0xF, 0xF, 0xF);  /* White */
-    SetRGB4(&gameScreen->ViewPort, 22, 0xF, 0xF, 0xF);  /* White */
-    SetRGB4(&gameScreen->ViewPort, 23, 0xF, 0xF, 0xF);  /* White */
-
-    /* Sprite 4-5 colors at 25-27 */
-    SetRGB4(&gameScreen->ViewPort, 25, 0xF, 0xF, 0xF);  /* White */
-    SetRGB4(&gameScreen->ViewPort, 26, 0xF, 0xF, 0xF);  /* White */
-    SetRGB4(&gameScreen->ViewPort, 27, 0xF, 0xF, 0xF);  /* White */
-
-    /* Sprite 6-7 colors at 29-31 */
-    SetRGB4(&gameScreen->ViewPort, 29, 0x0, 0xC, 0xF);  /* Cyan */
-    SetRGB4(&gameScreen->ViewPort, 30, 0x0, 0xC, 0xF);  /* Cyan */
-    SetRGB4(&gameScreen->ViewPort, 31, 0x0, 0xC, 0xF);  /* Cyan */
-
-    /* Initialize sprites */
-    if (!InitSprites()) {
-        CleanupGraphics();
-        return FALSE;
+    /* Text drawn again stays; the rest of it goes at the flush */
+    for (i = 0; i < drawn.count; i++) {
+        const DirtyRect *r = &drawn.rects[i];
+        Fill(r->x0, r->y0, r->x1, r->y1, COLOR_BACKGROUND);
     }
-
-    /* Clear screen */
-    SetRast(screenRP, COLOR_BACKGROUND);
-
-    /* Open window */
-    nw.LeftEdge = 0;
-    nw.TopEdge = 0;
-    nw.Width = SCREEN_WIDTH;
-    nw.Height = SCREEN_HEIGHT;
-    nw.DetailPen = COLOR_WHITE;
-    nw.BlockPen = COLOR_BACKGROUND;
-    nw.IDCMPFlags = IDCMP_MOUSEMOVE | IDCMP_MOUSEBUTTONS |
-                    IDCMP_RAWKEY | IDCMP_VANILLAKEY | IDCMP_CLOSEWINDOW;
-    nw.Flags = WFLG_BACKDROP | WFLG_BORDERLESS | WFLG_ACTIVATE |
-               WFLG_RMBTRAP | WFLG_REPORTMOUSE;
-    nw.FirstGadget = NULL;
-    nw.CheckMark = NULL;
-    nw.Title = NULL;
-    nw.Screen = gameScreen;
-    nw.BitMap = NULL;
-    nw.MinWidth = 0;
-    nw.MinHeight = 0;
-    nw.MaxWidth = 0;
-    nw.MaxHeight = 0;
-    nw.Type = CUSTOMSCREEN;
-
-    gameWindow = OpenWindow(&nw);
-    if (!gameWindow) {
-        CleanupGraphics();
-        return FALSE;
+    ClearDirty(&drawn);
+    for (i = 0; i < itemCount; i++) {
+        items[i].live = FALSE;
     }
+    pauseShown = FALSE;
+}
 
-    SetPointer(gameWindow, blankPointer, 1, 1, 0, 0);
-    staticScreenDrawn = FALSE;
-
-    return TRUE;
+void DrawCourt(void)
+{
+    GfxRestore(GFX_COPY_COURT, 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1);
+    Mark(&frame, 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1);
+
+    ClearDirty(&drawn);
+    AddDirty(&drawn, SCREEN_WIDTH / 2 - 1, 0, SCREEN_WIDTH / 2 + 1, SCREEN_HEIGHT - 1);
+    ClearDirty(&erase);
+    itemCount = 0;
+    hudDrawn = FALSE;
+    pauseShown = FALSE;
 }
 
-void CleanupGraphics(void)
+void FlushDisplay(void)
 {
-    FreeSprites();
+    DirtyRect r;
+    WORD i = 0;
 
-    if (gameWindow) {
-        ClearPointer(gameWindow);
-        CloseWindow(gameWindow);
-        gameWindow = NULL;
-    }
-    if (gameScreen) {
-        CloseScreen(gameScreen);
-        gameScreen = NULL;
+    while (i < itemCount) {
+        if (items[i].live) {
+            i++;
+            continue;
+        }
+        ItemBounds(&items[i], &r);
+        AddDirty(&erase, r.x0, r.y0, r.x1, r.y1);
+        items[i] = items[--itemCount];
     }
-    if (blankPointer) {
-        FreeMem(blankPointer, 12);
-        blankPointer = NULL;
+
+    if (erase.count > 0) {
+        for (i = 0; i < erase.count; i++) {
+            Fill(erase.rects[i].x0, erase.rects[i].y0,
+                 erase.rects[i].x1, erase.rects[i].y1, COLOR_BACKGROUND);
+        }
+        /* Text that was under what went is drawn whole again */
+        for (i = 0; i < itemCount; i++) {
+            ItemBounds(&items[i], &r);
+            if (IsDirty(&erase, r.x0, r.y0, r.x1, r.y1)) {
+                PutText(items[i].x, items[i].y, items[i].text, items[i].length, items[i].color);
+            }
+        }
+        ClearDirty(&erase);
     }
-    screenRP = NULL;
-}
 
-void SwapBuffers(void)
-{
-    WaitTOF();
+    framePixels = DirtyPixels(&frame);
+    SwapBuffers();
+    ClearDirty(&frame);
 }
 
-void ClearDisplay(void)
+ULONG GetFramePixels(void)
 {
-    SetRast(screenRP, COLOR_BACKGROUND);
+    return framePixels;
 }
 
 void ClearBackBuffer(void)
 {
     ClearDisplay();
-    staticScreenDrawn = FALSE;
+    render.staticScreenDrawn = FALSE;
 }
 
-struct RastPort *GetBackRastPort(void) { return screenRP; }
-struct Window *GetGameWindow(void) { return gameWindow; }
+struct Window *GetGameWindow(void) { return GfxWindow(); }
 
 void DrawPaddle(WORD x, WORD y, UBYTE color)
 {
@@ -396,8 +301,8 @@ void DrawPaddle(WORD x, WORD y, UBYTE color)
     WORD bottom = y + PADDLE_HEIGHT / 2;
     if (top < 0) top = 0;
     if (bottom >= SCREEN_HEIGHT) bottom = SCREEN_HEIGHT - 1;
-    SetAPen(screenRP, color);
-    RectFill(screenRP, x, top, x + PADDLE_WIDTH - 1, bottom);
+    Fill(x, top, x + PADDLE_WIDTH - 1, bottom, color);
+    Mark(&drawn, x, top, x + PADDLE_WIDTH - 1, bottom);
 }
 
 void DrawBall(WORD x, WORD y)
@@ -414,69 +319,98 @@ void DrawBall(WORD x, WORD y)
     if (right >= SCREEN_WIDTH) right = SCREEN_WIDTH - 1;
     if (bottom >= SCREEN_HEIGHT) bottom = SCREEN_HEIGHT - 1;
 
-    SetAPen(screenRP, COLOR_WHITE);
-    RectFill(screenRP, left, top, right, bottom);
+    Fill(left, top, right, bottom, COLOR_WHITE);
+    Mark(&drawn, left, top, right, bottom);
 }
 
 void DrawCenterLine(void)
 {
     WORD y, x = SCREEN_WIDTH / 2;
-    SetAPen(screenRP, COLOR_WHITE);
     for (y = 0; y < SCREEN_HEIGHT; y += 8) {
-        RectFill(screenRP, x - 1, y, x + 1, y + 3);
+        GfxRectFill(x - 1, y, x + 1, y + 3, COLOR_WHITE);
     }
+    /* The dashes count as the whole column, one rectangle not 32 */
+    Mark(&frame, x - 1, 0, x + 1, SCREEN_HEIGHT - 1);
+    Mark(&drawn, x - 1, 0, x + 1, SCREEN_HEIGHT - 1);
 }
 
-static void DrawDigit(WORD x, WORD y, WORD digit, UBYTE color)
+/* One score at its units position; the glyphs cover the old digits */
+static void DrawScoreAt(WORD x, WORD score)
 {
-    WORD row, col;
-    UBYTE pattern;
-    if (digit < 0 || digit > 9) return;
-
-    SetAPen(screenRP, color);
-    for (row = 0; row < 7; row++) {
-        pattern = digitPatterns[digit][row];
-        for (col = 0; col < 5; col++) {
-            if (pattern & (0x10 >> col)) {
-                RectFill(screenRP, x + col * 3, y + row * 3, x + col * 3 + 1, y + row * 3 + 1);
-            }
-        }
-    }
+    PutGlyph(score >= 10 ? (score / 10) % 10 : DIGIT_BLANK, x - DIGIT_STEP, SCORE_Y, COLOR_YELLOW);
+    PutGlyph(score % 10, x, SCORE_Y, COLOR_YELLOW);
 }
 
 void DrawScore(WORD playerScore, WORD aiScore)
 {
-    WORD px = SCREEN_WIDTH / 4 - 10;
-    WORD ax = 3 * SCREEN_WIDTH / 4 - 10;
-    WORD y = 16;
+    DrawScoreAt(PLAYER_SCORE_X, playerScore);
+    DrawScoreAt(AI_SCORE_X, aiScore);
+}
 
-    /* Clear score areas first */
-    SetAPen(screenRP, COLOR_BACKGROUND);
-    RectFill(screenRP, 40, 14, 120, 40);
-    RectFill(screenRP, 200, 14, 280, 40);
+static TextItem *FindItem(WORD x, WORD y)
+{
+    WORD i;
 
-    if (playerScore >= 10) DrawDigit(px - 18, y, playerScore / 10, COLOR_YELLOW);
-    DrawDigit(px, y, playerScore % 10, COLOR_YELLOW);
-    if (aiScore >= 10) DrawDigit(ax - 18, y, aiScore / 10, COLOR_YELLOW);
-    DrawDigit(ax, y, aiScore % 10, COLOR_YELLOW);
+    for (i = 0; i < itemCount; i++) {
+        if (items[i].x == x && items[i].y == y) return &items[i];
+    }
+    return NULL;
 }
 
 void DrawText(WORD x, WORD y, const char *text, UBYTE color)
 {
-    WORD len = 0;
-    const char *p = text;
-    while (*p++) len++;
-    SetAPen(screenRP, color);
-    Move(screenRP, x, y);
-    Text(screenRP, text, len);
+    TextItem *item = FindItem(x, y);
+    WORD len = 0, i, start;
+
+    while (text[len]) len++;
+    if (len > ITEM_CHARS) len = ITEM_CHARS;
+
+    if (item && item->length == len && item->color == color) {
+        /* Already there: only the runs of characters that differ */
+        for (i = 0; i < len; ) {
+            if (item->text[i] == text[i]) {
+                i++;
+                continue;
+            }
+            start = i;
+            while (i < len && item->text[i] != text[i]) {
+                item->text[i] = text[i];
+                i++;
+            }
+            PutText((WORD)(x + start * 8), y, text + start, (WORD)(i - start), color);
+        }
+        item->live = TRUE;
+        return;
+    }
+
+    if (item) {
+        /* Replaced: any of the old text past the new goes at the flush */
+        if (item->length > len) {
+            AddDirty(&erase, x + len * 8, y - 6, x + item->length * 8 - 1, y + 1);
+        }
+    } else if (itemCount < TEXT_ITEMS) {
+        item = &items[itemCount++];
+    } else {
+        PutText(x, y, text, len, color);
+        Mark(&drawn, x, y - 6, x + len * 8 - 1, y + 1);
+        return;
+    }
+
+    item->x = x;
+    item->y = y;
+    item->length = len;
+    item->color = color;
+    item->live = TRUE;
+    for (i = 0; i < len; i++) item->text[i] = text[i];
+    PutText(x, y, text, len, color);
 }
 
 void DrawTitleScreen(void)
 {
     /* Hide sprites on title screen */
-    MoveSprite(&gameScreen->ViewPort, &ballSprite, -100, 0);
-    MoveSprite(&gameScreen->ViewPort, &playerSprite, -100, 0);
-    MoveSprite(&gameScreen->ViewPort, &aiSprite, -100, 0);
+    GfxMoveSprite(GFX_SPRITE_BALL, -100, 0);
+    GfxMoveSprite(GFX_SPRITE_PLAYER, -100, 0);
+    GfxMoveSprite(GFX_SPRITE_AI, -100, 0);
 
     /* Centered text: x = (320 - strlen*8) / 2 */
     DrawText(144, 80, "PONG", COLOR_WHITE);           /* 4 chars */
@@ -491,12 +425,31 @@ void DrawPausedText(void)
     DrawText(100, 160, "Click to Resume", COLOR_WHITE); /* 15 chars */
 }
 
+void ShowPauseOverlay(void)
+{
+    if (pauseShown) return;
+
+    GfxSave(GFX_COPY_UNDER, PAUSE_LEFT, PAUSE_TOP, PAUSE_RIGHT, PAUSE_BOTTOM);
+    DrawPausedText();
+    pauseShown = TRUE;
+}
+
+void HidePauseOverlay(void)
+{
+    if (!pauseShown) return;
+
+    GfxRestore(GFX_COPY_UNDER, PAUSE_LEFT, PAUSE_TOP, PAUSE_RIGHT, PAUSE_BOTTOM);
+    Mark(&frame, PAUSE_LEFT, PAUSE_TOP, PAUSE_RIGHT, PAUSE_BOTTOM);
+    DropItems(PAUSE_LEFT, PAUSE_TOP, PAUSE_RIGHT, PAUSE_BOTTOM);
+    pauseShown = FALSE;
+}
+
 void DrawGameOver(BOOL playerWon)
 {
     /* Hide sprites */
-    MoveSprite(&gameScreen->ViewPort, &ballSprite, -100, 0);
-    MoveSprite(&gameScreen->ViewPort, &playerSprite, -100, 0);
-    MoveSprite(&gameScreen->ViewPort, &aiSprite, -100, 0);
+    GfxMoveSprite(GFX_SPRITE_BALL, -100, 0);
+    GfxMoveSprite(GFX_SPRITE_PLAYER, -100, 0);
+    GfxMoveSprite(GFX_SPRITE_AI, -100, 0);
 
     /* Centered text: x = (320 - strlen*8) / 2 */
     DrawText(124, 100, "GAME OVER", COLOR_YELLOW);    /* 9 chars */
@@ -506,62 +459,159 @@ void DrawGameOver(BOOL playerWon)
 
 BOOL DrawStaticScreen(void)
 {
-    if (!staticScreenDrawn) {
-        staticScreenDrawn = TRUE;
+    if (!render.staticScreenDrawn) {
+        render.staticScreenDrawn = TRUE;
         return TRUE;
     }
-    WaitTOF();
+    PROFILE_BEGIN(PROFILE_WAIT_TOF);
+    HUD_MARK(HUD_WAIT);
+    GfxWaitFrame();
+    HUD_MARK(HUD_RENDER);
+    PROFILE_END(PROFILE_WAIT_TOF);
     return FALSE;
 }
 
 void ResetStaticScreen(void)
 {
-    staticScreenDrawn = FALSE;
+    render.staticScreenDrawn = FALSE;
 }
 
 /* Update game graphics using hardware sprites */
 void UpdateGameGraphics(WORD ballX, WORD ballY, WORD playerY, WORD aiY,
                         WORD playerScore, WORD aiScore)
 {
-    static WORD lastPlayerScore = -1;
-    static WORD lastAIScore = -1;
-    static BOOL firstFrame = TRUE;
-
     /* First frame: draw static elements */
-    if (firstFrame) {
-        SetRast(screenRP, COLOR_BACKGROUND);
-        DrawCenterLine();
+    if (render.firstFrame) {
+        DrawCourt();
         DrawScore(playerScore, aiScore);
-        lastPlayerScore = playerScore;
-        lastAIScore = aiScore;
-        firstFrame = FALSE;
+        render.lastPlayerScore = playerScore;
+        render.lastAIScore = aiScore;
+        render.firstFrame = FALSE;
+        render.scoreStale = FALSE;
     }
 
-    /* Update score if changed */
-    if (playerScore != lastPlayerScore || aiScore != lastAIScore) {
+    /* Both scores again, as the first frame draws them */
+    if (render.scoreStale) {
         DrawScore(playerScore, aiScore);
-        lastPlayerScore = playerScore;
-        lastAIScore = aiScore;
+        render.lastPlayerScore = playerScore;
+        render.lastAIScore = aiScore;
+        render.scoreStale = FALSE;
     }
 
-    /* Wait for bottom of viewport before moving sprites */
-    WaitBOVP(&gameScreen->ViewPort);
+    /* Update a score if it changed: two glyph blits */
+    if (playerScore != render.lastPlayerScore) {
+        DrawScoreAt(PLAYER_SCORE_X, playerScore);
+        render.lastPlayerScore = playerScore;
+    }
+    if (aiScore != render.lastAIScore) {
+        DrawScoreAt(AI_SCORE_X, aiScore);
+        render.lastAIScore = aiScore;
+    }
 
-    /* Update sprite positions - use MoveSprite to keep SimpleSprite in sync */
-    MoveSprite(&gameScreen->ViewPort, &ballSprite,
-               ballX - BALL_SIZE/2, ballY - BALL_SIZE/2);
-    MoveSprite(&gameScreen->ViewPort, &playerSprite,
-               PADDLE_OFFSET, playerY - PADDLE_HEIGHT/2);
-    MoveSprite(&gameScreen->ViewPort, &aiSprite,
-               SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH, aiY - PADDLE_HEIGHT/2);
+    /* Wait for bottom of viewport before moving sprites */
+    PROFILE_BEGIN(PROFILE_WAIT_BOVP);
+    HUD_MARK(HUD_WAIT);
+    GfxWaitBeam();
+    HUD_MARK(HUD_RENDER);
+    PROFILE_END(PROFILE_WAIT_BOVP);
+
+    /* Update sprite positions */
+    GfxMoveSprite(GFX_SPRITE_BALL, ballX - BALL_SIZE/2, ballY - BALL_SIZE/2);
+    GfxMoveSprite(GFX_SPRITE_PLAYER, PADDLE_OFFSET, playerY - PADDLE_HEIGHT/2);
+    GfxMoveSprite(GFX_SPRITE_AI, SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH,
+                  aiY - PADDLE_HEIGHT/2);
 }
 
 void RequestFullRedraw(void)
 {
-    /* Hack to reset first frame flag - just clear and redraw */
-    SetRast(screenRP, COLOR_BACKGROUND);
-    DrawCenterLine();
-    staticScreenDrawn = FALSE;
+    /* The next UpdateGameGraphics() clears and draws everything again */
+    render.firstFrame = TRUE;
+    render.staticScreenDrawn = FALSE;
+}
+
+void RedrawScore(void)
+{
+    /* The next UpdateGameGraphics() draws both through DrawScore() */
+    render.scoreStale = TRUE;
+    render.staticScreenDrawn = FALSE;
+}
+
+/* Dropped count as "DROPPED n", built by hand (no sprintf) */
+static void DrawDroppedCount(ULONG dropped)
+{
+    char text[20] = "DROPPED ";
+    char digits[11];
+    WORD i = 10, n = 8;
+
+    digits[i] = '\0';
+    do {
+        digits[--i] = (char)('0' + dropped % 10);
+        dropped /= 10;
+    } while (dropped > 0);
+    while (digits[i]) text[n++] = digits[i++];
+    text[n] = '\0';
+
+    Fill(HUD_TEXT_X, 1, SCREEN_WIDTH - 1, 11, COLOR_BACKGROUND);
+    PutText(HUD_TEXT_X, 9, text, n, COLOR_GRAY);
+}
+
+void DrawPerfHud(const UWORD *bars, ULONG dropped)
+{
+    WORD i, y;
+    UWORD was, now;
+    BOOL changed = FALSE;
+
+    if (!hudDrawn) {
+        for (i = 0; i < PERF_HUD_BARS; i++) hudBars[i] = 0;
+        Fill(HUD_LEFT, 0, HUD_LEFT + PERF_HUD_WIDTH, 12, COLOR_BACKGROUND);
+        DrawDroppedCount(dropped);
+        hudDropped = dropped;
+        changed = TRUE;
+        hudDrawn = TRUE;
+    }
+
+    /* Each bar only grows or shrinks by the difference */
+    for (i = 0; i < PERF_HUD_BARS; i++) {
+        was = hudBars[i];
+        now = bars[i];
+        if (now == was) continue;
+
+        y = 1 + i * 3;
+        if (now > was) {
+            Fill(HUD_LEFT + was, y, HUD_LEFT + now - 1, y + 1, hudColors[i]);
+        } else {
+            Fill(HUD_LEFT + now, y, HUD_LEFT + was - 1, y + 1, COLOR_BACKGROUND);
+        }
+        hudBars[i] = now;
+        changed = TRUE;
+    }
+
+    /* The budget mark goes back on top of whatever crossed it */
+    if (changed) {
+        Fill(HUD_BUDGET_X, 0, HUD_BUDGET_X, 12, COLOR_RED);
+    }
+
+    if (dropped != hudDropped) {
+        DrawDroppedCount(dropped);
+        hudDropped = dropped;
+    }
+}
+
+void ErasePerfHud(void)
+{
+    Fill(HUD_LEFT, 0, HUD_LEFT + PERF_HUD_WIDTH, 12, COLOR_BACKGROUND);
+    Fill(HUD_TEXT_X, 1, SCREEN_WIDTH - 1, 11, COLOR_BACKGROUND);
+    hudDrawn = FALSE;
+}
+
+void GetRenderState(RenderState *state)
+{
+    *state = render;
+}
+
+void SetRenderState(const RenderState *state)
+{
+    render = *state;
 }
 
 void EraseBallAt(WORD x, WORD y) { (void)x; (void)y; }
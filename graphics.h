@@ -20,6 +20,10 @@
 #define COLOR_WHITE      1
 #define COLOR_CYAN       2
 #define COLOR_YELLOW     3
+#define COLOR_DARK_GRAY  4
+#define COLOR_GRAY       5
+#define COLOR_RED        6
+#define COLOR_GREEN      7
 
 /* Game element dimensions */
 #define PADDLE_WIDTH   8
@@ -27,21 +31,46 @@
 #define BALL_SIZE      6
 #define PADDLE_OFFSET  16  /* Distance from screen edge */
 
+/*
+ * What the drawing code believes is on screen: UpdateGameGraphics()
+ * only redraws what differs from it
+ */
+typedef struct {
+    BOOL staticScreenDrawn;  /* Title/pause/game over screen is up */
+    BOOL firstFrame;         /* Play screen needs a full redraw */
+    WORD lastPlayerScore;    /* Scores on screen */
+    WORD lastAIScore;
+    BOOL scoreStale;         /* Both scores need drawing (after a rewind) */
+} RenderState;
+
 /* Initialize graphics system */
 BOOL InitGraphics(void);
 
 /* Clean up graphics system */
 void CleanupGraphics(void);
 
-/* Swap double buffers */
+/* Show this frame's drawing (double buffered); FlushDisplay() calls it */
 void SwapBuffers(void);
 
 /* Clear the back buffer */
 void ClearBackBuffer(void);
 
-/* Just clear the screen (for static screens) */
+/*
+ * Start a static screen over. Only what is drawn again is kept: text
+ * already on screen in the same place is not drawn twice, and text
+ * not drawn again is erased by FlushDisplay()
+ */
 void ClearDisplay(void);
 
+/* End of a frame's drawing: erase what is no longer wanted, then show it */
+void FlushDisplay(void);
+
+/* Pixels the last frame wrote, its dirty rectangles merged */
+ULONG GetFramePixels(void);
+
+/* Restore the empty court (center line) from its off-screen copy */
+void DrawCourt(void);
+
 /* Drawing functions */
 void DrawPaddle(WORD x, WORD y, UBYTE color);
 void DrawBall(WORD x, WORD y);
@@ -52,12 +81,16 @@ void DrawTitleScreen(void);
 void DrawPausedText(void);
 void DrawGameOver(BOOL playerWon);
 
+/*
+ * Pause text over the play screen. What it covers is saved first and
+ * put back by HidePauseOverlay(), so play resumes without a redraw.
+ */
+void ShowPauseOverlay(void);
+void HidePauseOverlay(void);
+
 /* Get the window for input */
 struct Window *GetGameWindow(void);
 
-/* Get current RastPort for drawing */
-struct RastPort *GetBackRastPort(void);
-
 /* Optimized game rendering - erases and redraws only what changed */
 void UpdateGameGraphics(WORD ballX, WORD ballY, WORD playerY, WORD aiY,
                         WORD playerScore, WORD aiScore);
@@ -65,9 +98,26 @@ void UpdateGameGraphics(WORD ballX, WORD ballY, WORD playerY, WORD aiY,
 /* Request a full screen redraw on next frame */
 void RequestFullRedraw(void);
 
+/* Draw the score again on the next frame (after a rewind) */
+void RedrawScore(void);
+
+/* Copy the render state out (for snapshots) and back in */
+void GetRenderState(RenderState *state);
+void SetRenderState(const RenderState *state);
+
 /* Erase ball at specific position (for when ball goes off screen) */
 void EraseBallAt(WORD x, WORD y);
 
+/*
+ * Frame-time overlay (hud.c) in the strip above the scores: one bar
+ * per phase, up to PERF_HUD_WIDTH pixels, and the dropped frame count.
+ * Only what changed since the last call is drawn again.
+ */
+#define PERF_HUD_BARS  4
+#define PERF_HUD_WIDTH 130
+void DrawPerfHud(const UWORD *bars, ULONG dropped);
+void ErasePerfHud(void);
+
 /* For static screens (title, pause, etc) - returns TRUE if caller should draw */
 BOOL DrawStaticScreen(void);
 void ResetStaticScreen(void);
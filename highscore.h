@@ -26,6 +26,12 @@ typedef struct {
     UBYTE reserved[3]; /* Padding for future use */
 } HighScoreTable;
 
+/* Name being typed in for a new high score */
+typedef struct {
+    char name[NAME_LENGTH + 1];
+    WORD pos;         /* Characters typed so far */
+} NameEntry;
+
 /* Magic number for file validation */
 #define HIGHSCORE_MAGIC 0x504F4E47  /* 'PONG' */
 
@@ -0,0 +1,877 @@
+/*
+ * bench.c - Headless tick-throughput benchmark for the game core
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Drives UpdateGame() with scripted mouse input, restarting the
+ * match whenever it ends, and reports ticks/second, ns/tick and
+ * the p50/p99 cost of a tick.
+ *
+ * Usage: bench [ticks]               scalar UpdateGame()
+ *        bench -batch lanes [ticks]  UpdateBatch(), ticks per lane
+ *        bench -verify [ticks]       check UpdateBatch() against UpdateGame()
+ *        bench -predict              AI intercept predictors: speed and accuracy
+ *        bench -snapshot             SaveSnapshot()/RestoreSnapshot() cost and
+ *                                    resuming from a restored snapshot
+ *        bench -rewind               rewind history: bytes per minute, cost,
+ *                                    and stepping back through a full ring
+ *        bench -profile              profiler overhead, and a sample report
+ *                                    written to pong.profile
+ *
+ * -kernel scalar|sse2|avx2 picks the batch ball stage kernel
+ * (default: the widest one the CPU supports). -verify checks every
+ * kernel the CPU supports, first lane by lane on random ball states
+ * against the scalar kernel, then whole matches against UpdateGame().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <exec/types.h>
+#include "game.h"
+#include "graphics.h"
+#include "batch.h"
+#include "snapshot.h"
+#include "rewind.h"
+#include "profile.h"
+
+/* Ticks timed together per sample - one tick is too short to time alone */
+#define SAMPLE_TICKS 64
+
+#define DEFAULT_TICKS 2000000L
+#define DEFAULT_BATCH_TICKS 20000L
+#define VERIFY_LANES 96
+#define FUZZ_LANES 4099   /* Not a multiple of 8, to cover the tail */
+#define FUZZ_ROUNDS 256
+#define PREDICT_SHOTS 65536
+#define PREDICT_ROUNDS 200
+#define SNAPSHOT_ROUNDS 4000000L
+#define SNAPSHOT_POINTS 64   /* Snapshots taken along one match */
+#define REWIND_MATCHES 50
+#define REWIND_TICKS 400000L  /* Played into one ring, to wrap it many times */
+#define STEPS_PER_MINUTE (50L * 60)
+#define PROFILE_FRAMES 200000L
+#define PROFILE_STALL_EVERY 40000L   /* Frames between stalls in the sample report */
+#define PROFILE_STALL_US 25000L
+
+/* Scripted aim offsets: the player follows the ball but misses now and then */
+static const WORD aimPattern[16] = {
+    0, 4, -6, 10, -2, 14, -12, 6, 0, -8, 18, -4, 2, -16, 8, 24
+};
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static int CompareLong(const void *a, const void *b)
+{
+    LONG x = *(const LONG *)a, y = *(const LONG *)b;
+    return (x > y) - (x < y);
+}
+
+static RandomState masterRandom;
+
+/* RNG stream for the n-th match a lane plays */
+static RandomState *MatchStream(LONG lane, LONG match)
+{
+    static RandomState stream;
+    SplitRandom(&stream, &masterRandom, (ULONG)(lane * 1024 + match));
+    return &stream;
+}
+
+static void StartBenchMatch(GameContext *ctx, Difficulty diff, const RandomState *rng)
+{
+    ctx->rng = *rng;
+    ctx->difficulty = diff;
+    StartMatch(ctx);
+}
+
+/* Scripted mouse position for the next tick */
+static WORD ScriptedMouseY(LONG ballY, LONG tick)
+{
+    WORD aim = aimPattern[(tick >> 7) & 15];
+    return (WORD)(FP_TO_INT(ballY) + aim);
+}
+
+static void PrintTiming(LONG ticks, double total, double *cost, LONG samples)
+{
+    qsort(cost, (size_t)samples, sizeof(double), CompareDouble);
+
+    printf("ticks/sec:   %.0f\n", ticks / (total / 1e9));
+    printf("ns/tick:     %.2f\n", total / ticks);
+    printf("p50 ns/tick: %.2f\n", cost[samples / 2]);
+    printf("p99 ns/tick: %.2f\n", cost[(samples * 99) / 100]);
+}
+
+static int BenchScalar(LONG ticks)
+{
+    GameContext ctx = { 0 };
+    LONG samples, s, i, tick = 0;
+    LONG matches = 0, points = 0;
+    double *cost;
+    double start, end, total;
+
+    samples = ticks / SAMPLE_TICKS;
+    ticks = samples * SAMPLE_TICKS;
+
+    cost = (double *)malloc((size_t)samples * sizeof(double));
+    if (!cost) return 20;
+
+    StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(0, 0));
+
+    total = 0.0;
+    for (s = 0; s < samples; s++) {
+        start = NowNs();
+        for (i = 0; i < SAMPLE_TICKS; i++, tick++) {
+            UpdateGame(&ctx, ScriptedMouseY(ctx.ball.y, tick));
+            if (ctx.state != STATE_PLAYING) {
+                points += ctx.playerScore + ctx.aiScore;
+                matches++;
+                StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(0, matches));
+            }
+        }
+        end = NowNs();
+        cost[s] = (end - start) / SAMPLE_TICKS;
+        total += end - start;
+    }
+    points += ctx.playerScore + ctx.aiScore;
+
+    printf("ticks:       %ld\n", (long)ticks);
+    printf("matches:     %ld (%ld points)\n", (long)matches, (long)points);
+    PrintTiming(ticks, total, cost, samples);
+
+    free(cost);
+    return 0;
+}
+
+static int BenchBatch(LONG lanes, LONG ticks)
+{
+    BatchGame batch;
+    WORD *mouseY;
+    LONG *matchNo;
+    double *cost;
+    double start, end, total = 0.0;
+    LONG t, i, matches = 0;
+
+    if (!AllocBatch(&batch, lanes)) return 20;
+    mouseY = (WORD *)calloc((size_t)lanes, sizeof(WORD));
+    matchNo = (LONG *)calloc((size_t)lanes, sizeof(LONG));
+    cost = (double *)malloc((size_t)ticks * sizeof(double));
+    if (!mouseY || !matchNo || !cost) return 20;
+
+    for (i = 0; i < lanes; i++) {
+        StartBatchLane(&batch, i, (Difficulty)(i % 3), MatchStream(i, 0));
+    }
+
+    for (t = 0; t < ticks; t++) {
+        for (i = 0; i < lanes; i++) {
+            mouseY[i] = ScriptedMouseY(batch.ballY[i], t + i);
+        }
+        start = NowNs();
+        UpdateBatch(&batch, mouseY);
+        end = NowNs();
+        cost[t] = (end - start) / lanes;
+        total += end - start;
+
+        for (i = 0; i < lanes; i++) {
+            if (batch.state[i] != STATE_PLAYING) {
+                matches++;
+                matchNo[i]++;
+                StartBatchLane(&batch, i, (Difficulty)(i % 3), MatchStream(i, matchNo[i]));
+            }
+        }
+    }
+
+    printf("kernel:      %s\n", BatchKernelName(GetBatchKernel()));
+    printf("lanes:       %ld\n", (long)lanes);
+    printf("lane ticks:  %ld\n", (long)(lanes * ticks));
+    printf("matches:     %ld\n", (long)matches);
+    PrintTiming(lanes * ticks, total, cost, ticks);
+
+    free(cost);
+    free(matchNo);
+    free(mouseY);
+    FreeBatch(&batch);
+    return 0;
+}
+
+static BOOL SameGame(const GameContext *a, const GameContext *b)
+{
+    return a->state == b->state &&
+           a->ball.x == b->ball.x && a->ball.y == b->ball.y &&
+           a->ball.vx == b->ball.vx && a->ball.vy == b->ball.vy &&
+           a->playerPaddle.y == b->playerPaddle.y &&
+           a->aiPaddle.y == b->aiPaddle.y &&
+           a->aiPaddle.targetY == b->aiPaddle.targetY &&
+           a->playerScore == b->playerScore && a->aiScore == b->aiScore &&
+           a->rallies == b->rallies && a->servingPlayer == b->servingPlayer &&
+           a->aiUpdateTimer == b->aiUpdateTimer &&
+           a->rng == b->rng;
+}
+
+static ULONG fuzzSeed = 1;
+
+static LONG FuzzRange(LONG lo, LONG hi)
+{
+    fuzzSeed = fuzzSeed * 1664525UL + 1013904223UL;
+    return lo + (LONG)((fuzzSeed >> 8) % (ULONG)(hi - lo + 1));
+}
+
+/* Random ball states, biased towards the walls and scoring edges */
+static void FuzzBalls(BatchGame *b)
+{
+    LONG i;
+
+    for (i = 0; i < b->count; i++) {
+        b->state[i] = (FuzzRange(0, 7) == 0) ? STATE_GAMEOVER : STATE_PLAYING;
+        b->ballX[i] = FuzzRange(INT_TO_FP(-70), INT_TO_FP(SCREEN_WIDTH + 70));
+        b->ballVX[i] = FuzzRange(-BALL_MAX_SPEED, BALL_MAX_SPEED);
+        b->ballVY[i] = FuzzRange(INT_TO_FP(-8), INT_TO_FP(8));
+        switch (FuzzRange(0, 3)) {
+            case 0:  b->ballY[i] = FuzzRange(INT_TO_FP(40), INT_TO_FP(60)); break;
+            case 1:  b->ballY[i] = FuzzRange(INT_TO_FP(245), INT_TO_FP(265)); break;
+            default: b->ballY[i] = FuzzRange(INT_TO_FP(-70), INT_TO_FP(SCREEN_HEIGHT + 70)); break;
+        }
+    }
+}
+
+static BOOL SameBalls(const BatchGame *a, const BatchGame *b, LONG *lane)
+{
+    LONG i;
+
+    for (i = 0; i < a->count; i++) {
+        if (a->ballX[i] != b->ballX[i] || a->ballY[i] != b->ballY[i] ||
+            a->ballVX[i] != b->ballVX[i] || a->ballVY[i] != b->ballVY[i] ||
+            a->scored[i] != b->scored[i] || a->contact[i] != b->contact[i]) {
+            *lane = i;
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static void CopyBalls(BatchGame *dst, const BatchGame *src)
+{
+    size_t n = (size_t)src->count;
+
+    memcpy(dst->state, src->state, n);
+    memcpy(dst->ballX, src->ballX, n * sizeof(LONG));
+    memcpy(dst->ballY, src->ballY, n * sizeof(LONG));
+    memcpy(dst->ballVX, src->ballVX, n * sizeof(LONG));
+    memcpy(dst->ballVY, src->ballVY, n * sizeof(LONG));
+}
+
+/* Ball stage kernel against the scalar kernel, lane by lane */
+static int VerifyKernel(BatchKernel kernel)
+{
+    BatchGame ref, test;
+    LONG round, lane;
+
+    if (!AllocBatch(&ref, FUZZ_LANES) || !AllocBatch(&test, FUZZ_LANES)) return 20;
+
+    for (round = 0; round < FUZZ_ROUNDS; round++) {
+        FuzzBalls(&ref);
+        CopyBalls(&test, &ref);
+
+        SetBatchKernel(BATCH_KERNEL_SCALAR);
+        MoveBatchBalls(&ref);
+        ScoreBatchBalls(&ref);
+
+        SetBatchKernel(kernel);
+        MoveBatchBalls(&test);
+        ScoreBatchBalls(&test);
+
+        if (!SameBalls(&ref, &test, &lane)) {
+            printf("MISMATCH %s kernel, round %ld lane %ld\n",
+                   BatchKernelName(kernel), (long)round, (long)lane);
+            return 10;
+        }
+    }
+
+    printf("kernel:      %s identical on %d x %d random lanes\n",
+           BatchKernelName(kernel), FUZZ_ROUNDS, FUZZ_LANES);
+
+    FreeBatch(&test);
+    FreeBatch(&ref);
+    return 0;
+}
+
+/* Batch lanes keep 32-bit ball values; each must still fit a FIXED */
+static BOOL FitsFixed(const BatchGame *b, LONG i)
+{
+    return b->ballX[i] == (FIXED)b->ballX[i] && b->ballY[i] == (FIXED)b->ballY[i] &&
+           b->ballVX[i] == (FIXED)b->ballVX[i] && b->ballVY[i] == (FIXED)b->ballVY[i];
+}
+
+/*
+ * Run every lane through UpdateGame() too and compare after each tick.
+ * The checksum covers every tick of every lane and must come out the
+ * same from bench and bench16 (PONG_FIXED16).
+ */
+static int VerifyBatch(LONG ticks)
+{
+    BatchGame batch;
+    GameContext *ctx;
+    WORD mouseY[VERIFY_LANES];
+    GameContext lane;
+    LONG t, i, finished = 0;
+    ULONG sum = CHECKSUM_START;
+
+    if (!AllocBatch(&batch, VERIFY_LANES)) return 20;
+    ctx = (GameContext *)calloc(VERIFY_LANES, sizeof(GameContext));
+    if (!ctx) return 20;
+
+    for (i = 0; i < VERIFY_LANES; i++) {
+        StartBatchLane(&batch, i, (Difficulty)(i % 3), MatchStream(i, 0));
+        StartBenchMatch(&ctx[i], (Difficulty)(i % 3), MatchStream(i, 0));
+    }
+
+    for (t = 0; t < ticks; t++) {
+        for (i = 0; i < VERIFY_LANES; i++) {
+            mouseY[i] = ScriptedMouseY(ctx[i].ball.y, t + i);
+        }
+        UpdateBatch(&batch, mouseY);
+
+        for (i = 0; i < VERIFY_LANES; i++) {
+            UpdateGame(&ctx[i], mouseY[i]);
+            sum = ChecksumGame(sum, &ctx[i]);
+
+            if (!FitsFixed(&batch, i)) {
+                printf("OVERFLOW lane %ld tick %ld: ball does not fit FIXED\n",
+                       (long)i, (long)t);
+                return 10;
+            }
+            GetBatchLane(&batch, i, &lane);
+            if (!SameGame(&ctx[i], &lane)) {
+                printf("MISMATCH lane %ld tick %ld\n", (long)i, (long)t);
+                return 10;
+            }
+        }
+    }
+
+    for (i = 0; i < VERIFY_LANES; i++) {
+        if (ctx[i].state != STATE_PLAYING) finished++;
+    }
+    printf("verify:      %s, %d lanes x %ld ticks identical (%ld matches finished)\n",
+           BatchKernelName(GetBatchKernel()), VERIFY_LANES, (long)ticks, (long)finished);
+    printf("checksum:    %08lx (%s)\n", (unsigned long)sum,
+           sizeof(FIXED) == sizeof(WORD) ? "WORD 10.6" : "LONG 8.8");
+
+    free(ctx);
+    FreeBatch(&batch);
+    return 0;
+}
+
+/* JumpRandom() must land where stepping NextRandom() one by one does */
+static int VerifyRandom(void)
+{
+    static const LONG jumps[] = { 0, 1, 2, 3, 7, 64, 1000, 65537, 1000003 };
+    RandomState a, b;
+    LONG j, n;
+
+    for (j = 0; j < (LONG)(sizeof(jumps) / sizeof(jumps[0])); j++) {
+        SeedRandom(&a, (ULONG)(j * 7919 + 1));
+        b = a;
+        for (n = 0; n < jumps[j]; n++) NextRandom(&a, 1);
+        JumpRandom(&b, (RandomState)jumps[j]);
+        if (a != b) {
+            printf("MISMATCH JumpRandom(%ld)\n", (long)jumps[j]);
+            return 10;
+        }
+    }
+
+    /* Stream n+1 starts where stream n's 2^RANDOM_STREAM_BITS draws end */
+    SplitRandom(&a, &masterRandom, 1);
+    b = masterRandom;
+    JumpRandom(&b, (RandomState)1 << (RANDOM_STREAM_BITS - 1));
+    JumpRandom(&b, (RandomState)1 << (RANDOM_STREAM_BITS - 1));
+    if (a != b) {
+        printf("MISMATCH SplitRandom stream spacing\n");
+        return 10;
+    }
+
+    printf("random:      jump-ahead matches stepping\n");
+    return 0;
+}
+
+typedef WORD (*PredictFunc)(LONG x, LONG y, LONG vx, LONG vy, WORD faceX);
+
+typedef struct {
+    LONG x, y, vx, vy;
+    WORD actual;         /* Ball pixel Y when it reaches the AI paddle */
+} Shot;
+
+/* Fly the ball to the AI paddle face with UpdateGame()'s motion and walls */
+static WORD FlyShot(LONG x, LONG y, LONG vx, LONG vy)
+{
+    WORD ballY = FP_TO_INT(y);
+
+    while (FP_TO_INT(x) + BALL_SIZE / 2 < AI_PADDLE_FACE_X) {
+        x += vx;
+        y += vy;
+        ballY = FP_TO_INT(y);
+        if (ballY - BALL_SIZE / 2 <= 48) {
+            y = INT_TO_FP(48 + BALL_SIZE / 2);
+            vy = -vy;
+        } else if (ballY + BALL_SIZE / 2 >= SCREEN_HEIGHT) {
+            y = INT_TO_FP(SCREEN_HEIGHT - BALL_SIZE / 2);
+            vy = -vy;
+        }
+    }
+    return ballY;
+}
+
+static void BenchPredictor(const char *name, PredictFunc predict, const Shot *shots)
+{
+    static LONG error[PREDICT_SHOTS];
+    double start, total, errorSum = 0.0;
+    LONG i, r, sink = 0, hits = 0;
+
+    start = NowNs();
+    for (r = 0; r < PREDICT_ROUNDS; r++) {
+        for (i = 0; i < PREDICT_SHOTS; i++) {
+            sink += predict(shots[i].x, shots[i].y, shots[i].vx, shots[i].vy,
+                            AI_PADDLE_FACE_X);
+        }
+    }
+    total = NowNs() - start;
+
+    for (i = 0; i < PREDICT_SHOTS; i++) {
+        LONG e = predict(shots[i].x, shots[i].y, shots[i].vx, shots[i].vy,
+                         AI_PADDLE_FACE_X) - shots[i].actual;
+        error[i] = (e < 0) ? -e : e;
+        errorSum += error[i];
+        if (error[i] < PADDLE_HEIGHT / 2) hits++;
+    }
+    qsort(error, PREDICT_SHOTS, sizeof(LONG), CompareLong);
+
+    printf("%-8s %7.2f ns %9.2f px %6ld px %6ld px %8.1f%%  (%ld)\n", name,
+           total / ((double)PREDICT_ROUNDS * PREDICT_SHOTS), errorSum / PREDICT_SHOTS,
+           (long)error[(PREDICT_SHOTS * 99) / 100], (long)error[PREDICT_SHOTS - 1],
+           100.0 * hits / PREDICT_SHOTS, (long)(sink & 1));
+}
+
+/* Time both AI predictors and score them against the real flight path */
+static int BenchPredict(void)
+{
+    Shot *shots = (Shot *)malloc(PREDICT_SHOTS * sizeof(Shot));
+    LONG i;
+
+    if (!shots) return 20;
+
+    for (i = 0; i < PREDICT_SHOTS; i++) {
+        Shot *s = &shots[i];
+        s->x = FuzzRange(INT_TO_FP(PADDLE_OFFSET + PADDLE_WIDTH + BALL_SIZE / 2),
+                         INT_TO_FP(AI_PADDLE_FACE_X - BALL_SIZE / 2) - 1);
+        s->y = FuzzRange(INT_TO_FP(48 + BALL_SIZE / 2), INT_TO_FP(SCREEN_HEIGHT - BALL_SIZE / 2));
+        s->vx = FuzzRange(BALL_INITIAL_SPEED / 16, BALL_MAX_SPEED / 16) * 16;
+        s->vy = FuzzRange(INT_TO_FP(-4), INT_TO_FP(4));
+        s->actual = FlyShot(s->x, s->y, s->vx, s->vy);
+    }
+
+    printf("%d shots towards the AI paddle; a hit is an error under %d px\n\n",
+           PREDICT_SHOTS, PADDLE_HEIGHT / 2);
+    printf("%-8s %10s %12s %9s %9s %9s\n",
+           "", "time/call", "mean error", "p99", "max", "hit");
+    BenchPredictor("linear", PredictInterceptLinear, shots);
+    BenchPredictor("folded", PredictIntercept, shots);
+
+    free(shots);
+    return 0;
+}
+
+/*
+ * Fire the ball at each paddle at every speed up to 15.9 px a frame,
+ * from every 1/64 px starting phase across one frame's travel and at
+ * every hit offset: the swept test must bounce every one.
+ */
+static int VerifySweep(void)
+{
+    LONG side, vx, phase, offset, shots = 0, discreteMisses = 0;
+
+    for (side = 0; side < 2; side++) {
+        BOOL right = (side == 1);
+        WORD paddleX = right ? AI_PADDLE_FACE_X : PADDLE_OFFSET;
+
+        for (vx = 16; vx < 256; vx++) {
+            for (phase = 0; phase < vx * 4; phase++) {
+                for (offset = -(PADDLE_HEIGHT + BALL_SIZE) / 2;
+                     offset <= (PADDLE_HEIGHT + BALL_SIZE) / 2; offset++) {
+                    Ball ball;
+                    FIXED x0;
+                    BOOL hit = FALSE, overlap = FALSE;
+
+                    ball.x = INT_TO_FP(right ? 240 : 80) + FP_FROM_64THS(phase);
+                    ball.y = INT_TO_FP(150);
+                    ball.vx = FP_FROM_64THS(right ? vx * 4 : -vx * 4);
+                    ball.vy = 0;
+
+                    while (!hit && ball.x > INT_TO_FP(-BALL_SIZE) &&
+                           ball.x < INT_TO_FP(SCREEN_WIDTH + BALL_SIZE)) {
+                        WORD px;
+
+                        x0 = ball.x;
+                        ball.x += ball.vx;
+                        /* What the old overlap-only test would have seen */
+                        px = FP_TO_INT(ball.x);
+                        if (px - BALL_SIZE / 2 <= paddleX + PADDLE_WIDTH &&
+                            px + BALL_SIZE / 2 >= paddleX) {
+                            overlap = TRUE;
+                        }
+                        hit = BounceBallOffPaddle(&ball, x0, ball.y, (WORD)(150 + offset), right, 0);
+                    }
+                    shots++;
+                    if (!overlap) discreteMisses++;
+                    if (!hit || (right ? ball.vx >= 0 : ball.vx <= 0)) {
+                        printf("TUNNEL %s paddle, vx %ld/16 px phase %ld offset %ld\n",
+                               right ? "AI" : "player", (long)vx, (long)phase, (long)offset);
+                        return 10;
+                    }
+                }
+            }
+        }
+    }
+    printf("sweep:       %ld shots up to 15.9 px/frame all bounce "
+           "(overlap test alone misses %ld)\n", (long)shots, (long)discreteMisses);
+    return 0;
+}
+
+/* Play ctx to the end of its match with the scripted player */
+static ULONG FinishMatch(GameContext *ctx, LONG tick, LONG *ticks)
+{
+    ULONG sum = CHECKSUM_START;
+
+    *ticks = 0;
+    while (ctx->state == STATE_PLAYING) {
+        UpdateGame(ctx, ScriptedMouseY(ctx->ball.y, tick + *ticks));
+        sum = ChecksumGame(sum, ctx);
+        (*ticks)++;
+    }
+    return sum;
+}
+
+/*
+ * Time SaveSnapshot() and RestoreSnapshot(), then check that a match
+ * resumed from a snapshot taken at any point plays out exactly as the
+ * original did from there, even after the context has been reused.
+ */
+static int BenchSnapshot(void)
+{
+    static GameSnapshot snaps[SNAPSHOT_POINTS];
+    static ULONG expect[SNAPSHOT_POINTS];
+    static LONG at[SNAPSHOT_POINTS];
+    GameContext ctx = { 0 };
+    NameEntry entry = { "AAA", 0 };
+    LONG i, tick, length, left;
+    double start, saveNs, restoreNs;
+    ULONG sink = 0;
+
+    /* Cost: cycle through a few snapshots so the copies are not folded away */
+    StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(0, 0));
+    start = NowNs();
+    for (i = 0; i < SNAPSHOT_ROUNDS; i++) {
+        ctx.aiUpdateTimer = (WORD)i;
+        SaveSnapshot(&snaps[i & 7], &ctx, &entry);
+    }
+    saveNs = (NowNs() - start) / SNAPSHOT_ROUNDS;
+
+    start = NowNs();
+    for (i = 0; i < SNAPSHOT_ROUNDS; i++) {
+        RestoreSnapshot(&snaps[i & 7], &ctx, &entry);
+        sink += (ULONG)ctx.aiUpdateTimer;
+    }
+    restoreNs = (NowNs() - start) / SNAPSHOT_ROUNDS;
+
+    printf("size:        %lu bytes (GameContext %lu)\n",
+           (unsigned long)sizeof(GameSnapshot), (unsigned long)sizeof(GameContext));
+    printf("save:        %.2f ns\n", saveNs);
+    printf("restore:     %.2f ns  (%lu)\n", restoreNs, (unsigned long)(sink & 1));
+
+    /* Play one match, snapshotting along the way, and note how it ends */
+    StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(0, 1));
+    length = 0;
+    FinishMatch(&ctx, 0, &length);
+
+    StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(0, 1));
+    tick = 0;
+    for (i = 0; i < SNAPSHOT_POINTS; i++) {
+        GameContext branch;
+        NameEntry branchEntry;
+
+        while (tick < (length * i) / SNAPSHOT_POINTS) {
+            UpdateGame(&ctx, ScriptedMouseY(ctx.ball.y, tick));
+            tick++;
+        }
+        at[i] = tick;
+        SaveSnapshot(&snaps[i], &ctx, &entry);
+        RestoreSnapshot(&snaps[i], &branch, &branchEntry);
+        expect[i] = FinishMatch(&branch, tick, &left);
+    }
+
+    /* Restore each into a context that has since played other matches */
+    for (i = SNAPSHOT_POINTS - 1; i >= 0; i--) {
+        StartBenchMatch(&ctx, DIFFICULTY_HARD, MatchStream(1, i));
+        FinishMatch(&ctx, 0, &left);
+        RestoreSnapshot(&snaps[i], &ctx, &entry);
+        if (FinishMatch(&ctx, at[i], &left) != expect[i] || at[i] + left != length) {
+            printf("MISMATCH resuming from tick %ld\n", (long)at[i]);
+            return 10;
+        }
+    }
+    printf("resume:      %d snapshots across a %ld-tick match play out identically\n",
+           SNAPSHOT_POINTS, (long)length);
+    return 0;
+}
+
+/*
+ * Measure what the rewind history costs in memory and time over whole
+ * matches, then play long enough to wrap the ring many times and step
+ * back through everything it still holds, checking each state against
+ * the game as it was when the sample was taken.
+ */
+static int BenchRewind(void)
+{
+    static RewindBuffer r;
+    static ULONG samples[REWIND_TICKS / REWIND_INTERVAL + 1];
+    GameContext ctx = { 0 };
+    LONG m, tick, ticks = 0, n = 0, expect, restored = 0;
+    ULONG bytes = 0;
+    double start, recordNs, rewindNs;
+
+    /* Each match recorded from its start, as the game does */
+    start = NowNs();
+    for (m = 0; m < REWIND_MATCHES; m++) {
+        StartBenchMatch(&ctx, (Difficulty)(m % 3), MatchStream(2, m));
+        ResetRewind(&r);
+        RecordRewind(&r, &ctx);
+        for (tick = 0; ctx.state == STATE_PLAYING; tick++) {
+            UpdateGame(&ctx, ScriptedMouseY(ctx.ball.y, tick));
+            RecordRewind(&r, &ctx);
+        }
+        ticks += tick;
+        bytes += r.recorded;
+    }
+    recordNs = (NowNs() - start) / ticks;
+
+    printf("matches:     %d, %ld ticks (%.1f minutes)\n", REWIND_MATCHES, (long)ticks,
+           (double)ticks / STEPS_PER_MINUTE);
+    printf("sample:      %.1f bytes (image %d), every %d ticks\n",
+           (double)bytes * REWIND_INTERVAL / ticks, GAME_IMAGE_SIZE, REWIND_INTERVAL);
+    printf("history:     %.0f bytes/minute, %d-byte ring holds %.0f seconds\n",
+           (double)bytes * STEPS_PER_MINUTE / ticks, REWIND_BUFFER_SIZE,
+           (double)REWIND_BUFFER_SIZE * ticks / bytes / 50);
+    printf("record:      %.2f ns/tick (step included)\n", recordNs);
+
+    /* One long session into one ring, noting every sample taken */
+    StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(3, 0));
+    ResetRewind(&r);
+    RecordRewind(&r, &ctx);
+    samples[n++] = ChecksumGame(CHECKSUM_START, &ctx);
+    for (tick = 0; tick < REWIND_TICKS - 1; tick++) {
+        if (ctx.state != STATE_PLAYING) {
+            StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(3, tick));
+        }
+        UpdateGame(&ctx, ScriptedMouseY(ctx.ball.y, tick));
+        RecordRewind(&r, &ctx);
+        if (r.sinceSample == 0) samples[n++] = ChecksumGame(CHECKSUM_START, &ctx);
+    }
+    printf("ring:        %u bytes used, %u samples, %ld ticks back\n",
+           (unsigned)r.used, (unsigned)r.entries, (long)RewindSteps(&r));
+
+    /* Back to the newest sample, or the one before if it was just taken */
+    expect = (r.sinceSample == 0) ? n - 2 : n - 1;
+    start = NowNs();
+    while (Rewind(&r, &ctx)) {
+        if (expect < 0 || ChecksumGame(CHECKSUM_START, &ctx) != samples[expect]) {
+            printf("MISMATCH rewinding to sample %ld\n", (long)expect);
+            return 11;
+        }
+        expect--;
+        restored++;
+    }
+    rewindNs = (NowNs() - start) / restored;
+
+    printf("rewind:      %ld samples restored exactly, %.2f ns each\n",
+           (long)restored, rewindNs);
+    return 0;
+}
+
+/* One scripted frame: input, a step and a checksum standing in for render */
+static ULONG ProfiledFrame(GameContext *ctx, LONG frame, ULONG sum, BOOL timed)
+{
+    WORD mouseY;
+
+    if (timed) {
+        ProfileFrame();
+        ProfileBegin(PROFILE_INPUT);
+    }
+    mouseY = ScriptedMouseY(ctx->ball.y, frame);
+    if (timed) {
+        ProfileEnd(PROFILE_INPUT);
+        ProfileBegin(PROFILE_UPDATE);
+    }
+    if (ctx->state != STATE_PLAYING) {
+        StartBenchMatch(ctx, DIFFICULTY_MEDIUM, MatchStream(4, frame));
+    }
+    UpdateGame(ctx, mouseY);
+    if (timed) {
+        ProfileEnd(PROFILE_UPDATE);
+        ProfileBegin(PROFILE_RENDER);
+    }
+    sum = ChecksumGame(sum, ctx);
+    if (timed) ProfileEnd(PROFILE_RENDER);
+    return sum;
+}
+
+/*
+ * What the profiler adds to a frame (three phases timed), then a
+ * sample report from frames that stall now and then, as a disk
+ * write would.
+ */
+static int BenchProfile(void)
+{
+    GameContext ctx = { 0 };
+    LONG f;
+    ULONG sum = CHECKSUM_START, stall;
+    double start, plainNs, timedNs;
+
+    if (!StartProfile()) {
+        printf("no profile clock\n");
+        return 12;
+    }
+
+    StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(4, 0));
+    start = NowNs();
+    for (f = 0; f < PROFILE_FRAMES; f++) {
+        sum = ProfiledFrame(&ctx, f, sum, FALSE);
+    }
+    plainNs = (NowNs() - start) / PROFILE_FRAMES;
+
+    StartBenchMatch(&ctx, DIFFICULTY_MEDIUM, MatchStream(4, 0));
+    start = NowNs();
+    for (f = 0; f < PROFILE_FRAMES; f++) {
+        sum = ProfiledFrame(&ctx, f, sum, TRUE);
+    }
+    timedNs = (NowNs() - start) / PROFILE_FRAMES;
+
+    printf("frame:       %.2f ns, %.2f ns profiled (%lu)\n", plainNs, timedNs,
+           (unsigned long)(sum & 1));
+    printf("overhead:    %.2f ns per phase\n", (timedNs - plainNs) / 3);
+
+    /* A fresh run for the report, with a few long frames in it */
+    StartProfile();
+    for (f = 0; f < PROFILE_FRAMES; f++) {
+        sum = ProfiledFrame(&ctx, f, sum, TRUE);
+        if (f % PROFILE_STALL_EVERY == PROFILE_STALL_EVERY - 1) {
+            ProfileBegin(PROFILE_WAIT_TOF);
+            stall = ReadProfileClock();
+            while (ReadProfileClock() - stall < PROFILE_STALL_US) {
+            }
+            ProfileEnd(PROFILE_WAIT_TOF);
+        }
+    }
+    ProfileFrame();
+
+    if (!WriteProfile("pong.profile")) {
+        printf("could not write pong.profile\n");
+        return 12;
+    }
+    StopProfile();
+    printf("report:      pong.profile (%ld frames, a %ld ms stall every %ld)\n",
+           (long)PROFILE_FRAMES, PROFILE_STALL_US / 1000, (long)PROFILE_STALL_EVERY);
+    return 0;
+}
+
+/* Check every kernel this CPU supports */
+static int VerifyAll(LONG ticks)
+{
+    BatchKernel k;
+    int rc;
+
+    if ((rc = VerifyRandom()) != 0) return rc;
+    if ((rc = VerifySweep()) != 0) return rc;
+
+    for (k = BATCH_KERNEL_SCALAR; k < BATCH_KERNEL_BEST; k = (BatchKernel)(k + 1)) {
+        if (SetBatchKernel(k) != k) continue;
+        if (k != BATCH_KERNEL_SCALAR && (rc = VerifyKernel(k)) != 0) return rc;
+        SetBatchKernel(k);
+        if ((rc = VerifyBatch(ticks)) != 0) return rc;
+    }
+    return 0;
+}
+
+static BatchKernel ParseKernel(const char *name)
+{
+    BatchKernel k;
+
+    for (k = BATCH_KERNEL_SCALAR; k < BATCH_KERNEL_BEST; k = (BatchKernel)(k + 1)) {
+        if (strcmp(name, BatchKernelName(k)) == 0) return k;
+    }
+    return BATCH_KERNEL_BEST;
+}
+
+int main(int argc, char **argv)
+{
+    LONG lanes = 0;
+    LONG ticks = 0;
+    BOOL verify = FALSE;
+    BOOL predict = FALSE;
+    BOOL snapshot = FALSE;
+    BOOL rewinding = FALSE;
+    BOOL profile = FALSE;
+    int i;
+
+    SeedRandom(&masterRandom, RANDOM_DEFAULT_SEED);
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-batch") == 0 && i + 1 < argc) {
+            lanes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-kernel") == 0 && i + 1 < argc) {
+            SetBatchKernel(ParseKernel(argv[++i]));
+        } else if (strcmp(argv[i], "-verify") == 0) {
+            verify = TRUE;
+        } else if (strcmp(argv[i], "-predict") == 0) {
+            predict = TRUE;
+        } else if (strcmp(argv[i], "-snapshot") == 0) {
+            snapshot = TRUE;
+        } else if (strcmp(argv[i], "-rewind") == 0) {
+            rewinding = TRUE;
+        } else if (strcmp(argv[i], "-profile") == 0) {
+            profile = TRUE;
+        } else {
+            ticks = atol(argv[i]);
+        }
+    }
+
+    if (verify) {
+        return VerifyAll(ticks > 0 ? ticks : DEFAULT_BATCH_TICKS);
+    }
+    if (predict) {
+        return BenchPredict();
+    }
+    if (snapshot) {
+        return BenchSnapshot();
+    }
+    if (rewinding) {
+        return BenchRewind();
+    }
+    if (profile) {
+        return BenchProfile();
+    }
+    if (lanes > 0) {
+        return BenchBatch(lanes, ticks > 0 ? ticks : DEFAULT_BATCH_TICKS);
+    }
+    if (ticks < SAMPLE_TICKS) ticks = DEFAULT_TICKS;
+    return BenchScalar(ticks);
+}
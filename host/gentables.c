@@ -0,0 +1,188 @@
+/*
+ * gentables.c - Writes tables.c, the game core's division tables
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Runs on the build machine. Every table is checked against the
+ * division it replaces over its whole input domain first; on any
+ * mismatch nothing is written and the build stops. A 68000 cycle
+ * estimate for each replacement goes to stderr.
+ *
+ * spinTable is written for both fixed-point formats (8.8 and, for
+ * PONG_FIXED16, 10.6) and tables.c picks one when it is compiled.
+ *
+ * recipTable has no exact counterpart: it feeds PredictIntercept()'s
+ * time-to-reach estimate, which bench -predict scores instead.
+ *
+ * Usage: gentables > tables.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <exec/types.h>
+#include "graphics.h"
+#include "tables.h"
+
+/* 68000 timings: MULU.W is 38 + 2 per set bit of the multiplier */
+#define DIVU_MIN 76
+#define DIVU_MAX 140
+
+static UWORD recip[RECIP_SIZE];
+static WORD spin[2][2 * SPIN_RANGE + 1];   /* 8.8, 10.6 */
+static DivMagic magic[MODULO_MAX + 1];
+
+static LONG MuluCycles(ULONG multiplier)
+{
+    LONG cycles = 38;
+
+    for (; multiplier; multiplier >>= 1) {
+        if (multiplier & 1) cycles += 2;
+    }
+    return cycles;
+}
+
+/* The spin CalculateSpin() computed with a division, fpShift fraction bits */
+static LONG DividedSpin(LONG offset, LONG fpShift)
+{
+    LONG s = (offset * (3L << fpShift)) / (PADDLE_HEIGHT / 2);
+
+    if (s > (3L << fpShift)) s = 3L << fpShift;
+    if (s < -(3L << fpShift)) s = -(3L << fpShift);
+    return s;
+}
+
+static BOOL BuildRecip(void)
+{
+    LONG n;
+
+    for (n = 0; n < RECIP_SIZE; n++) {
+        recip[n] = (n < 2) ? 0xFFFF : (UWORD)(65536L / n);
+    }
+    fprintf(stderr, "recipTable:  %d entries, one MULU.W (<= 70 cycles) "
+            "instead of a 32-bit divide call\n", RECIP_SIZE);
+    return TRUE;
+}
+
+static BOOL BuildSpin(void)
+{
+    static const LONG fpShift[2] = { 8, 6 };
+    LONG f, offset;
+
+    for (f = 0; f < 2; f++) {
+        WORD *table = spin[f];
+
+        for (offset = -SPIN_RANGE; offset <= SPIN_RANGE; offset++) {
+            table[offset + SPIN_RANGE] = (WORD)DividedSpin(offset, fpShift[f]);
+        }
+
+        /* Every WORD offset, saturating the index as CalculateSpin() does */
+        for (offset = -32768; offset <= 32767; offset++) {
+            LONG index = offset;
+            LONG want = DividedSpin(offset, fpShift[f]);
+
+            if (index < -SPIN_RANGE) index = -SPIN_RANGE;
+            if (index > SPIN_RANGE) index = SPIN_RANGE;
+            if (table[index + SPIN_RANGE] != want) {
+                fprintf(stderr, "spinTable: offset %ld gives %d, want %ld\n",
+                        (long)offset, table[index + SPIN_RANGE], (long)want);
+                return FALSE;
+            }
+        }
+    }
+    fprintf(stderr, "spinTable:   %d entries, exact for every WORD offset; "
+            "a table read (~18 cycles) instead of a MULS.W (<= 70), "
+            "rounding shift and clamp\n", 2 * SPIN_RANGE + 1);
+    return TRUE;
+}
+
+static BOOL BuildModulo(void)
+{
+    LONG d, r, cyclesMin = 1000, cyclesMax = 0;
+
+    magic[0].mul = 0;
+    magic[0].shift = 0;
+
+    for (d = 1; d <= MODULO_MAX; d++) {
+        UWORD shift;
+        BOOL found = FALSE;
+
+        /* Smallest shift whose rounded-up reciprocal is exact */
+        for (shift = 15; shift < 32 && !found; shift++) {
+            ULONG mul = (ULONG)((((unsigned long long)1 << shift) + d - 1) / d);
+            if (mul > 0xFFFF) break;
+
+            found = TRUE;
+            for (r = 0; r < 32768; r++) {
+                if ((ULONG)r - d * (((ULONG)r * mul) >> shift) != (ULONG)(r % d)) {
+                    found = FALSE;
+                    break;
+                }
+            }
+            if (found) {
+                /* Two MULU.Ws, the shift (SWAP + LSR.W past 16) and a SUB */
+                LONG cycles = MuluCycles(mul) + MuluCycles((ULONG)d) + 4 +
+                              ((shift >= 16) ? 10 + 2 * (shift - 16) : 8 + 2 * shift);
+                magic[d].mul = (UWORD)mul;
+                magic[d].shift = shift;
+                if (cycles < cyclesMin) cyclesMin = cycles;
+                if (cycles > cyclesMax) cyclesMax = cycles;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "moduloTable: no 16-bit multiplier for %ld\n", (long)d);
+            return FALSE;
+        }
+    }
+    fprintf(stderr, "moduloTable: %d divisors, exact for r < 32768; "
+            "%ld-%ld cycles instead of DIVU.W (%d-%d)\n",
+            MODULO_MAX, (long)cyclesMin, (long)cyclesMax, DIVU_MIN, DIVU_MAX);
+    return TRUE;
+}
+
+static void PrintWords(const WORD *values, LONG count)
+{
+    LONG i;
+
+    for (i = 0; i < count; i++) {
+        printf("%s%4d%s", (i % 10) ? " " : "\n    ", values[i],
+               (i < count - 1) ? "," : "");
+    }
+}
+
+int main(void)
+{
+    LONG i;
+
+    if (!BuildRecip() || !BuildSpin() || !BuildModulo()) return 20;
+
+    printf("/*\n"
+           " * tables.c - Division tables for the game core\n"
+           " * Amiga Pong - OS-friendly implementation\n"
+           " *\n"
+           " * Generated by host/gentables - do not edit.\n"
+           " */\n\n"
+           "#include <exec/types.h>\n"
+           "#include \"tables.h\"\n\n");
+
+    printf("const UWORD recipTable[RECIP_SIZE] = {");
+    for (i = 0; i < RECIP_SIZE; i++) {
+        printf("%s%5u%s", (i % 10) ? " " : "\n    ", recip[i],
+               (i < RECIP_SIZE - 1) ? "," : "");
+    }
+    printf("\n};\n\n");
+
+    printf("const WORD spinTable[2 * SPIN_RANGE + 1] = {\n#ifdef PONG_FIXED16");
+    PrintWords(spin[1], 2 * SPIN_RANGE + 1);
+    printf("\n#else");
+    PrintWords(spin[0], 2 * SPIN_RANGE + 1);
+    printf("\n#endif\n};\n\n");
+
+    printf("const DivMagic moduloTable[MODULO_MAX + 1] = {");
+    for (i = 0; i <= MODULO_MAX; i++) {
+        printf("%s{ %5u, %2u }%s", (i % 4) ? " " : "\n    ",
+               magic[i].mul, magic[i].shift, (i < MODULO_MAX) ? "," : "");
+    }
+    printf("\n};\n");
+
+    return 0;
+}
@@ -0,0 +1,513 @@
+/*
+ * gfxsoft.c - Software drawing backend: a planar bitmap in memory
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Implements gfx.h without graphics.library, so graphics.c can draw
+ * every screen on the build machine. Rectangles are filled a byte at a
+ * time in each plane, glyphs and the off-screen copies are copied a
+ * row at a time, text is drawn from an 8x8 font in place of topaz,
+ * with the background colour behind it as JAM2 does, and sprites keep
+ * a position that is laid over the playfield when the screen is read
+ * back. There is no display to wait for, so waits only count.
+ *
+ * There are two bitmaps, as on the Amiga: drawing goes to the back one
+ * and the screen is read back from the shown one, so a frame is only
+ * seen once GfxSwap() has shown it. The rectangles that changed are
+ * copied into the new back bitmap before it is next drawn into, and
+ * those copies are counted with the drawing.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <exec/types.h>
+#include "gfx.h"
+#include "graphics.h"
+#include "host/gfxsoft.h"
+
+/* 8x8 font for characters 32-126, top row first, leftmost pixel in bit 7 */
+#define FONT_FIRST    32
+#define FONT_LAST     126
+#define FONT_BASELINE 6    /* Rows above the baseline, as topaz 8 */
+
+static const UBYTE font[FONT_LAST - FONT_FIRST + 1][8] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  /* space */
+    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 },  /* ! */
+    { 0x6C, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  /* " */
+    { 0x6C, 0x6C, 0xFE, 0x6C, 0xFE, 0x6C, 0x6C, 0x00 },  /* # */
+    { 0x30, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x30, 0x00 },  /* $ */
+    { 0x00, 0xC6, 0xCC, 0x18, 0x30, 0x66, 0xC6, 0x00 },  /* % */
+    { 0x38, 0x6C, 0x38, 0x76, 0xDC, 0xCC, 0x76, 0x00 },  /* & */
+    { 0x60, 0x60, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00 },  /* ' */
+    { 0x18, 0x30, 0x60, 0x60, 0x60, 0x30, 0x18, 0x00 },  /* ( */
+    { 0x60, 0x30, 0x18, 0x18, 0x18, 0x30, 0x60, 0x00 },  /* ) */
+    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 },  /* asterisk */
+    { 0x00, 0x30, 0x30, 0xFC, 0x30, 0x30, 0x00, 0x00 },  /* + */
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x60 },  /* , */
+    { 0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0x00 },  /* - */
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00 },  /* . */
+    { 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x80, 0x00 },  /* slash */
+    { 0x7C, 0xC6, 0xCE, 0xDE, 0xF6, 0xE6, 0x7C, 0x00 },  /* 0 */
+    { 0x30, 0x70, 0x30, 0x30, 0x30, 0x30, 0xFC, 0x00 },  /* 1 */
+    { 0x78, 0xCC, 0x0C, 0x38, 0x60, 0xCC, 0xFC, 0x00 },  /* 2 */
+    { 0x78, 0xCC, 0x0C, 0x38, 0x0C, 0xCC, 0x78, 0x00 },  /* 3 */
+    { 0x1C, 0x3C, 0x6C, 0xCC, 0xFE, 0x0C, 0x1E, 0x00 },  /* 4 */
+    { 0xFC, 0xC0, 0xF8, 0x0C, 0x0C, 0xCC, 0x78, 0x00 },  /* 5 */
+    { 0x38, 0x60, 0xC0, 0xF8, 0xCC, 0xCC, 0x78, 0x00 },  /* 6 */
+    { 0xFC, 0xCC, 0x0C, 0x18, 0x30, 0x30, 0x30, 0x00 },  /* 7 */
+    { 0x78, 0xCC, 0xCC, 0x78, 0xCC, 0xCC, 0x78, 0x00 },  /* 8 */
+    { 0x78, 0xCC, 0xCC, 0x7C, 0x0C, 0x18, 0x70, 0x00 },  /* 9 */
+    { 0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30, 0x00 },  /* : */
+    { 0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30, 0x60 },  /* ; */
+    { 0x18, 0x30, 0x60, 0xC0, 0x60, 0x30, 0x18, 0x00 },  /* < */
+    { 0x00, 0x00, 0xFC, 0x00, 0x00, 0xFC, 0x00, 0x00 },  /* = */
+    { 0x60, 0x30, 0x18, 0x0C, 0x18, 0x30, 0x60, 0x00 },  /* > */
+    { 0x78, 0xCC, 0x0C, 0x18, 0x30, 0x00, 0x30, 0x00 },  /* ? */
+    { 0x7C, 0xC6, 0xDE, 0xDE, 0xDE, 0xC0, 0x78, 0x00 },  /* @ */
+    { 0x30, 0x78, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0x00 },  /* A */
+    { 0xFC, 0x66, 0x66, 0x7C, 0x66, 0x66, 0xFC, 0x00 },  /* B */
+    { 0x3C, 0x66, 0xC0, 0xC0, 0xC0, 0x66, 0x3C, 0x00 },  /* C */
+    { 0xF8, 0x6C, 0x66, 0x66, 0x66, 0x6C, 0xF8, 0x00 },  /* D */
+    { 0xFE, 0x62, 0x68, 0x78, 0x68, 0x62, 0xFE, 0x00 },  /* E */
+    { 0xFE, 0x62, 0x68, 0x78, 0x68, 0x60, 0xF0, 0x00 },  /* F */
+    { 0x3C, 0x66, 0xC0, 0xC0, 0xCE, 0x66, 0x3E, 0x00 },  /* G */
+    { 0xCC, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0xCC, 0x00 },  /* H */
+    { 0x78, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00 },  /* I */
+    { 0x1E, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78, 0x00 },  /* J */
+    { 0xE6, 0x66, 0x6C, 0x78, 0x6C, 0x66, 0xE6, 0x00 },  /* K */
+    { 0xF0, 0x60, 0x60, 0x60, 0x62, 0x66, 0xFE, 0x00 },  /* L */
+    { 0xC6, 0xEE, 0xFE, 0xFE, 0xD6, 0xC6, 0xC6, 0x00 },  /* M */
+    { 0xC6, 0xE6, 0xF6, 0xDE, 0xCE, 0xC6, 0xC6, 0x00 },  /* N */
+    { 0x38, 0x6C, 0xC6, 0xC6, 0xC6, 0x6C, 0x38, 0x00 },  /* O */
+    { 0xFC, 0x66, 0x66, 0x7C, 0x60, 0x60, 0xF0, 0x00 },  /* P */
+    { 0x78, 0xCC, 0xCC, 0xCC, 0xDC, 0x78, 0x1C, 0x00 },  /* Q */
+    { 0xFC, 0x66, 0x66, 0x7C, 0x6C, 0x66, 0xE6, 0x00 },  /* R */
+    { 0x78, 0xCC, 0xE0, 0x70, 0x1C, 0xCC, 0x78, 0x00 },  /* S */
+    { 0xFC, 0xB4, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00 },  /* T */
+    { 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC, 0x00 },  /* U */
+    { 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00 },  /* V */
+    { 0xC6, 0xC6, 0xC6, 0xD6, 0xFE, 0xEE, 0xC6, 0x00 },  /* W */
+    { 0xC6, 0xC6, 0x6C, 0x38, 0x38, 0x6C, 0xC6, 0x00 },  /* X */
+    { 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x30, 0x78, 0x00 },  /* Y */
+    { 0xFE, 0xC6, 0x8C, 0x18, 0x32, 0x66, 0xFE, 0x00 },  /* Z */
+    { 0x78, 0x60, 0x60, 0x60, 0x60, 0x60, 0x78, 0x00 },  /* [ */
+    { 0xC0, 0x60, 0x30, 0x18, 0x0C, 0x06, 0x02, 0x00 },  /* backslash */
+    { 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0x78, 0x00 },  /* ] */
+    { 0x10, 0x38, 0x6C, 0xC6, 0x00, 0x00, 0x00, 0x00 },  /* ^ */
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF },  /* _ */
+    { 0x30, 0x30, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },  /* ` */
+    { 0x00, 0x00, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00 },  /* a */
+    { 0xE0, 0x60, 0x60, 0x7C, 0x66, 0x66, 0xDC, 0x00 },  /* b */
+    { 0x00, 0x00, 0x78, 0xCC, 0xC0, 0xCC, 0x78, 0x00 },  /* c */
+    { 0x1C, 0x0C, 0x0C, 0x7C, 0xCC, 0xCC, 0x76, 0x00 },  /* d */
+    { 0x00, 0x00, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00 },  /* e */
+    { 0x38, 0x6C, 0x60, 0xF0, 0x60, 0x60, 0xF0, 0x00 },  /* f */
+    { 0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8 },  /* g */
+    { 0xE0, 0x60, 0x6C, 0x76, 0x66, 0x66, 0xE6, 0x00 },  /* h */
+    { 0x30, 0x00, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00 },  /* i */
+    { 0x0C, 0x00, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78 },  /* j */
+    { 0xE0, 0x60, 0x66, 0x6C, 0x78, 0x6C, 0xE6, 0x00 },  /* k */
+    { 0x70, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00 },  /* l */
+    { 0x00, 0x00, 0xCC, 0xFE, 0xFE, 0xD6, 0xC6, 0x00 },  /* m */
+    { 0x00, 0x00, 0xF8, 0xCC, 0xCC, 0xCC, 0xCC, 0x00 },  /* n */
+    { 0x00, 0x00, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00 },  /* o */
+    { 0x00, 0x00, 0xDC, 0x66, 0x66, 0x7C, 0x60, 0xF0 },  /* p */
+    { 0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0x1E },  /* q */
+    { 0x00, 0x00, 0xDC, 0x76, 0x66, 0x60, 0xF0, 0x00 },  /* r */
+    { 0x00, 0x00, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x00 },  /* s */
+    { 0x10, 0x30, 0x7C, 0x30, 0x30, 0x34, 0x18, 0x00 },  /* t */
+    { 0x00, 0x00, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00 },  /* u */
+    { 0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00 },  /* v */
+    { 0x00, 0x00, 0xC6, 0xD6, 0xFE, 0xFE, 0x6C, 0x00 },  /* w */
+    { 0x00, 0x00, 0xC6, 0x6C, 0x38, 0x6C, 0xC6, 0x00 },  /* x */
+    { 0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8 },  /* y */
+    { 0x00, 0x00, 0xFC, 0x98, 0x30, 0x64, 0xFC, 0x00 },  /* z */
+    { 0x1C, 0x30, 0x30, 0xE0, 0x30, 0x30, 0x1C, 0x00 },  /* { */
+    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 },  /* | */
+    { 0xE0, 0x30, 0x30, 0x1C, 0x30, 0x30, 0xE0, 0x00 },  /* } */
+    { 0x76, 0xDC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  /* ~ */
+};
+
+/* Sprite images as rows of 8 pixels, and the colour they show in */
+#define BALL_ROWS   8
+#define PADDLE_ROWS 36
+#define PADDLE_GAP  2      /* Blank rows above and below the paddle */
+
+typedef struct {
+    WORD x, y;
+    WORD rows;
+    WORD gap;
+    UBYTE color;
+} SoftSprite;
+
+typedef UBYTE SoftBitMap[SCREEN_DEPTH][SCREEN_HEIGHT][SOFT_ROW_BYTES];
+
+static SoftBitMap buffers[2];
+static WORD drawBuffer = 1;
+static UBYTE (*planes)[SCREEN_HEIGHT][SOFT_ROW_BYTES] = buffers[1];
+static UBYTE (*shown)[SCREEN_HEIGHT][SOFT_ROW_BYTES] = buffers[0];
+static DirtyList pendingSync;       /* Shown but not yet in the back bitmap */
+static SoftBitMap copies[GFX_COPIES];
+static UWORD colors[1 << SCREEN_DEPTH];
+static SoftSprite sprites[GFX_SPRITES];
+static SoftStats stats;
+
+/* Loaded glyphs, as the rows passed to GfxLoadGlyphs() */
+#define GLYPH_WORDS 4096
+static UWORD glyphRows[GLYPH_WORDS];
+static WORD glyphCount = 0;
+static WORD glyphHeight = 0;
+
+BOOL GfxOpen(const UWORD *palette, WORD count)
+{
+    WORD i;
+
+    for (i = 0; i < (1 << SCREEN_DEPTH); i++) {
+        colors[i] = (i < count) ? palette[i] : 0;
+    }
+
+    sprites[GFX_SPRITE_BALL].rows = BALL_ROWS;
+    sprites[GFX_SPRITE_BALL].gap = 0;
+    sprites[GFX_SPRITE_BALL].color = COLOR_WHITE;
+    sprites[GFX_SPRITE_PLAYER].rows = PADDLE_ROWS;
+    sprites[GFX_SPRITE_PLAYER].gap = PADDLE_GAP;
+    sprites[GFX_SPRITE_PLAYER].color = COLOR_WHITE;
+    sprites[GFX_SPRITE_AI].rows = PADDLE_ROWS;
+    sprites[GFX_SPRITE_AI].gap = PADDLE_GAP;
+    sprites[GFX_SPRITE_AI].color = COLOR_CYAN;
+    for (i = 0; i < GFX_SPRITES; i++) {
+        sprites[i].x = -100;
+        sprites[i].y = 0;
+    }
+
+    ClearDirty(&pendingSync);
+    GfxClear(COLOR_BACKGROUND);
+    memcpy(shown, planes, sizeof(SoftBitMap));
+    ResetSoftStats();
+    return TRUE;
+}
+
+void GfxClose(void)
+{
+}
+
+struct Window *GfxWindow(void)
+{
+    return NULL;
+}
+
+static void SyncBackBuffer(void);
+
+void GfxClear(UBYTE color)
+{
+    WORD p;
+
+    SyncBackBuffer();
+
+    for (p = 0; p < SCREEN_DEPTH; p++) {
+        memset(planes[p], (color & (1 << p)) ? 0xFF : 0x00, sizeof(planes[p]));
+    }
+    stats.calls++;
+    stats.pixels += (ULONG)SCREEN_WIDTH * SCREEN_HEIGHT;
+}
+
+void GfxRectFill(WORD x0, WORD y0, WORD x1, WORD y1, UBYTE color)
+{
+    WORD first, last, p, y, b;
+    UBYTE firstMask, lastMask;
+
+    SyncBackBuffer();
+    stats.calls++;
+
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= SCREEN_WIDTH) x1 = SCREEN_WIDTH - 1;
+    if (y1 >= SCREEN_HEIGHT) y1 = SCREEN_HEIGHT - 1;
+    if (x0 > x1 || y0 > y1) return;
+
+    first = x0 >> 3;
+    last = x1 >> 3;
+    firstMask = (UBYTE)(0xFF >> (x0 & 7));
+    lastMask = (UBYTE)(0xFF << (7 - (x1 & 7)));
+    if (first == last) firstMask &= lastMask;
+
+    for (p = 0; p < SCREEN_DEPTH; p++) {
+        BOOL set = (color & (1 << p)) != 0;
+
+        for (y = y0; y <= y1; y++) {
+            UBYTE *row = planes[p][y];
+
+            if (set) {
+                row[first] |= firstMask;
+            } else {
+                row[first] &= (UBYTE)~firstMask;
+            }
+            if (first == last) continue;
+
+            for (b = first + 1; b < last; b++) {
+                row[b] = set ? 0xFF : 0x00;
+            }
+            if (set) {
+                row[last] |= lastMask;
+            } else {
+                row[last] &= (UBYTE)~lastMask;
+            }
+        }
+    }
+    stats.pixels += (ULONG)(x1 - x0 + 1) * (y1 - y0 + 1);
+}
+
+static void PutPixel(WORD x, WORD y, UBYTE color)
+{
+    UBYTE bit = (UBYTE)(0x80 >> (x & 7));
+    WORD p;
+
+    if (x < 0 || y < 0 || x >= SCREEN_WIDTH || y >= SCREEN_HEIGHT) return;
+
+    for (p = 0; p < SCREEN_DEPTH; p++) {
+        if (color & (1 << p)) {
+            planes[p][y][x >> 3] |= bit;
+        } else {
+            planes[p][y][x >> 3] &= (UBYTE)~bit;
+        }
+    }
+    stats.pixels++;
+}
+
+void GfxText(WORD x, WORD y, const char *text, WORD length, UBYTE color)
+{
+    WORD i, row, col;
+    const UBYTE *glyph;
+    UBYTE c;
+
+    SyncBackBuffer();
+    stats.calls++;
+
+    for (i = 0; i < length; i++, x += 8) {
+        c = (UBYTE)text[i];
+        if (c < FONT_FIRST || c > FONT_LAST) c = '?';
+        glyph = font[c - FONT_FIRST];
+
+        for (row = 0; row < 8; row++) {
+            for (col = 0; col < 8; col++) {
+                PutPixel((WORD)(x + col), (WORD)(y - FONT_BASELINE + row),
+                         (glyph[row] & (0x80 >> col)) ? color : COLOR_BACKGROUND);
+            }
+        }
+    }
+}
+
+BOOL GfxLoadGlyphs(const UWORD *rows, WORD count, WORD height)
+{
+    LONG i, words = (LONG)count * height;
+
+    glyphCount = 0;
+    if (words > GLYPH_WORDS) return FALSE;
+
+    for (i = 0; i < words; i++) {
+        glyphRows[i] = rows[i];
+    }
+    glyphCount = count;
+    glyphHeight = height;
+    return TRUE;
+}
+
+/* One blit: each row is 16 pixels across the three bytes it may touch */
+void GfxGlyph(WORD glyph, WORD x, WORD y, UBYTE color)
+{
+    const UWORD *src;
+    WORD row, p, k, first = x >> 3;
+    WORD shift = 8 - (x & 7);
+    ULONG bits, mask = 0xFFFFUL << shift;
+    UBYTE m, set;
+
+    SyncBackBuffer();
+    stats.calls++;
+    if (glyph < 0 || glyph >= glyphCount) return;
+
+    src = &glyphRows[glyph * glyphHeight];
+    for (row = 0; row < glyphHeight; row++, y++) {
+        if (y < 0 || y >= SCREEN_HEIGHT) continue;
+
+        bits = (ULONG)src[row] << shift;
+        for (p = 0; p < SCREEN_DEPTH; p++) {
+            UBYTE *dest = &planes[p][y][first];
+
+            for (k = 0; k < 3; k++) {
+                m = (UBYTE)(mask >> (16 - 8 * k));
+                if (m == 0) continue;
+
+                set = 0;
+                if (color & (1 << p)) set |= (UBYTE)(bits >> (16 - 8 * k));
+                if (COLOR_BACKGROUND & (1 << p)) set |= (UBYTE)~(bits >> (16 - 8 * k));
+                dest[k] = (UBYTE)((dest[k] & ~m) | (set & m));
+            }
+        }
+        stats.pixels += GFX_GLYPH_WIDTH;
+    }
+}
+
+/* A rectangle from one bitmap to the same place in another, as a blit */
+static void CopyRect(SoftBitMap from, SoftBitMap to, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    WORD first, last, p, y, b;
+    UBYTE firstMask, lastMask;
+
+    stats.calls++;
+
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= SCREEN_WIDTH) x1 = SCREEN_WIDTH - 1;
+    if (y1 >= SCREEN_HEIGHT) y1 = SCREEN_HEIGHT - 1;
+    if (x0 > x1 || y0 > y1) return;
+
+    first = x0 >> 3;
+    last = x1 >> 3;
+    firstMask = (UBYTE)(0xFF >> (x0 & 7));
+    lastMask = (UBYTE)(0xFF << (7 - (x1 & 7)));
+    if (first == last) firstMask &= lastMask;
+
+    for (p = 0; p < SCREEN_DEPTH; p++) {
+        for (y = y0; y <= y1; y++) {
+            const UBYTE *src = from[p][y];
+            UBYTE *dest = to[p][y];
+
+            dest[first] = (UBYTE)((dest[first] & ~firstMask) | (src[first] & firstMask));
+            if (first == last) continue;
+
+            for (b = first + 1; b < last; b++) {
+                dest[b] = src[b];
+            }
+            dest[last] = (UBYTE)((dest[last] & ~lastMask) | (src[last] & lastMask));
+        }
+    }
+    stats.pixels += (ULONG)(x1 - x0 + 1) * (y1 - y0 + 1);
+}
+
+/* Bring the back bitmap up to the shown one where they differ */
+static void SyncBackBuffer(void)
+{
+    WORD i;
+
+    for (i = 0; i < pendingSync.count; i++) {
+        const DirtyRect *r = &pendingSync.rects[i];
+
+        CopyRect(shown, planes, r->x0, r->y0, r->x1, r->y1);
+    }
+    ClearDirty(&pendingSync);
+}
+
+void GfxSave(GfxCopy copy, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    SyncBackBuffer();
+    CopyRect(planes, copies[copy], x0, y0, x1, y1);
+}
+
+void GfxRestore(GfxCopy copy, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+    SyncBackBuffer();
+    CopyRect(copies[copy], planes, x0, y0, x1, y1);
+}
+
+void GfxSwap(const DirtyList *changed)
+{
+    if (changed->count == 0) return;
+
+    SyncBackBuffer();
+    drawBuffer ^= 1;
+    planes = buffers[drawBuffer];
+    shown = buffers[drawBuffer ^ 1];
+    pendingSync = *changed;
+}
+
+void GfxMoveSprite(GfxSprite sprite, WORD x, WORD y)
+{
+    sprites[sprite].x = x;
+    sprites[sprite].y = y;
+}
+
+void GfxWaitBeam(void)
+{
+    stats.waits++;
+}
+
+void GfxWaitFrame(void)
+{
+    stats.waits++;
+}
+
+void GetSoftStats(SoftStats *s)
+{
+    *s = stats;
+}
+
+void ResetSoftStats(void)
+{
+    stats.calls = 0;
+    stats.pixels = 0;
+    stats.waits = 0;
+}
+
+UBYTE SoftPlayfieldPixel(WORD x, WORD y)
+{
+    UBYTE bit = (UBYTE)(0x80 >> (x & 7));
+    UBYTE color = 0;
+    WORD p;
+
+    for (p = 0; p < SCREEN_DEPTH; p++) {
+        if (shown[p][y][x >> 3] & bit) color |= (UBYTE)(1 << p);
+    }
+    return color;
+}
+
+UBYTE SoftScreenPixel(WORD x, WORD y)
+{
+    WORD i, row;
+
+    /* Lower numbered hardware sprites are in front: the ball first */
+    for (i = 0; i < GFX_SPRITES; i++) {
+        const SoftSprite *s = &sprites[i];
+
+        row = y - s->y;
+        if (x >= s->x && x < s->x + 8 && row >= s->gap && row < s->rows - s->gap) {
+            return s->color;
+        }
+    }
+    return SoftPlayfieldPixel(x, y);
+}
+
+ULONG SoftScreenChecksum(void)
+{
+    ULONG sum = 2166136261UL;     /* FNV-1a */
+    WORD x, y;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++) {
+        for (x = 0; x < SCREEN_WIDTH; x++) {
+            sum = (sum ^ SoftScreenPixel(x, y)) * 16777619UL;
+        }
+    }
+    return sum;
+}
+
+BOOL WriteSoftScreen(const char *name)
+{
+    FILE *fp = fopen(name, "wb");
+    WORD x, y;
+    UWORD rgb;
+    BOOL ok;
+
+    if (!fp) return FALSE;
+
+    fprintf(fp, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (y = 0; y < SCREEN_HEIGHT; y++) {
+        for (x = 0; x < SCREEN_WIDTH; x++) {
+            rgb = colors[SoftScreenPixel(x, y)];
+            fputc(((rgb >> 8) & 0xF) * 17, fp);
+            fputc(((rgb >> 4) & 0xF) * 17, fp);
+            fputc((rgb & 0xF) * 17, fp);
+        }
+    }
+    ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
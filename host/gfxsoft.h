@@ -0,0 +1,40 @@
+/*
+ * gfxsoft.h - Software drawing backend: what is on the screen
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * host/gfxsoft.c implements gfx.h into two planar bitmaps laid out as
+ * the Amiga's: SCREEN_DEPTH planes of SOFT_ROW_BYTES a row, leftmost
+ * pixel in the top bit. What is read back is the shown bitmap, so
+ * drawing appears after GfxSwap(). Sprites are not drawn into it; they
+ * are laid over it when the screen is read back, as the hardware does.
+ */
+
+#ifndef GFXSOFT_H
+#define GFXSOFT_H
+
+#include <exec/types.h>
+#include "graphics.h"
+
+#define SOFT_ROW_BYTES (SCREEN_WIDTH / 8)
+
+/* Work done by the drawing calls since the last ResetSoftStats() */
+typedef struct {
+    ULONG calls;         /* Backend drawing calls */
+    ULONG pixels;        /* Playfield pixels written (each in every plane) */
+    ULONG waits;         /* GfxWaitBeam()/GfxWaitFrame() */
+} SoftStats;
+
+void GetSoftStats(SoftStats *stats);
+void ResetSoftStats(void);
+
+/* Playfield only, and what is seen: sprites over the playfield */
+UBYTE SoftPlayfieldPixel(WORD x, WORD y);
+UBYTE SoftScreenPixel(WORD x, WORD y);
+
+/* Checksum of the screen as seen, for comparing renders */
+ULONG SoftScreenChecksum(void);
+
+/* Write the screen as seen to a binary PPM; FALSE on failure */
+BOOL WriteSoftScreen(const char *name);
+
+#endif /* GFXSOFT_H */
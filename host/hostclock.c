@@ -0,0 +1,35 @@
+/*
+ * hostclock.c - Profiler clock and vertical blank count for the native build
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * clock_gettime() in microseconds, standing in for the E clock, and a
+ * 50 Hz vertical blank count from the same clock for the overlay.
+ */
+
+#include <time.h>
+
+#include <exec/types.h>
+#include "profile.h"
+#include "timing.h"
+
+ULONG OpenProfileClock(void)
+{
+    return 1000000;
+}
+
+ULONG ReadProfileClock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ULONG)ts.tv_sec * 1000000 + (ULONG)(ts.tv_nsec / 1000);
+}
+
+void CloseProfileClock(void)
+{
+}
+
+ULONG ReadVBlankCount(void)
+{
+    return ReadProfileClock() / (1000000 / 50);
+}
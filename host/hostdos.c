@@ -0,0 +1,77 @@
+/*
+ * hostdos.c - dos.library stand-in for the native build
+ * Amiga Pong - native (non-Amiga) build support
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <exec/types.h>
+#include <dos/dos.h>
+#include <proto/dos.h>
+
+/* Drop an Amiga volume/assign prefix ("S:", "RAM:") from a path */
+static const char *HostPath(CONST_STRPTR name)
+{
+    const char *colon = strchr(name, ':');
+    return colon ? colon + 1 : name;
+}
+
+BPTR Open(CONST_STRPTR name, LONG accessMode)
+{
+    const char *mode;
+    FILE *fp;
+
+    switch (accessMode) {
+        case MODE_OLDFILE:   mode = "rb";  break;
+        case MODE_NEWFILE:   mode = "wb";  break;
+        case MODE_READWRITE: mode = "r+b"; break;
+        default: return 0;
+    }
+
+    fp = fopen(HostPath(name), mode);
+    if (!fp && accessMode == MODE_READWRITE) {
+        fp = fopen(HostPath(name), "w+b");
+    }
+    return (BPTR)fp;
+}
+
+LONG Close(BPTR file)
+{
+    if (!file) return FALSE;
+    return fclose((FILE *)file) == 0 ? TRUE : FALSE;
+}
+
+LONG Read(BPTR file, APTR buffer, LONG length)
+{
+    if (!file || length < 0) return -1;
+    return (LONG)fread(buffer, 1, (size_t)length, (FILE *)file);
+}
+
+LONG Write(BPTR file, const void *buffer, LONG length)
+{
+    size_t written;
+
+    if (!file || length < 0) return -1;
+    written = fwrite(buffer, 1, (size_t)length, (FILE *)file);
+    return (written == (size_t)length) ? (LONG)written : -1;
+}
+
+/* Returns the position before the seek, or -1, as AmigaDOS does */
+LONG Seek(BPTR file, LONG position, LONG mode)
+{
+    long old;
+    int whence;
+
+    if (!file) return -1;
+    switch (mode) {
+        case OFFSET_BEGINNING: whence = SEEK_SET; break;
+        case OFFSET_CURRENT:   whence = SEEK_CUR; break;
+        case OFFSET_END:       whence = SEEK_END; break;
+        default: return -1;
+    }
+
+    old = ftell((FILE *)file);
+    if (old < 0 || fseek((FILE *)file, (long)position, whence) != 0) return -1;
+    return (LONG)old;
+}
@@ -0,0 +1,125 @@
+/*
+ * hostlink.c - Netplay link over a pipe or socket for the native build
+ * Amiga Pong - native (non-Amiga) build support
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <exec/types.h>
+#include "hostlink.h"
+
+/* Sends held back at once; at 50 a second that is 20 s of latency */
+#define LINK_QUEUE 1024
+
+typedef struct {
+    double due;
+    LONG length;
+    UBYTE data[LINK_WRITE_SIZE];
+} Delayed;
+
+struct NetLink {
+    int in, out;
+    double latency;      /* ns */
+    BOOL failed;
+    LONG head, tail;
+    Delayed queue[LINK_QUEUE];
+};
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void WriteAll(struct NetLink *link, const UBYTE *data, LONG length)
+{
+    while (length > 0 && !link->failed) {
+        ssize_t n = write(link->out, data, (size_t)length);
+
+        if (n > 0) {
+            data += n;
+            length -= (LONG)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            struct pollfd p;
+            p.fd = link->out;
+            p.events = POLLOUT;
+            poll(&p, 1, 100);
+        } else {
+            link->failed = TRUE;
+        }
+    }
+}
+
+/* Write whatever has waited out the latency (all of it if force) */
+static void WriteDue(struct NetLink *link, BOOL force)
+{
+    double now = NowNs();
+
+    while (link->head != link->tail &&
+           (force || link->queue[link->head].due <= now)) {
+        Delayed *d = &link->queue[link->head];
+        WriteAll(link, d->data, d->length);
+        link->head = (link->head + 1) % LINK_QUEUE;
+    }
+}
+
+struct NetLink *OpenFdLink(int in, int out, LONG latencyMs)
+{
+    struct NetLink *link = (struct NetLink *)calloc(1, sizeof(struct NetLink));
+
+    if (!link) return NULL;
+    link->in = in;
+    link->out = out;
+    link->latency = latencyMs * 1e6;
+    fcntl(in, F_SETFL, fcntl(in, F_GETFL) | O_NONBLOCK);
+    return link;
+}
+
+LONG SendLink(struct NetLink *link, const UBYTE *data, LONG length)
+{
+    Delayed *d;
+
+    if (length > LINK_WRITE_SIZE) return -1;
+
+    WriteDue(link, FALSE);
+    if (link->latency <= 0.0 && link->head == link->tail) {
+        WriteAll(link, data, length);
+    } else {
+        if ((link->tail + 1) % LINK_QUEUE == link->head) return -1;
+        d = &link->queue[link->tail];
+        d->due = NowNs() + link->latency;
+        d->length = length;
+        memcpy(d->data, data, (size_t)length);
+        link->tail = (link->tail + 1) % LINK_QUEUE;
+    }
+    return link->failed ? -1 : length;
+}
+
+LONG ReceiveLink(struct NetLink *link, UBYTE *buffer, LONG size)
+{
+    ssize_t n;
+
+    WriteDue(link, FALSE);
+    if (size <= 0) return 0;
+
+    n = read(link->in, buffer, (size_t)size);
+    if (n > 0) return (LONG)n;
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+    return -1;
+}
+
+void CloseLink(struct NetLink *link)
+{
+    if (!link) return;
+    WriteDue(link, TRUE);
+    close(link->in);
+    if (link->out != link->in) close(link->out);
+    free(link);
+}
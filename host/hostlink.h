@@ -0,0 +1,20 @@
+/*
+ * hostlink.h - Netplay link over a pipe or socket for the native build
+ * Amiga Pong - native (non-Amiga) build support
+ */
+
+#ifndef HOSTLINK_H
+#define HOSTLINK_H
+
+#include <exec/types.h>
+#include "link.h"
+
+/*
+ * Link reading from one descriptor and writing to another (the same
+ * one for a socket). Bytes sent are held back latencyMs before they
+ * are written, to stand in for a slow line. The link owns the
+ * descriptors and closes them in CloseLink().
+ */
+struct NetLink *OpenFdLink(int in, int out, LONG latencyMs);
+
+#endif /* HOSTLINK_H */
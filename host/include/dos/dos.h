@@ -0,0 +1,25 @@
+/*
+ * dos/dos.h - Host stand-in for the AmigaDOS definitions
+ * Amiga Pong - native (non-Amiga) build support
+ */
+
+#ifndef DOS_DOS_H
+#define DOS_DOS_H
+
+#include <stdint.h>
+#include <exec/types.h>
+
+/* File handle - pointer sized on the host, a BCPL pointer on the Amiga */
+typedef intptr_t BPTR;
+
+/* Open() modes */
+#define MODE_OLDFILE   1005
+#define MODE_NEWFILE   1006
+#define MODE_READWRITE 1004
+
+/* Seek() modes */
+#define OFFSET_BEGINNING -1
+#define OFFSET_CURRENT    0
+#define OFFSET_END        1
+
+#endif /* DOS_DOS_H */
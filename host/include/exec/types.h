@@ -0,0 +1,37 @@
+/*
+ * exec/types.h - Host stand-in for the Amiga basic types
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Sizes match the Amiga: LONG is always 32 bits, WORD 16 bits,
+ * BOOL is a 16-bit WORD. Only what the game core needs is defined.
+ */
+
+#ifndef EXEC_TYPES_H
+#define EXEC_TYPES_H
+
+#include <stdint.h>
+
+typedef int32_t   LONG;
+typedef uint32_t  ULONG;
+typedef int16_t   WORD;
+typedef uint16_t  UWORD;
+typedef int8_t    BYTE;
+typedef uint8_t   UBYTE;
+typedef int16_t   BOOL;
+typedef void     *APTR;
+typedef char     *STRPTR;
+typedef const char *CONST_STRPTR;
+
+#define VOID void
+
+#ifndef TRUE
+#define TRUE  1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+#endif /* EXEC_TYPES_H */
@@ -0,0 +1,14 @@
+/*
+ * graphics/gfx.h - Host stand-in for graphics.library basics
+ * Amiga Pong - native (non-Amiga) build support
+ */
+
+#ifndef GRAPHICS_GFX_H
+#define GRAPHICS_GFX_H
+
+#include <exec/types.h>
+
+struct RastPort;
+struct BitMap;
+
+#endif /* GRAPHICS_GFX_H */
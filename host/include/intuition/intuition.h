@@ -0,0 +1,16 @@
+/*
+ * intuition/intuition.h - Host stand-in for Intuition
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * The game core only needs the structure names to exist.
+ */
+
+#ifndef INTUITION_INTUITION_H
+#define INTUITION_INTUITION_H
+
+#include <exec/types.h>
+
+struct Window;
+struct Screen;
+
+#endif /* INTUITION_INTUITION_H */
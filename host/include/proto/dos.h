@@ -0,0 +1,21 @@
+/*
+ * proto/dos.h - Host stand-in for the dos.library calls
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Implemented on top of stdio in host/hostdos.c. Amiga paths such
+ * as "S:pong.hiscore" are mapped to plain files in the current
+ * directory (the volume prefix is dropped).
+ */
+
+#ifndef PROTO_DOS_H
+#define PROTO_DOS_H
+
+#include <dos/dos.h>
+
+BPTR Open(CONST_STRPTR name, LONG accessMode);
+LONG Close(BPTR file);
+LONG Read(BPTR file, APTR buffer, LONG length);
+LONG Write(BPTR file, const void *buffer, LONG length);
+LONG Seek(BPTR file, LONG position, LONG mode);
+
+#endif /* PROTO_DOS_H */
@@ -0,0 +1,11 @@
+/*
+ * proto/exec.h - Host stand-in for the exec.library calls
+ * Amiga Pong - native (non-Amiga) build support
+ */
+
+#ifndef PROTO_EXEC_H
+#define PROTO_EXEC_H
+
+#include <exec/types.h>
+
+#endif /* PROTO_EXEC_H */
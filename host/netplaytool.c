@@ -0,0 +1,403 @@
+/*
+ * netplaytool.c - Rollback netplay test harness
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Plays versus matches between two scripted peers over a UNIX socket,
+ * each on its own thread running netplay.c exactly as the game does,
+ * with the link's latency simulated. After each match the inputs both
+ * peers actually used are played again straight through UpdateVersus()
+ * with no rollback: the checksum has to come out as each peer's did.
+ * Reports rollbacks, their depth, stalls and the cost of an update.
+ *
+ * Usage: pong-netplay [-n matches] [-delay frames] [-latency ms]
+ *                     [-fps n] [-s seed] [-substeps shift] [-desync frame]
+ *        pong-netplay -listen path | -connect path [options]
+ *
+ * -fps 0 (the default) runs the peers as fast as they go; -fps 50
+ * paces them like the Amiga. -desync corrupts the left peer's game at
+ * that frame; the checksums must catch it. -listen and -connect run
+ * one peer per process (left and right) over a named socket instead.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <exec/types.h>
+#include "game.h"
+#include "graphics.h"
+#include "netplay.h"
+#include "hostlink.h"
+
+/* Frames a match may run for: 30 minutes at 50 Hz */
+#define MAX_FRAMES (50L * 60 * 30)
+
+/* A peer that cannot move on for this long gives up */
+#define STALL_TIMEOUT_NS 5e9
+
+/* Scripted aim offsets: the player follows the ball but misses now and then */
+static const WORD aimPattern[16] = {
+    0, 4, -6, 10, -2, 14, -12, 6, 0, -8, 18, -4, 2, -16, 8, 24
+};
+
+typedef struct {
+    LONG matches;
+    WORD delay;
+    LONG latencyMs;
+    LONG fps;
+    ULONG seed;
+    WORD subStepShift;
+    LONG desyncAt;
+} Options;
+
+typedef struct {
+    struct NetLink *link;
+    BOOL left;
+    GameContext setup;
+    WORD delay;
+    LONG fps;
+    LONG desyncAt;       /* Frame to corrupt the game at, -1 for none */
+    NetSession session;
+    WORD *inputs;        /* Mouse Y this peer sent for each frame */
+    LONG injected;       /* Frame the corruption went in at */
+    BOOL timedOut;
+    double worstNs;
+    double totalNs;
+    LONG updates;
+} Peer;
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void SleepNs(double ns)
+{
+    struct timespec ts;
+
+    if (ns <= 0) return;
+    ts.tv_sec = (time_t)(ns / 1e9);
+    ts.tv_nsec = (long)(ns - (double)ts.tv_sec * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+/* A mouse that chases the ball, 8 pixels a frame at most */
+static WORD BotMouseY(const GameContext *g, BOOL left, LONG tick, WORD lastY)
+{
+    WORD aim = aimPattern[((tick >> 7) + (left ? 0 : 5)) & 15];
+    WORD target = (WORD)(FP_TO_INT(g->ball.y) + aim);
+
+    if (target > lastY + 8) return (WORD)(lastY + 8);
+    if (target < lastY - 8) return (WORD)(lastY - 8);
+    return target;
+}
+
+static void *RunPeer(void *arg)
+{
+    Peer *p = (Peer *)arg;
+    NetSession *s = &p->session;
+    double frameNs = p->fps > 0 ? 1e9 / p->fps : 0.0;
+    double next = NowNs(), stalledSince = 0.0, t0, cost;
+    WORD y = NET_START_Y;
+    LONG tick = 0, f;
+
+    p->injected = -1;
+    for (f = 0; f < MAX_FRAMES + NET_MAX_DELAY; f++) p->inputs[f] = NET_START_Y;
+
+    StartNetplay(s, p->link, p->left, &p->setup, p->delay);
+
+    while (!NetplayFinished(s) && s->status <= NET_RUNNING && s->frame < MAX_FRAMES) {
+        WORD mouseY = BotMouseY(&s->game, p->left, tick, y);
+
+        t0 = NowNs();
+        if (UpdateNetplay(s, mouseY)) {
+            cost = NowNs() - t0;
+            if (cost > p->worstNs) p->worstNs = cost;
+            p->totalNs += cost;
+            p->updates++;
+
+            p->inputs[s->frame - 1 + s->delay] = mouseY;
+            y = mouseY;
+            tick++;
+            stalledSince = 0.0;
+
+            /* Corrupt a frame nothing can roll back past any more */
+            if (p->desyncAt >= 0 && p->injected < 0 && s->frame >= p->desyncAt &&
+                s->confirmed == s->frame) {
+                s->game.ball.y += FP_FROM_64THS(1);
+                p->injected = s->frame;
+            }
+        } else if (s->status == NET_RUNNING) {
+            if (stalledSince == 0.0) {
+                stalledSince = t0;
+            } else if (t0 - stalledSince > STALL_TIMEOUT_NS) {
+                p->timedOut = TRUE;
+                break;
+            }
+        }
+
+        if (frameNs > 0.0) {
+            next += frameNs;
+            SleepNs(next - NowNs());
+        } else if (s->status != NET_RUNNING || stalledSince != 0.0) {
+            SleepNs(20000.0);
+        }
+    }
+
+    StopNetplay(s);
+    return NULL;
+}
+
+/* Play the inputs both peers used straight through, with no rollback */
+static ULONG Resimulate(const GameContext *setup, const WORD *left, const WORD *right,
+                        LONG frames)
+{
+    GameContext ctx = *setup;
+    ULONG sum = CHECKSUM_START;
+    LONG f;
+
+    StartMatch(&ctx);
+    for (f = 0; f < frames; f++) {
+        UpdateVersus(&ctx, left[f], right[f]);
+        sum = ChecksumGame(sum, &ctx);
+    }
+    return sum;
+}
+
+static const char *StatusName(const Peer *p)
+{
+    static const char *names[] = { "connecting", "running", "closed", "DESYNC", "FAILED" };
+
+    if (p->timedOut) return "TIMEOUT";
+    if (NetplayFinished(&p->session) && p->session.status == NET_RUNNING) return "finished";
+    return names[p->session.status];
+}
+
+static void PrintPeer(const Peer *p)
+{
+    const NetSession *s = &p->session;
+
+    printf("  %-5s %-10s frames %6ld  rollbacks %5ld (%6ld frames, max %ld)  stalls %5ld"
+           "  update %.0f ns, worst %.0f ns\n",
+           p->left ? "left" : "right", StatusName(p), (long)s->confirmed,
+           (long)s->rollbacks, (long)s->resimulated, (long)s->maxRollback, (long)s->stalls,
+           p->updates ? p->totalNs / p->updates : 0.0, p->worstNs);
+}
+
+/* Set up both peers' sessions for match number n */
+static void SetUpPeers(Peer *peers, const Options *o, LONG n)
+{
+    RandomState master;
+    int i;
+
+    SeedRandom(&master, o->seed);
+    for (i = 0; i < 2; i++) {
+        Peer *p = &peers[i];
+
+        p->left = (i == 0);
+        memset(&p->setup, 0, sizeof(p->setup));
+        if (p->left) {
+            /* Only the left peer's setup counts; the right one is told */
+            SplitRandom(&p->setup.rng, &master, (ULONG)n);
+            p->setup.difficulty = DIFFICULTY_MEDIUM;
+            p->setup.subStepShift = o->subStepShift;
+        }
+        p->delay = o->delay;
+        p->fps = o->fps;
+        p->desyncAt = p->left ? o->desyncAt : -1;
+        p->worstNs = p->totalNs = 0.0;
+        p->updates = 0;
+        p->timedOut = FALSE;
+    }
+}
+
+/* Check a peer's outcome; 0 if it is what the run expected */
+static int CheckPeer(const Peer *p, const Peer *peers, const Options *o)
+{
+    const NetSession *s = &p->session;
+    const char *side = p->left ? "left" : "right";
+
+    PrintPeer(p);
+
+    if (o->desyncAt >= 0) {
+        if (s->status != NET_DESYNC) {
+            printf("  %s peer missed the desync at frame %ld\n", side, (long)peers[0].injected);
+            return 10;
+        }
+        printf("  %s peer caught the desync at frame %ld by confirmed frame %ld\n",
+               side, (long)peers[0].injected, (long)s->desyncFrames);
+        return 0;
+    }
+    if (!NetplayFinished(s) || s->status != NET_RUNNING || p->timedOut) {
+        return 10;
+    }
+    if (peers[0].inputs && peers[1].inputs &&
+        Resimulate(&peers[0].setup, peers[0].inputs, peers[1].inputs,
+                   s->confirmed) != s->checksum) {
+        printf("  MISMATCH %s peer against a straight replay of its inputs\n", side);
+        return 10;
+    }
+    return 0;
+}
+
+/* One match between two threads; 0 if it played out in sync */
+static int PlayMatch(Peer *peers, const Options *o, LONG n)
+{
+    pthread_t threads[2];
+    int fds[2];
+    int i, rc = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return 20;
+
+    SetUpPeers(peers, o, n);
+    for (i = 0; i < 2; i++) {
+        peers[i].link = OpenFdLink(fds[i], fds[i], o->latencyMs);
+        if (!peers[i].link) return 20;
+    }
+    for (i = 0; i < 2; i++) {
+        pthread_create(&threads[i], NULL, RunPeer, &peers[i]);
+    }
+    for (i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("match %ld: %d-%d\n", (long)n,
+           peers[0].session.game.playerScore, peers[0].session.game.aiScore);
+    for (i = 0; i < 2; i++) {
+        if (CheckPeer(&peers[i], peers, o) != 0) rc = 10;
+        CloseLink(peers[i].link);
+    }
+    return rc;
+}
+
+/* One peer in this process over a named socket: left listens, right connects */
+static int PlayRemote(Peer *peers, const Options *o, const char *path, BOOL left)
+{
+    struct sockaddr_un addr;
+    Peer *p = &peers[left ? 0 : 1];
+    double until;
+    int fd, conn;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return 20;
+    if (left) {
+        unlink(path);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+            perror(path);
+            return 20;
+        }
+        conn = accept(fd, NULL, NULL);
+        close(fd);
+        unlink(path);
+    } else {
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            perror(path);
+            return 20;
+        }
+        conn = fd;
+    }
+    if (conn < 0) return 20;
+
+    SetUpPeers(peers, o, 0);
+    p->link = OpenFdLink(conn, conn, o->latencyMs);
+    if (!p->link) return 20;
+
+    /* The peer's inputs are in the other process: no straight replay here */
+    peers[left ? 1 : 0].inputs = NULL;
+    RunPeer(p);
+    printf("match: %d-%d, checksum %08lx over %ld frames, peer agreed on %ld\n",
+           p->session.game.playerScore, p->session.game.aiScore,
+           (unsigned long)p->session.checksum, (long)p->session.confirmed,
+           (long)p->session.checkedFrames);
+
+    /* Hear the peer out before closing, so its last packets still go through */
+    until = NowNs() + 2e9;
+    while (!p->session.peerDone && p->session.status == NET_RUNNING && NowNs() < until) {
+        UpdateNetplay(&p->session, NET_START_Y);
+        SleepNs(1e6);
+    }
+    CloseLink(p->link);
+    return CheckPeer(p, peers, o);
+}
+
+int main(int argc, char **argv)
+{
+    static Peer peers[2];
+    Options o;
+    const char *path = NULL;
+    BOOL listening = FALSE;
+    LONG n, failures = 0;
+    int i;
+
+    o.matches = 4;
+    o.delay = NET_DELAY;
+    o.latencyMs = 0;
+    o.fps = 0;
+    o.seed = RANDOM_DEFAULT_SEED;
+    o.subStepShift = 0;
+    o.desyncAt = -1;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            o.matches = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-delay") == 0 && i + 1 < argc) {
+            o.delay = (WORD)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-latency") == 0 && i + 1 < argc) {
+            o.latencyMs = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-fps") == 0 && i + 1 < argc) {
+            o.fps = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            o.seed = (ULONG)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-substeps") == 0 && i + 1 < argc) {
+            o.subStepShift = (WORD)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-desync") == 0 && i + 1 < argc) {
+            o.desyncAt = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-listen") == 0 && i + 1 < argc) {
+            path = argv[++i];
+            listening = TRUE;
+        } else if (strcmp(argv[i], "-connect") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [-n matches] [-delay frames] [-latency ms] [-fps n]\n"
+                            "       [-s seed] [-substeps shift] [-desync frame]\n"
+                            "       [-listen path | -connect path]\n", argv[0]);
+            return 20;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    for (i = 0; i < 2; i++) {
+        peers[i].inputs = (WORD *)malloc((MAX_FRAMES + NET_MAX_DELAY) * sizeof(WORD));
+        if (!peers[i].inputs) return 20;
+    }
+
+    printf("delay %d frames, latency %ld ms, %s, rollback up to %d frames\n",
+           o.delay, (long)o.latencyMs, o.fps > 0 ? "paced" : "unpaced", NET_MAX_ROLLBACK);
+
+    if (path) {
+        return PlayRemote(peers, &o, path, listening);
+    }
+
+    for (n = 0; n < o.matches; n++) {
+        if (PlayMatch(peers, &o, n) != 0) failures++;
+    }
+    if (failures) {
+        printf("%ld of %ld matches FAILED\n", (long)failures, (long)o.matches);
+        return 10;
+    }
+    printf("%ld matches %s\n", (long)o.matches,
+           o.desyncAt >= 0 ? "caught the desync" : "in sync");
+    return 0;
+}
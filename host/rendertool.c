@@ -0,0 +1,338 @@
+/*
+ * rendertool.c - Draws the game's screens with the software backend
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Runs graphics.c on host/gfxsoft.c: each screen is drawn the way
+ * pong.c draws it, then read back with the sprites laid over the
+ * playfield. For each screen it prints a checksum of what is seen, the
+ * drawing calls and pixels it took and the pixels in the merged dirty
+ * list (what the Amiga repaints), then plays one match drawing
+ * every step, as a game frame would, and reports the pixels drawn per
+ * frame.
+ *
+ * -o dir writes every screen as a PPM image. -check file compares the
+ * checksums with a file this tool printed before, so a change to the
+ * drawing code can be checked screen by screen:
+ *
+ *   pong-render > golden.txt
+ *   (change graphics.c)
+ *   pong-render -check golden.txt
+ *
+ * -bench times each screen and every frame of the match.
+ *
+ * Usage: pong-render [-o dir] [-check file] [-bench]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <exec/types.h>
+#include "game.h"
+#include "graphics.h"
+#include "highscore.h"
+#include "host/gfxsoft.h"
+
+#define BENCH_ROUNDS 2000
+#define MAX_SCREENS  16
+#define MATCH_SEED   7
+
+static double NowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* The match the playfield screens show */
+static GameContext game;
+
+/* Mouse for the next step: follow the ball, missing now and then */
+static WORD MatchMouseY(LONG step)
+{
+    static const WORD aim[8] = { 0, 6, -10, 14, -4, 20, -18, 28 };
+    return (WORD)(FP_TO_INT(game.ball.y) + aim[(step >> 7) & 7]);
+}
+
+/* One frame of play as pong.c draws it */
+static void DrawPlayFrame(void)
+{
+    UpdateGameGraphics(FP_TO_INT(game.ball.x), FP_TO_INT(game.ball.y),
+                       game.playerPaddle.y, game.aiPaddle.y,
+                       game.playerScore, game.aiScore);
+}
+
+static void DrawTitle(void)
+{
+    ClearDisplay();
+    DrawTitleScreen();
+}
+
+static void DrawServe(void)
+{
+    RequestFullRedraw();
+    DrawPlayFrame();
+}
+
+/* Pause text over the play screen; the resumed screen must be the play one */
+static void DrawPaused(void)
+{
+    DrawPlayFrame();
+    ShowPauseOverlay();
+}
+
+static void DrawResumed(void)
+{
+    HidePauseOverlay();
+    DrawPlayFrame();
+}
+
+static void DrawOverlay(void)
+{
+    static const UWORD bars[PERF_HUD_BARS] = { 3, 12, 41, 44 };
+
+    DrawPlayFrame();
+    DrawPerfHud(bars, 17);
+}
+
+static void DrawGameOverScreen(void)
+{
+    DrawCourt();
+    DrawScore(game.playerScore, game.aiScore);
+    DrawGameOver(PlayerWon(&game));
+}
+
+/* High score entry as pong.c draws it, with the name typed so far */
+static char entryName[NAME_LENGTH + 1];
+static BOOL cursorOn;
+
+static void DrawNameLine(void)
+{
+    char shown[NAME_LENGTH + 1];
+    WORD i, pos = (WORD)strlen(entryName);
+
+    for (i = 0; i < NAME_LENGTH; i++) {
+        shown[i] = i < pos ? entryName[i] : (i == pos && cursorOn ? '_' : '.');
+    }
+    shown[NAME_LENGTH] = '\0';
+    DrawText(128, 120, shown, COLOR_CYAN);
+}
+
+static void DrawEntry(void)
+{
+    entryName[0] = '\0';
+    cursorOn = TRUE;
+    ClearDisplay();
+    DrawText(100, 60, "NEW HIGH SCORE!", COLOR_YELLOW);
+    DrawText(96, 90, "Enter your name:", COLOR_WHITE);
+    DrawNameLine();
+    DrawText(84, 170, "Press ENTER to save", COLOR_WHITE);
+}
+
+/* After that only the name line: one key, then the cursor blinking off */
+static void DrawTyped(void)
+{
+    strcpy(entryName, "A");
+    DrawNameLine();
+}
+
+static void DrawBlink(void)
+{
+    cursorOn = FALSE;
+    DrawNameLine();
+}
+
+typedef struct {
+    const char *name;
+    void (*draw)(void);
+    LONG points;         /* Play on until this many points have been scored */
+} Screen;
+
+static const Screen screens[] = {
+    { "title",    DrawTitle,          0 },
+    { "serve",    DrawServe,          0 },
+    { "rally",    DrawPlayFrame,      1 },
+    { "play",     DrawPlayFrame,      3 },
+    { "paused",   DrawPaused,         3 },
+    { "resumed",  DrawResumed,        3 },
+    { "overlay",  DrawOverlay,        3 },
+    { "gameover", DrawGameOverScreen, 99 },
+    { "entry",    DrawEntry,          99 },
+    { "typed",    DrawTyped,          99 },
+    { "blink",    DrawBlink,          99 }
+};
+#define SCREEN_COUNT ((LONG)(sizeof(screens) / sizeof(screens[0])))
+
+/* Play until the given number of points (or the end), drawing each step */
+static void PlayTo(LONG points, LONG *step)
+{
+    while (game.state == STATE_PLAYING && game.playerScore + game.aiScore < points) {
+        UpdateGame(&game, MatchMouseY(*step));
+        DrawPlayFrame();
+        FlushDisplay();
+        (*step)++;
+    }
+}
+
+static void StartRenderMatch(void)
+{
+    InitGame(&game);
+    SetRandomSeed(&game, MATCH_SEED);
+    game.difficulty = DIFFICULTY_MEDIUM;
+    StartMatch(&game);
+}
+
+/* Checksums from an earlier run: "name checksum ..." lines */
+static LONG ReadGolden(const char *path, char names[][32], ULONG *sums)
+{
+    FILE *fp = fopen(path, "r");
+    char line[128];
+    LONG n = 0;
+    unsigned long sum;
+
+    if (!fp) return -1;
+    while (n < MAX_SCREENS && fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "%31s %lx", names[n], &sum) == 2) {
+            sums[n++] = (ULONG)sum;
+        }
+    }
+    fclose(fp);
+    return n;
+}
+
+static int RenderScreens(const char *outDir, const char *goldenPath, BOOL bench)
+{
+    static char goldenNames[MAX_SCREENS][32];
+    static ULONG goldenSums[MAX_SCREENS];
+    LONG golden = 0, i, g, step = 0, mismatches = 0;
+    SoftStats stats;
+    ULONG sum;
+    double start;
+    char path[512];
+
+    if (goldenPath && (golden = ReadGolden(goldenPath, goldenNames, goldenSums)) < 0) {
+        fprintf(stderr, "cannot read %s\n", goldenPath);
+        return 10;
+    }
+
+    StartRenderMatch();
+    for (i = 0; i < SCREEN_COUNT; i++) {
+        const Screen *s = &screens[i];
+
+        PlayTo(s->points, &step);
+
+        ResetSoftStats();
+        s->draw();
+        FlushDisplay();
+        GetSoftStats(&stats);
+        sum = SoftScreenChecksum();
+
+        printf("%-10s %08lx  %5lu calls %6lu pixels %6lu dirty", s->name, (unsigned long)sum,
+               (unsigned long)stats.calls, (unsigned long)stats.pixels,
+               (unsigned long)GetFramePixels());
+
+        if (bench) {
+            start = NowNs();
+            for (g = 0; g < BENCH_ROUNDS; g++) {
+                s->draw();
+                FlushDisplay();
+            }
+            printf("  %8.0f ns", (NowNs() - start) / BENCH_ROUNDS);
+        }
+
+        for (g = 0; g < golden; g++) {
+            if (strcmp(goldenNames[g], s->name) == 0) break;
+        }
+        if (golden > 0 && (g == golden || goldenSums[g] != sum)) {
+            printf("  CHANGED");
+            mismatches++;
+        }
+        printf("\n");
+
+        if (outDir) {
+            snprintf(path, sizeof(path), "%s/%s.ppm", outDir, s->name);
+            if (!WriteSoftScreen(path)) {
+                fprintf(stderr, "cannot write %s\n", path);
+                return 10;
+            }
+        }
+    }
+
+    if (golden > 0) {
+        printf("%ld of %ld screens changed\n", (long)mismatches, (long)SCREEN_COUNT);
+    }
+    return mismatches > 0 ? 5 : 0;
+}
+
+/* One match drawn a step at a time: what a frame of play costs */
+static void RenderMatch(BOOL bench)
+{
+    LONG step = 0;
+    ULONG pixels = 0, worst = 0, worstCalls = 0;
+    double total = 0, slowest = 0, t;
+    SoftStats stats;
+
+    StartRenderMatch();
+    RequestFullRedraw();
+    DrawPlayFrame();
+    FlushDisplay();
+
+    while (game.state == STATE_PLAYING) {
+        UpdateGame(&game, MatchMouseY(step));
+
+        ResetSoftStats();
+        t = NowNs();
+        DrawPlayFrame();
+        FlushDisplay();
+        t = NowNs() - t;
+        GetSoftStats(&stats);
+
+        pixels += stats.pixels;
+        if (stats.pixels > worst) worst = stats.pixels;
+        if (stats.calls > worstCalls) worstCalls = stats.calls;
+        total += t;
+        if (t > slowest) slowest = t;
+        step++;
+    }
+
+    printf("match:     %ld frames, %d-%d, %.1f pixels/frame, worst frame %lu pixels %lu calls\n",
+           (long)step, game.playerScore, game.aiScore, (double)pixels / step,
+           (unsigned long)worst, (unsigned long)worstCalls);
+    if (bench) {
+        printf("frame:     %.0f ns mean, %.0f ns worst\n", total / step, slowest);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *outDir = NULL;
+    const char *goldenPath = NULL;
+    BOOL bench = FALSE;
+    int i, rc;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (strcmp(argv[i], "-check") == 0 && i + 1 < argc) {
+            goldenPath = argv[++i];
+        } else if (strcmp(argv[i], "-bench") == 0) {
+            bench = TRUE;
+        } else {
+            fprintf(stderr, "usage: %s [-o dir] [-check file] [-bench]\n", argv[0]);
+            return 10;
+        }
+    }
+
+    if (!InitGraphics()) {
+        fprintf(stderr, "no display\n");
+        return 10;
+    }
+
+    rc = RenderScreens(outDir, goldenPath, bench);
+    RenderMatch(bench);
+
+    CleanupGraphics();
+    return rc;
+}
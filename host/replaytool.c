@@ -0,0 +1,445 @@
+/*
+ * replaytool.c - Headless replay recorder, player and checker
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Plays replay files (replay.h) through UpdateGame() as fast as the
+ * CPU allows, spread over all CPUs by the work-stealing pool, and
+ * keeps a rolling ChecksumGame() of every step. For each replay it
+ * prints the step count, final score and final checksum; -o also
+ * writes every step's checksum to a trace file.
+ *
+ * Two builds are compared by playing the same replays with each and
+ * diffing the traces: -diff reports, per replay, the first step at
+ * which the two disagree. pong-replay16 is this tool built with
+ * PONG_FIXED16, so
+ *
+ *   pong-replay -o a.trace corpus/0*.replay
+ *   pong-replay16 -o b.trace corpus/0*.replay
+ *   pong-replay -diff a.trace b.trace
+ *
+ * checks the two fixed-point formats play every match the same.
+ *
+ * -seek n checks the keyframe index: after playing each replay from
+ * the start it seeks to n random steps with SeekReplay(), compares the
+ * state reached with the one the full playback passed through, and
+ * reports the mean and worst seek time.
+ *
+ * -record writes a corpus to play: sessions with an AI bot on the
+ * mouse, on RNG streams split off the seed, at each difficulty in turn,
+ * each cut off after -steps steps (30 minutes' worth by default).
+ *
+ * Usage: pong-replay [-t threads] [-o trace] [-seek n] replay...
+ *        pong-replay -record dir [-n sessions] [-s seed] [-steps n]
+ *        pong-replay -diff trace trace
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <exec/types.h>
+#include "game.h"
+#include "graphics.h"
+#include "input.h"
+#include "replay.h"
+#include "workpool.h"
+
+#define TRACE_MAGIC "PTRC"
+
+/* A recorded session still running after 30 minutes of play is cut off */
+#define MAX_SESSION_STEPS (50L * 60 * 30)
+
+static double NowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* One replay's playback */
+typedef struct {
+    const char *name;
+    BOOL ok;             /* Opened and read as a replay */
+    LONG steps;
+    WORD playerScore;
+    WORD aiScore;
+    ULONG *sums;         /* Checksum after each step */
+    LONG seekFails;      /* Seeks that reached the wrong state */
+    double seekNs;       /* Total and worst seek time */
+    double seekMaxNs;
+} Playback;
+
+typedef struct {
+    Playback *runs;
+    LONG seeks;          /* Random seeks to check per replay */
+} Player;
+
+/* Seek to random steps and check each lands on the state played through */
+static void CheckSeeks(Player *p, Playback *run, ReplayReader *reader, const ULONG *states)
+{
+    GameContext ctx;
+    RandomState rng;
+    LONG i;
+
+    SeedRandom(&rng, (ULONG)run->steps);
+    for (i = 0; i < p->seeks; i++) {
+        LONG step = (LONG)(((ULONG)NextRandom(&rng, 32767) << 15 | NextRandom(&rng, 32767)) %
+                           (ULONG)(run->steps + 1));
+        double t0 = NowNs(), ns;
+        LONG reached;
+
+        memset(&ctx, 0, sizeof(ctx));
+        reached = SeekReplay(reader, &ctx, step);
+        ns = NowNs() - t0;
+
+        run->seekNs += ns;
+        if (ns > run->seekMaxNs) run->seekMaxNs = ns;
+        if (reached != step || ChecksumGame(CHECKSUM_START, &ctx) != states[step]) {
+            run->seekFails++;
+        }
+    }
+}
+
+static void PlayJob(void *userData, LONG job)
+{
+    Player *p = (Player *)userData;
+    Playback *run = &p->runs[job];
+    ReplayReader reader;
+    ReplayHeader header;
+    GameContext ctx;
+    LONG capacity = 4096;
+    ULONG sum = CHECKSUM_START;
+    ULONG *states = NULL;    /* State checksum before each step, for -seek */
+    WORD mouseY;
+    UBYTE events;
+
+    run->ok = OpenReplayReader(&reader, run->name, &header);
+    if (!run->ok) return;
+
+    run->sums = (ULONG *)malloc((size_t)capacity * sizeof(ULONG));
+    if (p->seeks > 0) states = (ULONG *)malloc((size_t)(capacity + 1) * sizeof(ULONG));
+
+    memset(&ctx, 0, sizeof(ctx));
+    StartReplay(&ctx, &header);
+
+    while (run->sums && ReadReplayStep(&reader, &mouseY, &events)) {
+        if (run->steps == capacity) {
+            capacity *= 2;
+            run->sums = (ULONG *)realloc(run->sums, (size_t)capacity * sizeof(ULONG));
+            if (states) states = (ULONG *)realloc(states, (size_t)(capacity + 1) * sizeof(ULONG));
+            if (!run->sums || (p->seeks > 0 && !states)) break;
+        }
+        if (states) states[run->steps] = ChecksumGame(CHECKSUM_START, &ctx);
+
+        UpdateGame(&ctx, mouseY);
+        sum = ChecksumGame(sum, &ctx);
+        run->sums[run->steps++] = sum;
+    }
+
+    run->ok = (run->sums != NULL) && (p->seeks == 0 || states != NULL);
+    if (run->ok && states) {
+        states[run->steps] = ChecksumGame(CHECKSUM_START, &ctx);
+        CheckSeeks(p, run, &reader, states);
+    }
+    CloseReplayReader(&reader);
+    free(states);
+
+    run->playerScore = ctx.playerScore;
+    run->aiScore = ctx.aiScore;
+}
+
+static void PutLong(FILE *fp, ULONG v)
+{
+    fputc((int)(v >> 24) & 0xFF, fp);
+    fputc((int)(v >> 16) & 0xFF, fp);
+    fputc((int)(v >> 8) & 0xFF, fp);
+    fputc((int)v & 0xFF, fp);
+}
+
+static BOOL GetLong(FILE *fp, ULONG *v)
+{
+    UBYTE b[4];
+
+    if (fread(b, 1, 4, fp) != 4) return FALSE;
+    *v = ((ULONG)b[0] << 24) | ((ULONG)b[1] << 16) | ((ULONG)b[2] << 8) | b[3];
+    return TRUE;
+}
+
+/*
+ * Trace file: "PTRC", the replay count, then per replay its name
+ * length, name, step count and every step's checksum, all big-endian
+ */
+static BOOL WriteTrace(const char *path, const Playback *runs, LONG count)
+{
+    FILE *fp = fopen(path, "wb");
+    LONG i, s;
+
+    if (!fp) return FALSE;
+
+    fwrite(TRACE_MAGIC, 1, 4, fp);
+    PutLong(fp, (ULONG)count);
+    for (i = 0; i < count; i++) {
+        ULONG len = (ULONG)strlen(runs[i].name);
+
+        PutLong(fp, len);
+        fwrite(runs[i].name, 1, len, fp);
+        PutLong(fp, (ULONG)runs[i].steps);
+        for (s = 0; s < runs[i].steps; s++) {
+            PutLong(fp, runs[i].sums[s]);
+        }
+    }
+    return fclose(fp) == 0;
+}
+
+static int PlayReplays(char **names, LONG count, LONG threads, LONG seeks,
+                       const char *tracePath)
+{
+    Player p;
+    LONG i, bad = 0, seekFails = 0;
+    double steps = 0.0, seconds, seekNs = 0.0, seekMaxNs = 0.0;
+    struct timespec t0, t1;
+
+    p.runs = (Playback *)calloc((size_t)count, sizeof(Playback));
+    if (!p.runs) return 20;
+    p.seeks = seeks;
+    for (i = 0; i < count; i++) p.runs[i].name = names[i];
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    RunWorkPool(count, threads, PlayJob, &p);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    for (i = 0; i < count; i++) {
+        const Playback *run = &p.runs[i];
+
+        if (!run->ok) {
+            printf("%s: not a replay\n", run->name);
+            bad++;
+            continue;
+        }
+        printf("%s: %ld steps, %d-%d, checksum %08lx\n", run->name, (long)run->steps,
+               run->playerScore, run->aiScore,
+               (unsigned long)(run->steps ? run->sums[run->steps - 1] : CHECKSUM_START));
+        steps += run->steps;
+        seekFails += run->seekFails;
+        seekNs += run->seekNs;
+        if (run->seekMaxNs > seekMaxNs) seekMaxNs = run->seekMaxNs;
+    }
+    printf("\n%ld replays on %ld threads in %.2fs (%.0f steps/s)\n",
+           (long)count, (long)threads, seconds, steps / seconds);
+
+    if (seeks > 0) {
+        printf("seek: %ld seeks, %ld to the wrong state, mean %.1f us, worst %.1f us; "
+               "from the start they would simulate %.0f steps on average\n",
+               (long)(seeks * count), (long)seekFails, seekNs / (seeks * count) / 1e3,
+               seekMaxNs / 1e3, steps / count / 2);
+        if (seekFails) bad++;
+    }
+
+    if (tracePath && !WriteTrace(tracePath, p.runs, count)) {
+        fprintf(stderr, "cannot write %s\n", tracePath);
+        bad++;
+    }
+
+    for (i = 0; i < count; i++) free(p.runs[i].sums);
+    free(p.runs);
+    return bad ? 5 : 0;
+}
+
+static FILE *OpenTrace(const char *path, ULONG *count)
+{
+    FILE *fp = fopen(path, "rb");
+    char magic[4];
+
+    if (!fp) return NULL;
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, TRACE_MAGIC, 4) != 0 ||
+        !GetLong(fp, count)) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+/* Next replay's name and step count in a trace; its checksums follow */
+static BOOL NextTraceEntry(FILE *fp, char *name, ULONG nameSize, ULONG *steps)
+{
+    ULONG len;
+
+    if (!GetLong(fp, &len) || len >= nameSize) return FALSE;
+    if (fread(name, 1, len, fp) != len) return FALSE;
+    name[len] = '\0';
+    return GetLong(fp, steps);
+}
+
+static int DiffTraces(const char *pathA, const char *pathB)
+{
+    FILE *a, *b;
+    ULONG countA, countB, i;
+    LONG diverged = 0;
+
+    a = OpenTrace(pathA, &countA);
+    b = OpenTrace(pathB, &countB);
+    if (!a || !b) {
+        fprintf(stderr, "cannot read %s\n", a ? pathB : pathA);
+        return 10;
+    }
+    if (countA != countB) {
+        printf("%s has %lu replays, %s has %lu; comparing the first %lu\n",
+               pathA, (unsigned long)countA, pathB, (unsigned long)countB,
+               (unsigned long)(countA < countB ? countA : countB));
+    }
+
+    for (i = 0; i < countA && i < countB; i++) {
+        char nameA[1024], nameB[1024];
+        ULONG stepsA, stepsB, s, sumA = 0, sumB = 0;
+        BOOL reported = FALSE;
+
+        if (!NextTraceEntry(a, nameA, sizeof(nameA), &stepsA) ||
+            !NextTraceEntry(b, nameB, sizeof(nameB), &stepsB)) {
+            fprintf(stderr, "trace truncated at replay %lu\n", (unsigned long)i);
+            return 10;
+        }
+
+        /* Read both in step, so the next entries line up */
+        for (s = 0; s < stepsA || s < stepsB; s++) {
+            if (s < stepsA && !GetLong(a, &sumA)) return 10;
+            if (s < stepsB && !GetLong(b, &sumB)) return 10;
+            if (!reported && s < stepsA && s < stepsB && sumA != sumB) {
+                printf("%s: diverges at step %lu (%08lx vs %08lx)\n",
+                       nameA, (unsigned long)s, (unsigned long)sumA, (unsigned long)sumB);
+                reported = TRUE;
+            }
+        }
+        if (!reported && stepsA != stepsB) {
+            printf("%s: %lu steps vs %lu\n", nameA, (unsigned long)stepsA, (unsigned long)stepsB);
+            reported = TRUE;
+        }
+        if (strcmp(nameA, nameB) != 0) {
+            printf("%s: compared against %s\n", nameA, nameB);
+        }
+        if (reported) diverged++;
+    }
+
+    fclose(a);
+    fclose(b);
+
+    printf("%ld of %lu replays diverge\n", (long)diverged,
+           (unsigned long)(countA < countB ? countA : countB));
+    return diverged ? 5 : 0;
+}
+
+/* One bot-driven session recorded to path; FALSE if it cannot be written */
+static BOOL RecordSession(const char *path, const RandomState *rng, Difficulty diff,
+                          const AISettings *botAI, LONG maxSteps)
+{
+    static ReplayWriter writer;
+    ReplayHeader header;
+    GameContext ctx, shadow;
+    Paddle bot;
+    WORD botTimer = botAI->reactionDelay;
+    LONG step;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.rng = *rng;
+    ctx.difficulty = diff;
+    GetReplayHeader(&ctx, &header);
+    if (!OpenReplayWriter(&writer, path, &header)) return FALSE;
+    StartMatch(&ctx);
+
+    /* The bot predicts and errs on a context of its own, so its draws
+       stay out of the match's RNG and the replay plays back without it */
+    shadow = ctx;
+    JumpRandom(&shadow.rng, (RandomState)1 << (RANDOM_STREAM_BITS - 1));
+    bot = ctx.playerPaddle;
+
+    for (step = 0; step < maxSteps && ctx.state == STATE_PLAYING; step++) {
+        LONG vx = ctx.ball.vx;
+        LONG vy = ctx.ball.vy;
+        WORD points = ctx.playerScore + ctx.aiScore;
+        WORD mouseY;
+
+        shadow.ball = ctx.ball;
+        UpdateAIPaddle(&shadow, &bot, &botTimer, botAI, FALSE);
+
+        /* Now and then a little hand jitter on the mouse */
+        mouseY = bot.y;
+        if (NextRandom(&shadow.rng, 8) == 0) mouseY += NextRandom(&shadow.rng, 5) - 2;
+
+        RecordReplayStep(&writer, &ctx, mouseY);
+        UpdateGame(&ctx, mouseY);
+
+        if (ctx.ball.vx != vx || ctx.ball.vy != vy ||
+            ctx.playerScore + ctx.aiScore != points) {
+            ScheduleAIReaction(&botTimer, botAI);
+        }
+    }
+
+    return CloseReplayWriter(&writer);
+}
+
+static int RecordCorpus(const char *dir, LONG sessions, ULONG seed, LONG maxSteps)
+{
+    RandomState master, rng;
+    LONG i;
+
+    SeedRandom(&master, seed);
+    for (i = 0; i < sessions; i++) {
+        char path[1024];
+
+        snprintf(path, sizeof(path), "%s/%05ld.replay", dir, (long)i);
+        SplitRandom(&rng, &master, (ULONG)i);
+        if (!RecordSession(path, &rng, (Difficulty)(i % 3), &difficultySettings[(i / 3) % 3],
+                           maxSteps)) {
+            fprintf(stderr, "cannot write %s\n", path);
+            return 10;
+        }
+    }
+    printf("%ld sessions recorded in %s, seed %lu\n", (long)sessions, dir, (unsigned long)seed);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *tracePath = NULL;
+    const char *recordDir = NULL;
+    LONG threads = 0, sessions = 100, seeks = 0, maxSteps = MAX_SESSION_STEPS;
+    ULONG seed = RANDOM_DEFAULT_SEED;
+    LONG i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "-record") == 0 && i + 1 < argc) {
+            recordDir = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            sessions = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-seek") == 0 && i + 1 < argc) {
+            seeks = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-steps") == 0 && i + 1 < argc) {
+            maxSteps = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = (ULONG)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-diff") == 0 && i + 2 < argc) {
+            return DiffTraces(argv[i + 1], argv[i + 2]);
+        } else {
+            break;
+        }
+    }
+
+    if (recordDir) {
+        return RecordCorpus(recordDir, sessions, seed, maxSteps);
+    }
+    if (i >= argc) {
+        fprintf(stderr, "usage: %s [-t threads] [-o trace] [-seek n] replay...\n"
+                "       %s -record dir [-n sessions] [-s seed] [-steps n]\n"
+                "       %s -diff trace trace\n", argv[0], argv[0], argv[0]);
+        return 10;
+    }
+    if (threads <= 0) threads = CountCPUs();
+
+    return PlayReplays(&argv[i], argc - i, threads, seeks, tracePath);
+}
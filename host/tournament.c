@@ -0,0 +1,295 @@
+/*
+ * tournament.c - AI-vs-AI tournament runner
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Plays every pairing of the difficulty presets (plus any custom
+ * AI settings) against each other, with the computer driving both
+ * paddles, and reports win rates, mean rally length and the top
+ * ball speed reached per matchup. Matches are spread over all CPUs
+ * by the work-stealing pool. Each match plays on its own RNG stream,
+ * split off the master seed by matchup and match number, so the
+ * results are the same for any thread count and any one match can
+ * be replayed on its own with -match. -substeps moves the ball in
+ * 1 << shift steps a frame, as the game can.
+ *
+ * Usage: pong-tournament [-n matches] [-t threads] [-s seed]
+ *                        [-custom speed,error,delay]...
+ *                        [-match matchup,number] [-substeps shift]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <exec/types.h>
+#include "game.h"
+#include "graphics.h"
+#include "workpool.h"
+
+#define MAX_ENTRANTS    8
+#define MATCHES_PER_JOB 16
+
+/* A match still running after 30 minutes of play is called off */
+#define MAX_MATCH_TICKS (50L * 60 * 30)
+
+typedef struct {
+    char name[16];
+    AISettings ai;
+} Entrant;
+
+/* Totals for one job (a run of matches in one matchup) */
+typedef struct {
+    LONG leftWins;
+    LONG rightWins;
+    LONG timeouts;
+    LONG points;
+    LONG rallyHits;   /* Paddle hits summed over all points */
+    LONG maxSpeed;    /* Fastest |vx| seen, fixed-point */
+    double ticks;
+} MatchStats;
+
+typedef struct {
+    Entrant entrants[MAX_ENTRANTS];
+    LONG entrantCount;
+    LONG matchesPerMatchup;
+    LONG jobsPerMatchup;
+    ULONG masterSeed;
+    WORD subStepShift;
+    RandomState master;
+    MatchStats *results;   /* One per job */
+} Tournament;
+
+/* RNG stream of one match: streams are numbered matchup-major */
+static void MatchStream(const Tournament *t, LONG matchup, LONG match, RandomState *rng)
+{
+    SplitRandom(rng, &t->master, (ULONG)(matchup * t->matchesPerMatchup + match));
+}
+
+/* Play one match; ctx holds the final state */
+static void PlayMatch(const AISettings *left, const AISettings *right,
+                      const RandomState *rng, WORD subStepShift,
+                      GameContext *ctx, MatchStats *stats)
+{
+    Paddle bot;
+    WORD botTimer = left->reactionDelay;
+    LONG tick;
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->rng = *rng;
+    ctx->subStepShift = subStepShift;
+    InitGame(ctx);
+    ctx->ai = *right;
+    ctx->aiUpdateTimer = right->reactionDelay;
+    ctx->state = STATE_PLAYING;
+    bot = ctx->playerPaddle;
+
+    for (tick = 0; tick < MAX_MATCH_TICKS && ctx->state == STATE_PLAYING; tick++) {
+        LONG vx = ctx->ball.vx;
+        LONG vy = ctx->ball.vy;
+        WORD rallies = ctx->rallies;
+        WORD points = ctx->playerScore + ctx->aiScore;
+        LONG speed;
+
+        /* The player side is an AI too, fed in through the mouse */
+        UpdateAIPaddle(ctx, &bot, &botTimer, left, FALSE);
+        UpdateGame(ctx, bot.y);
+
+        if (ctx->playerScore + ctx->aiScore != points) {
+            stats->rallyHits += rallies;
+            ScheduleAIReaction(&botTimer, left);
+        } else if (ctx->ball.vx != vx || ctx->ball.vy != vy) {
+            /* Bounce or return: left reacts to it, as the AI does */
+            ScheduleAIReaction(&botTimer, left);
+        }
+
+        speed = (ctx->ball.vx < 0) ? -ctx->ball.vx : ctx->ball.vx;
+        if (speed > stats->maxSpeed) stats->maxSpeed = speed;
+    }
+
+    stats->ticks += tick;
+    stats->points += ctx->playerScore + ctx->aiScore;
+    if (ctx->state == STATE_PLAYING) {
+        stats->timeouts++;
+    } else if (PlayerWon(ctx)) {
+        stats->leftWins++;
+    } else {
+        stats->rightWins++;
+    }
+}
+
+static void RunJob(void *userData, LONG job)
+{
+    Tournament *t = (Tournament *)userData;
+    LONG matchup = job / t->jobsPerMatchup;
+    LONG first = (job % t->jobsPerMatchup) * MATCHES_PER_JOB;
+    LONG last = first + MATCHES_PER_JOB;
+    const Entrant *left = &t->entrants[matchup / t->entrantCount];
+    const Entrant *right = &t->entrants[matchup % t->entrantCount];
+    MatchStats *stats = &t->results[job];
+    GameContext ctx;
+    RandomState rng;
+    LONG m;
+
+    if (last > t->matchesPerMatchup) last = t->matchesPerMatchup;
+
+    memset(stats, 0, sizeof(*stats));
+    for (m = first; m < last; m++) {
+        MatchStream(t, matchup, m, &rng);
+        PlayMatch(&left->ai, &right->ai, &rng, t->subStepShift, &ctx, stats);
+    }
+}
+
+static void AddEntrant(Tournament *t, const char *name, const AISettings *ai)
+{
+    Entrant *e;
+
+    if (t->entrantCount >= MAX_ENTRANTS) return;
+    e = &t->entrants[t->entrantCount++];
+    snprintf(e->name, sizeof(e->name), "%s", name);
+    e->ai = *ai;
+}
+
+static void PrintResults(const Tournament *t)
+{
+    LONG matchups = t->entrantCount * t->entrantCount;
+    LONG mu, j;
+
+    printf("%-8s %-8s %8s %7s %7s %6s %9s %9s\n",
+           "left", "right", "matches", "left%", "right%", "drawn", "rally", "maxspeed");
+
+    for (mu = 0; mu < matchups; mu++) {
+        MatchStats sum;
+        const MatchStats *r = &t->results[mu * t->jobsPerMatchup];
+        double n = (double)t->matchesPerMatchup;
+
+        memset(&sum, 0, sizeof(sum));
+        for (j = 0; j < t->jobsPerMatchup; j++) {
+            sum.leftWins += r[j].leftWins;
+            sum.rightWins += r[j].rightWins;
+            sum.timeouts += r[j].timeouts;
+            sum.points += r[j].points;
+            sum.rallyHits += r[j].rallyHits;
+            if (r[j].maxSpeed > sum.maxSpeed) sum.maxSpeed = r[j].maxSpeed;
+        }
+
+        printf("%-8s %-8s %8ld %6.1f%% %6.1f%% %6ld %9.2f %9.2f\n",
+               t->entrants[mu / t->entrantCount].name,
+               t->entrants[mu % t->entrantCount].name,
+               (long)t->matchesPerMatchup,
+               100.0 * sum.leftWins / n, 100.0 * sum.rightWins / n,
+               (long)sum.timeouts,
+               sum.points ? (double)sum.rallyHits / sum.points : 0.0,
+               (double)sum.maxSpeed / FP_ONE);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const char *presetNames[3] = { "EASY", "MEDIUM", "HARD" };
+    Tournament t;
+    LONG threads = 0;
+    LONG onlyMatchup = -1, onlyMatch = -1;
+    LONG jobs, i;
+    double ticks = 0.0, seconds;
+    struct timespec t0, t1;
+
+    memset(&t, 0, sizeof(t));
+    t.matchesPerMatchup = 1000;
+    t.masterSeed = RANDOM_DEFAULT_SEED;
+
+    for (i = 0; i < 3; i++) {
+        AddEntrant(&t, presetNames[i], &difficultySettings[i]);
+    }
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            t.matchesPerMatchup = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            t.masterSeed = (ULONG)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-substeps") == 0 && i + 1 < argc) {
+            t.subStepShift = (WORD)atol(argv[++i]);
+            if (t.subStepShift < 0 || t.subStepShift > MAX_SUBSTEP_SHIFT) {
+                fprintf(stderr, "bad -substeps %s (want 0-%d)\n", argv[i], MAX_SUBSTEP_SHIFT);
+                return 10;
+            }
+        } else if (strcmp(argv[i], "-match") == 0 && i + 1 < argc) {
+            long mu, m;
+            if (sscanf(argv[++i], "%ld,%ld", &mu, &m) != 2 || mu < 0 || m < 0) {
+                fprintf(stderr, "bad -match %s (want matchup,number)\n", argv[i]);
+                return 10;
+            }
+            onlyMatchup = (LONG)mu;
+            onlyMatch = (LONG)m;
+        } else if (strcmp(argv[i], "-custom") == 0 && i + 1 < argc) {
+            AISettings ai;
+            int speed, error, delay;
+            char name[16];
+
+            if (sscanf(argv[++i], "%d,%d,%d", &speed, &error, &delay) != 3 ||
+                speed < 1 || error < 0 || delay < 1) {
+                fprintf(stderr, "bad -custom %s (want speed,error,delay)\n", argv[i]);
+                return 10;
+            }
+            ai.speed = (WORD)speed;
+            ai.errorMargin = (WORD)error;
+            ai.reactionDelay = (WORD)delay;
+            snprintf(name, sizeof(name), "CUSTOM%u", (unsigned)(t.entrantCount - 2) % 100u);
+            AddEntrant(&t, name, &ai);
+        } else {
+            fprintf(stderr, "usage: %s [-n matches] [-t threads] [-s seed] "
+                    "[-custom speed,error,delay]... [-match matchup,number] "
+                    "[-substeps shift]\n", argv[0]);
+            return 10;
+        }
+    }
+    if (t.matchesPerMatchup < 1) t.matchesPerMatchup = 1;
+    if (threads <= 0) threads = CountCPUs();
+    SeedRandom(&t.master, t.masterSeed);
+
+    /* Replay a single match straight from its stream */
+    if (onlyMatchup >= 0) {
+        MatchStats stats;
+        GameContext ctx;
+        RandomState rng;
+
+        if (onlyMatchup >= t.entrantCount * t.entrantCount ||
+            onlyMatch >= t.matchesPerMatchup) {
+            fprintf(stderr, "no match %ld,%ld\n", (long)onlyMatchup, (long)onlyMatch);
+            return 10;
+        }
+        memset(&stats, 0, sizeof(stats));
+        MatchStream(&t, onlyMatchup, onlyMatch, &rng);
+        PlayMatch(&t.entrants[onlyMatchup / t.entrantCount].ai,
+                  &t.entrants[onlyMatchup % t.entrantCount].ai, &rng,
+                  t.subStepShift, &ctx, &stats);
+        printf("%s vs %s match %ld: %d-%d in %.0f ticks, %ld paddle hits\n",
+               t.entrants[onlyMatchup / t.entrantCount].name,
+               t.entrants[onlyMatchup % t.entrantCount].name, (long)onlyMatch,
+               ctx.playerScore, ctx.aiScore, stats.ticks, (long)stats.rallyHits);
+        return 0;
+    }
+
+    t.jobsPerMatchup = (t.matchesPerMatchup + MATCHES_PER_JOB - 1) / MATCHES_PER_JOB;
+    jobs = t.jobsPerMatchup * t.entrantCount * t.entrantCount;
+    t.results = (MatchStats *)calloc((size_t)jobs, sizeof(MatchStats));
+    if (!t.results) return 20;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    RunWorkPool(jobs, threads, RunJob, &t);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    PrintResults(&t);
+
+    for (i = 0; i < jobs; i++) ticks += t.results[i].ticks;
+    printf("\n%ld matches on %ld threads in %.2fs (%.0f matches/s, %.0f ticks/s), seed %lu\n",
+           (long)(t.matchesPerMatchup * t.entrantCount * t.entrantCount), (long)threads,
+           seconds, t.matchesPerMatchup * t.entrantCount * t.entrantCount / seconds,
+           ticks / seconds, (unsigned long)t.masterSeed);
+
+    free(t.results);
+    return 0;
+}
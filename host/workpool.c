@@ -0,0 +1,156 @@
+/*
+ * workpool.c - Work-stealing thread pool for the host tools
+ * Amiga Pong - native (non-Amiga) build support
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <exec/types.h>
+#include "workpool.h"
+
+/* A worker's remaining jobs: [head, tail) */
+typedef struct {
+    pthread_mutex_t lock;
+    LONG head;
+    LONG tail;
+} WorkRange;
+
+typedef struct WorkPool WorkPool;
+
+typedef struct {
+    WorkPool *pool;
+    LONG index;
+    pthread_t thread;
+} Worker;
+
+struct WorkPool {
+    WorkRange *ranges;
+    Worker *workers;
+    LONG count;
+    WorkFunc func;
+    void *userData;
+};
+
+LONG CountCPUs(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (LONG)n : 1;
+}
+
+/* Take the next job from our own range */
+static BOOL PopJob(WorkRange *range, LONG *job)
+{
+    BOOL found = FALSE;
+
+    pthread_mutex_lock(&range->lock);
+    if (range->head < range->tail) {
+        *job = range->head++;
+        found = TRUE;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return found;
+}
+
+/* Move the back half of some other worker's range into ours */
+static BOOL StealJobs(WorkPool *pool, LONG self)
+{
+    LONG i;
+
+    for (i = 1; i < pool->count; i++) {
+        WorkRange *victim = &pool->ranges[(self + i) % pool->count];
+        LONG head = 0, tail = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->head < victim->tail) {
+            LONG take = (victim->tail - victim->head + 1) / 2;
+            tail = victim->tail;
+            head = tail - take;
+            victim->tail = head;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (head < tail) {
+            WorkRange *own = &pool->ranges[self];
+            pthread_mutex_lock(&own->lock);
+            own->head = head;
+            own->tail = tail;
+            pthread_mutex_unlock(&own->lock);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void *WorkerMain(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    WorkPool *pool = worker->pool;
+    WorkRange *own = &pool->ranges[worker->index];
+    LONG job;
+
+    /* Jobs are never added, so one empty sweep means we are done */
+    for (;;) {
+        while (PopJob(own, &job)) {
+            pool->func(pool->userData, job);
+        }
+        if (!StealJobs(pool, worker->index)) break;
+    }
+    return NULL;
+}
+
+BOOL RunWorkPool(LONG jobs, LONG threads, WorkFunc func, void *userData)
+{
+    WorkPool pool;
+    LONG i, started;
+
+    if (threads <= 0) threads = CountCPUs();
+    if (threads > jobs) threads = jobs;
+    if (threads <= 1) {
+        for (i = 0; i < jobs; i++) func(userData, i);
+        return TRUE;
+    }
+
+    pool.count = threads;
+    pool.func = func;
+    pool.userData = userData;
+    pool.ranges = (WorkRange *)calloc((size_t)threads, sizeof(WorkRange));
+    pool.workers = (Worker *)calloc((size_t)threads, sizeof(Worker));
+    if (!pool.ranges || !pool.workers) {
+        free(pool.ranges);
+        free(pool.workers);
+        return FALSE;
+    }
+
+    for (i = 0; i < threads; i++) {
+        pthread_mutex_init(&pool.ranges[i].lock, NULL);
+        pool.ranges[i].head = (LONG)(((long long)jobs * i) / threads);
+        pool.ranges[i].tail = (LONG)(((long long)jobs * (i + 1)) / threads);
+        pool.workers[i].pool = &pool;
+        pool.workers[i].index = i;
+    }
+
+    /*
+     * Worker 0 runs on the calling thread. If a thread can't be
+     * started, its share is simply stolen by the others.
+     */
+    for (started = 1; started < threads; started++) {
+        if (pthread_create(&pool.workers[started].thread, NULL, WorkerMain,
+                           &pool.workers[started]) != 0) {
+            break;
+        }
+    }
+    WorkerMain(&pool.workers[0]);
+
+    for (i = 1; i < started; i++) {
+        pthread_join(pool.workers[i].thread, NULL);
+    }
+    for (i = 0; i < threads; i++) {
+        pthread_mutex_destroy(&pool.ranges[i].lock);
+    }
+
+    free(pool.ranges);
+    free(pool.workers);
+    return TRUE;
+}
@@ -0,0 +1,27 @@
+/*
+ * workpool.h - Work-stealing thread pool for the host tools
+ * Amiga Pong - native (non-Amiga) build support
+ *
+ * Runs jobs 0..jobs-1 over a set of worker threads. Each worker
+ * starts with an even share of the job range and takes jobs from
+ * the front of it; a worker that runs dry steals the back half of
+ * another worker's remaining range. Which thread runs a job is not
+ * deterministic, so jobs should write their results to a slot
+ * indexed by job number and the caller should combine them in order.
+ */
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <exec/types.h>
+
+/* Called once per job on some worker thread */
+typedef void (*WorkFunc)(void *userData, LONG job);
+
+/* Number of online CPUs (at least 1) */
+LONG CountCPUs(void);
+
+/* Run all jobs and wait for them; threads <= 0 means one per CPU */
+BOOL RunWorkPool(LONG jobs, LONG threads, WorkFunc func, void *userData);
+
+#endif /* WORKPOOL_H */
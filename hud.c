@@ -0,0 +1,114 @@
+/*
+ * hud.c - Frame-time overlay: per-phase bars and dropped frames
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+
+#include "hud.h"
+#include "graphics.h"
+#include "timing.h"
+#include "profile.h"
+
+/* Bar length: a pixel per 200 us, so the 20 ms budget is 100 pixels */
+#define HUD_PIXELS_PER_SECOND 5000UL
+
+BOOL hudEnabled = FALSE;
+
+static ULONG clockRate = 0;      /* 0 if the clock could not be opened */
+static ULONG pixelScale;         /* Pixels per tick, 16.16 */
+static ULONG maxTicks;
+
+static HudPhase current;
+static ULONG markTicks;
+static ULONG phaseTicks[HUD_PHASES];
+static UWORD bars[HUD_PHASES];
+
+static BOOL counting = FALSE;
+static ULONG lastVBlank;
+static ULONG dropped = 0;
+
+void InitHud(void)
+{
+    clockRate = OpenProfileClock();
+    if (clockRate == 0) return;
+
+    pixelScale = (HUD_PIXELS_PER_SECOND << 16) / clockRate;
+    maxTicks = 0xFFFFFFFFUL / (pixelScale + 1);
+}
+
+void CleanupHud(void)
+{
+    if (clockRate) {
+        CloseProfileClock();
+        clockRate = 0;
+    }
+}
+
+static UWORD ToPixels(ULONG ticks)
+{
+    ULONG pixels;
+
+    if (ticks > maxTicks) ticks = maxTicks;
+    pixels = (ticks * pixelScale) >> 16;
+    return (UWORD)(pixels > PERF_HUD_WIDTH ? PERF_HUD_WIDTH : pixels);
+}
+
+void HudMark(HudPhase phase)
+{
+    ULONG now;
+
+    if (clockRate == 0) return;
+
+    now = ReadProfileClock();
+    phaseTicks[current] += now - markTicks;
+    markTicks = now;
+    current = phase;
+}
+
+void HudFrame(void)
+{
+    ULONG vblank = ReadVBlankCount();
+    WORD i;
+
+    if (counting && vblank - lastVBlank > 1) {
+        dropped += vblank - lastVBlank - 1;
+    }
+    lastVBlank = vblank;
+    counting = TRUE;
+
+    if (!hudEnabled) return;
+
+    /* Ends the last frame's wait; what it added up to is shown this frame */
+    HudMark(HUD_INPUT);
+    for (i = 0; i < HUD_PHASES; i++) {
+        bars[i] = ToPixels(phaseTicks[i]);
+        phaseTicks[i] = 0;
+    }
+}
+
+void ToggleHud(void)
+{
+    WORD i;
+
+    hudEnabled = !hudEnabled;
+    if (!hudEnabled) {
+        ErasePerfHud();
+        return;
+    }
+
+    /* Toggled while handling input: time from here counts as update */
+    for (i = 0; i < HUD_PHASES; i++) {
+        phaseTicks[i] = 0;
+        bars[i] = 0;
+    }
+    current = HUD_UPDATE;
+    markTicks = clockRate ? ReadProfileClock() : 0;
+}
+
+void DrawHud(void)
+{
+    if (hudEnabled) {
+        DrawPerfHud(bars, dropped);
+    }
+}
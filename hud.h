@@ -0,0 +1,50 @@
+/*
+ * hud.h - Frame-time overlay: per-phase bars and dropped frames
+ * Amiga Pong - OS-friendly implementation
+ *
+ * TAB shows or hides a strip along the top of the playfield. One bar
+ * per phase of the last frame (input, update, render, then the time
+ * spent waiting for the beam) at a pixel per 200 us, with a red mark
+ * at the 20 ms budget, and the number of frames dropped since the
+ * game started.
+ *
+ * A phase is timed by marking where it begins: HUD_MARK() reads the
+ * E clock once. With the overlay hidden a mark is only a test of
+ * hudEnabled. Dropped frames (the vertical blank counter moving on by
+ * more than one between passes of the game loop) are always counted.
+ */
+
+#ifndef HUD_H
+#define HUD_H
+
+#include <exec/types.h>
+#include "graphics.h"
+
+typedef enum {
+    HUD_INPUT,
+    HUD_UPDATE,
+    HUD_RENDER,
+    HUD_WAIT,       /* WaitBOVP()/WaitTOF(): idle, not CPU */
+    HUD_PHASES
+} HudPhase;
+
+extern BOOL hudEnabled;
+
+#define HUD_MARK(p) do { if (hudEnabled) HudMark(p); } while (0)
+
+/* Open the clock; the overlay starts hidden */
+void InitHud(void);
+void CleanupHud(void);
+
+/* Top of the game loop: count dropped frames, close the last frame's times */
+void HudFrame(void);
+
+/* The given phase begins now */
+void HudMark(HudPhase phase);
+
+void ToggleHud(void);
+
+/* After rendering: bring the overlay up to date if it is shown */
+void DrawHud(void);
+
+#endif /* HUD_H */
@@ -21,6 +21,7 @@ void InitInput(InputState *input)
     input->mouseY = 128;  /* Center of screen */
     input->events = INPUT_NONE;
     input->lastKey = 0;
+    input->keyCount = 0;
 }
 
 void ProcessInput(struct Window *window, InputState *input)
@@ -35,6 +36,7 @@ void ProcessInput(struct Window *window, InputState *input)
     /* Clear events from last frame */
     input->events = INPUT_NONE;
     input->lastKey = 0;
+    input->keyCount = 0;
 
     /* Process all pending messages */
     while ((msg = (struct IntuiMessage *)GetMsg(window->UserPort)) != NULL) {
@@ -71,6 +73,9 @@ void ProcessInput(struct Window *window, InputState *input)
                 /* ASCII key for name entry */
                 input->events |= INPUT_KEY;
                 input->lastKey = (UBYTE)code;
+                if (input->keyCount < INPUT_KEY_QUEUE) {
+                    input->keys[input->keyCount++] = (UBYTE)code;
+                }
                 /* Also check for ESC via ASCII */
                 if (code == ASCII_ESC) {
                     input->events |= INPUT_ESC;
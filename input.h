@@ -17,11 +17,16 @@
 #define INPUT_CLOSE      8
 #define INPUT_KEY        16
 
+/* Keys kept a frame; more than this in one frame are dropped */
+#define INPUT_KEY_QUEUE 16
+
 /* Input state */
 typedef struct {
     WORD mouseY;       /* Current mouse Y position */
     UBYTE events;      /* Bitmask of events this frame */
-    UBYTE lastKey;     /* Last key pressed (for name entry) */
+    UBYTE lastKey;     /* Last key pressed */
+    UBYTE keyCount;    /* Keys pressed this frame, in order (for name entry) */
+    UBYTE keys[INPUT_KEY_QUEUE];
 } InputState;
 
 /* Process all pending IDCMP messages */
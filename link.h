@@ -0,0 +1,34 @@
+/*
+ * link.h - Byte stream to a netplay peer
+ * Amiga Pong - OS-friendly implementation
+ *
+ * On the Amiga the link is serial.device over a null-modem cable
+ * (serial.c); the native build runs it over a pipe or socket
+ * (host/hostlink.c). Either way it is a reliable, ordered stream.
+ */
+
+#ifndef LINK_H
+#define LINK_H
+
+#include <exec/types.h>
+
+struct NetLink;
+
+/* Bits per second for the null-modem link; a frame's packet is 12 bytes */
+#define LINK_BAUD 19200
+
+/* Most bytes one SendLink() takes */
+#define LINK_WRITE_SIZE 64
+
+/* Open serial.device unit 0 at the given rate; NULL if it is in use */
+struct NetLink *OpenSerialLink(ULONG baud);
+
+/* Queue bytes for the peer; returns length, or -1 if the link has failed */
+LONG SendLink(struct NetLink *link, const UBYTE *data, LONG length);
+
+/* Read what has arrived, without waiting; 0 if nothing, -1 if closed */
+LONG ReceiveLink(struct NetLink *link, UBYTE *buffer, LONG size);
+
+void CloseLink(struct NetLink *link);
+
+#endif /* LINK_H */
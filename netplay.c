@@ -0,0 +1,368 @@
+/*
+ * netplay.c - Two-player versus over a link, with rollback
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+#include <string.h>
+
+#include "netplay.h"
+#include "graphics.h"
+
+#define STATE_MASK (NET_STATE_RING - 1)
+#define INPUT_MASK (NET_INPUT_RING - 1)
+
+/* Packet sizes, check byte included */
+#define HELLO_SIZE 15
+#define FRAME_SIZE 12
+#define BYE_SIZE   8
+
+static void PutWord(UBYTE *p, UWORD w)
+{
+    p[0] = (UBYTE)(w >> 8);
+    p[1] = (UBYTE)w;
+}
+
+static void PutLong(UBYTE *p, ULONG l)
+{
+    PutWord(p, (UWORD)(l >> 16));
+    PutWord(p + 2, (UWORD)l);
+}
+
+static UWORD GetWord(const UBYTE *p)
+{
+    return (UWORD)((p[0] << 8) | p[1]);
+}
+
+static ULONG GetLong(const UBYTE *p)
+{
+    return ((ULONG)GetWord(p) << 16) | GetWord(p + 2);
+}
+
+static UBYTE SumBytes(const UBYTE *p, WORD n)
+{
+    UBYTE sum = 0;
+
+    while (n-- > 0) sum += *p++;
+    return sum;
+}
+
+/* Add the check byte and send */
+static void SendPacket(NetSession *s, UBYTE *packet, WORD size)
+{
+    packet[size - 1] = SumBytes(packet, (WORD)(size - 1));
+    if (SendLink(s->link, packet, size) != size) {
+        s->status = NET_FAILED;
+    }
+}
+
+static void SendHello(NetSession *s)
+{
+    UBYTE p[HELLO_SIZE];
+
+    p[0] = NET_HELLO;
+    p[1] = NET_VERSION;
+    p[2] = s->left ? 0 : 1;
+    p[3] = (UBYTE)s->delay;
+    p[4] = (UBYTE)s->game.subStepShift;
+    p[5] = (UBYTE)s->game.difficulty;
+    PutLong(p + 6, (ULONG)(s->game.rng >> 32));
+    PutLong(p + 10, (ULONG)s->game.rng);
+    SendPacket(s, p, HELLO_SIZE);
+}
+
+/* This peer's input for a frame, and where its confirmed game stands */
+static void SendFrame(NetSession *s, LONG frame, WORD mouseY)
+{
+    UBYTE p[FRAME_SIZE];
+
+    p[0] = NET_FRAME;
+    PutWord(p + 1, (UWORD)frame);
+    PutWord(p + 3, (UWORD)mouseY);
+    PutWord(p + 5, (UWORD)s->confirmed);
+    PutLong(p + 7, s->checksum);
+    SendPacket(s, p, FRAME_SIZE);
+}
+
+/* Both checksums for a confirmed frame count are in: do they agree? */
+static void CompareChecksums(NetSession *s, LONG frames)
+{
+    WORD i = (WORD)(frames & INPUT_MASK);
+
+    if (s->localSumFrames[i] != frames || s->remoteSumFrames[i] != frames) return;
+
+    if (s->localSum[i] == s->remoteSum[i]) {
+        if (frames > s->checkedFrames) s->checkedFrames = frames;
+    } else if (s->status == NET_RUNNING) {
+        s->status = NET_DESYNC;
+        s->desyncFrames = frames;
+    }
+}
+
+static void RemoteChecksum(NetSession *s, UWORD count, ULONG sum)
+{
+    /* Counts go out as 16 bits: take the one nearest our own */
+    LONG frames = s->confirmed + (WORD)(count - (UWORD)s->confirmed);
+    WORD i = (WORD)(frames & INPUT_MASK);
+
+    s->remoteSum[i] = sum;
+    s->remoteSumFrames[i] = frames;
+    CompareChecksums(s, frames);
+}
+
+static void RemoteInput(NetSession *s, UWORD frame, WORD mouseY)
+{
+    LONG f = s->remoteFrame + 1;
+
+    /* The link keeps order, so this must be the next frame */
+    if ((UWORD)f != frame) {
+        s->status = NET_FAILED;
+        return;
+    }
+    s->remoteY[f & INPUT_MASK] = mouseY;
+    s->remoteFrame = f;
+
+    /* Already run on a prediction that was wrong: go back to it */
+    if (f < s->frame && s->usedY[f & INPUT_MASK] != mouseY &&
+        (s->rollbackFrom < 0 || f < s->rollbackFrom)) {
+        s->rollbackFrom = f;
+    }
+}
+
+/* Both peers have said hello: start the match the left one set up */
+static void BeginMatch(NetSession *s)
+{
+    WORD i;
+
+    StartMatch(&s->game);
+
+    /* Frames before the first delayed input run with the paddles centred */
+    for (i = 0; i < NET_INPUT_RING; i++) {
+        s->localY[i] = NET_START_Y;
+        s->remoteY[i] = NET_START_Y;
+        s->usedY[i] = NET_START_Y;
+        s->localSumFrames[i] = -1;
+        s->remoteSumFrames[i] = -1;
+    }
+    s->frame = 0;
+    s->remoteFrame = s->delay - 1;
+    s->confirmed = 0;
+    s->rollbackFrom = -1;
+    s->checksum = CHECKSUM_START;
+    s->status = NET_RUNNING;
+}
+
+static void HandleHello(NetSession *s, const UBYTE *p)
+{
+    if (s->status != NET_CONNECTING || p[1] != NET_VERSION ||
+        p[2] != (s->left ? 1 : 0)) {
+        s->status = NET_FAILED;
+        return;
+    }
+
+    if (!s->left) {
+        if (p[3] > NET_MAX_DELAY || p[4] > MAX_SUBSTEP_SHIFT || p[5] > DIFFICULTY_HARD) {
+            s->status = NET_FAILED;
+            return;
+        }
+        s->delay = p[3];
+        s->game.subStepShift = p[4];
+        s->game.difficulty = (Difficulty)p[5];
+        s->game.rng = ((RandomState)GetLong(p + 6) << 32) | GetLong(p + 10);
+    }
+    BeginMatch(s);
+}
+
+static void HandlePacket(NetSession *s, const UBYTE *p)
+{
+    switch (p[0]) {
+        case NET_HELLO:
+            HandleHello(s, p);
+            break;
+
+        case NET_FRAME:
+            if (s->status != NET_RUNNING) {
+                s->status = NET_FAILED;
+                break;
+            }
+            RemoteInput(s, GetWord(p + 1), (WORD)GetWord(p + 3));
+            RemoteChecksum(s, GetWord(p + 5), GetLong(p + 7));
+            break;
+
+        case NET_BYE:
+            if (s->status == NET_RUNNING) {
+                RemoteChecksum(s, GetWord(p + 1), GetLong(p + 3));
+            }
+            s->peerDone = TRUE;
+            break;
+    }
+}
+
+/* Handle every whole packet received so far */
+static void ParsePackets(NetSession *s)
+{
+    UWORD pos = 0;
+    WORD size;
+
+    while (pos < s->received && s->status <= NET_RUNNING) {
+        const UBYTE *p = s->rx + pos;
+
+        switch (p[0]) {
+            case NET_HELLO: size = HELLO_SIZE; break;
+            case NET_FRAME: size = FRAME_SIZE; break;
+            case NET_BYE:   size = BYE_SIZE;   break;
+            default:
+                s->status = NET_FAILED;
+                return;
+        }
+        if (s->received - pos < size) break;
+        if (SumBytes(p, (WORD)(size - 1)) != p[size - 1]) {
+            s->status = NET_FAILED;
+            return;
+        }
+        HandlePacket(s, p);
+        pos += size;
+    }
+
+    s->received -= pos;
+    memmove(s->rx, s->rx + pos, s->received);
+}
+
+static void Receive(NetSession *s)
+{
+    LONG n;
+
+    while (!s->peerDone && s->status <= NET_RUNNING) {
+        n = ReceiveLink(s->link, s->rx + s->received, (LONG)sizeof(s->rx) - s->received);
+        if (n < 0) {
+            s->peerDone = TRUE;
+        } else if (n == 0) {
+            break;
+        } else {
+            s->received += (UWORD)n;
+            ParsePackets(s);
+        }
+    }
+}
+
+/* Run frame s->frame with the peer's input, or the latest guess at it */
+static void RunFrame(NetSession *s)
+{
+    LONG f = s->frame;
+    WORD i = (WORD)(f & INPUT_MASK);
+    WORD remote = s->remoteY[(f <= s->remoteFrame ? f : s->remoteFrame) & INPUT_MASK];
+
+    s->saved[f & STATE_MASK] = s->game;
+    s->usedY[i] = remote;
+    if (s->left) {
+        UpdateVersus(&s->game, s->localY[i], remote);
+    } else {
+        UpdateVersus(&s->game, remote, s->localY[i]);
+    }
+    s->frame++;
+}
+
+/* Go back to the first mispredicted frame and run forward again */
+static void Rollback(NetSession *s)
+{
+    LONG to = s->frame;
+    LONG depth;
+
+    if (s->rollbackFrom < 0) return;
+
+    depth = to - s->rollbackFrom;
+    s->game = s->saved[s->rollbackFrom & STATE_MASK];
+    s->frame = s->rollbackFrom;
+    while (s->frame < to) {
+        RunFrame(s);
+    }
+    s->rollbackFrom = -1;
+
+    s->rollbacks++;
+    s->resimulated += depth;
+    if (depth > s->maxRollback) s->maxRollback = depth;
+}
+
+/* Fold every frame now run with both real inputs into the checksum */
+static void Confirm(NetSession *s)
+{
+    LONG last = s->remoteFrame + 1;
+    const GameContext *after;
+    LONG n;
+
+    if (last > s->frame) last = s->frame;
+
+    while (s->confirmed < last) {
+        n = ++s->confirmed;
+        after = (n < s->frame) ? &s->saved[n & STATE_MASK] : &s->game;
+
+        s->checksum = ChecksumGame(s->checksum, after);
+        s->localSum[n & INPUT_MASK] = s->checksum;
+        s->localSumFrames[n & INPUT_MASK] = n;
+        CompareChecksums(s, n);
+
+        if (after->state != STATE_PLAYING) s->finished = TRUE;
+    }
+}
+
+void StartNetplay(NetSession *s, struct NetLink *link, BOOL left,
+                  const GameContext *setup, WORD delay)
+{
+    memset(s, 0, sizeof(*s));
+    s->link = link;
+    s->left = left;
+    s->status = NET_CONNECTING;
+    s->rollbackFrom = -1;
+    if (delay < 0) delay = 0;
+    if (delay > NET_MAX_DELAY) delay = NET_MAX_DELAY;
+    s->delay = delay;
+    s->game = *setup;
+
+    SendHello(s);
+}
+
+BOOL UpdateNetplay(NetSession *s, WORD mouseY)
+{
+    LONG f;
+
+    if (s->status > NET_RUNNING) return FALSE;
+
+    Receive(s);
+    if (s->status != NET_RUNNING || s->finished) return FALSE;
+
+    Rollback(s);
+    Confirm(s);
+    if (s->status != NET_RUNNING) return FALSE;
+
+    /* Too far ahead of the peer: wait, unless it is never coming back */
+    if (s->frame - s->remoteFrame > NET_MAX_ROLLBACK) {
+        s->stalls++;
+        if (s->peerDone) s->status = NET_CLOSED;
+        return FALSE;
+    }
+
+    f = s->frame + s->delay;
+    s->localY[f & INPUT_MASK] = mouseY;
+    SendFrame(s, f, mouseY);
+
+    RunFrame(s);
+    Confirm(s);
+    return TRUE;
+}
+
+BOOL NetplayFinished(const NetSession *s)
+{
+    return s->finished;
+}
+
+void StopNetplay(NetSession *s)
+{
+    UBYTE p[BYE_SIZE];
+
+    if (s->status == NET_FAILED) return;
+
+    p[0] = NET_BYE;
+    PutWord(p + 1, (UWORD)s->confirmed);
+    PutLong(p + 3, s->checksum);
+    SendPacket(s, p, BYE_SIZE);
+}
@@ -0,0 +1,129 @@
+/*
+ * netplay.h - Two-player versus over a link, with rollback
+ * Amiga Pong - OS-friendly implementation
+ *
+ * Each peer runs the whole match with UpdateVersus(). Local input is
+ * used NET_DELAY frames after it is read, which hides that much link
+ * latency outright. Beyond that the peer's input is predicted (it is
+ * taken to stay where it last was) and play carries on; when the real
+ * input turns out different, the game goes back to the snapshot taken
+ * before that frame and runs the frames since again. At most
+ * NET_MAX_ROLLBACK frames are ever predicted: a peer that far ahead
+ * waits for the other.
+ *
+ * Every packet carries a running checksum over the state after each
+ * frame both inputs are known for, so the first mismatch shows that
+ * the peers have desynchronised somewhere up to that frame.
+ *
+ * Packets, all big-endian and ending in a sum of the bytes before it:
+ *
+ *   NET_HELLO  version, side, delay, subStepShift, difficulty, RNG (8)
+ *   NET_FRAME  frame (UWORD), mouse Y (WORD) for that frame,
+ *              confirmed frame count (UWORD), checksum (ULONG)
+ *   NET_BYE    confirmed frame count (UWORD), checksum (ULONG)
+ *
+ * The left peer's hello sets up the match; the right one takes its
+ * settings. One NET_FRAME a frame is 600 bytes a second.
+ */
+
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include <exec/types.h>
+#include "game.h"
+#include "link.h"
+
+#define NET_VERSION 1
+
+/* Input delay, frames; more hides more latency but makes play laggier */
+#define NET_DELAY     2
+#define NET_MAX_DELAY 8
+
+/* Most frames played ahead on predicted input */
+#define NET_MAX_ROLLBACK 8
+
+/* Rings, powers of two: states back to the oldest predicted frame, and
+   inputs and checksums, which also cover the peer running ahead */
+#define NET_STATE_RING 16
+#define NET_INPUT_RING 64
+
+/* Input for the frames before the first delayed one */
+#define NET_START_Y (SCREEN_HEIGHT / 2)
+
+/* Packet types */
+#define NET_HELLO 0xA1
+#define NET_FRAME 0xA2
+#define NET_BYE   0xA3
+
+#define NET_PACKET_SIZE 16
+
+typedef enum {
+    NET_CONNECTING,      /* Waiting for the peer's hello */
+    NET_RUNNING,
+    NET_CLOSED,          /* The peer left before the match was over */
+    NET_DESYNC,          /* Checksums differ: the games have diverged */
+    NET_FAILED           /* Link error, bad packet or mismatched peer */
+} NetStatus;
+
+typedef struct {
+    struct NetLink *link;
+    NetStatus status;
+    BOOL left;           /* This peer plays the left paddle */
+    BOOL peerDone;       /* The peer has said goodbye or the link closed */
+    BOOL finished;       /* The confirmed game is over */
+    WORD delay;
+
+    GameContext game;    /* State before frame 'frame', with predictions */
+    LONG frame;          /* Next frame to run */
+    LONG remoteFrame;    /* Newest frame the peer's input is known for */
+    LONG confirmed;      /* Frames run with both inputs known */
+    LONG rollbackFrom;   /* Earliest mispredicted frame, -1 if none */
+
+    ULONG checksum;      /* Running checksum over the confirmed frames */
+    LONG checkedFrames;  /* Most confirmed frames the peer has agreed on */
+    LONG desyncFrames;   /* Confirmed frames when they first disagreed */
+
+    /* Statistics */
+    LONG rollbacks;
+    LONG resimulated;
+    LONG maxRollback;
+    LONG stalls;
+
+    GameContext saved[NET_STATE_RING];    /* State before each frame */
+    WORD localY[NET_INPUT_RING];
+    WORD remoteY[NET_INPUT_RING];
+    WORD usedY[NET_INPUT_RING];           /* Peer input each frame ran with */
+    ULONG localSum[NET_INPUT_RING];       /* Checksums by confirmed count */
+    LONG localSumFrames[NET_INPUT_RING];
+    ULONG remoteSum[NET_INPUT_RING];
+    LONG remoteSumFrames[NET_INPUT_RING];
+
+    UWORD received;
+    UBYTE rx[NET_PACKET_SIZE * 4];
+} NetSession;
+
+/*
+ * Start a session over an open link and say hello. The left peer's
+ * setup (RNG, difficulty, sub-steps) and delay are used for the match,
+ * which starts with StartMatch() once the peer has answered.
+ */
+void StartNetplay(NetSession *s, struct NetLink *link, BOOL left,
+                  const GameContext *setup, WORD delay);
+
+/*
+ * Exchange packets, roll back if the peer's input was mispredicted,
+ * and run the next frame with this peer's mouse Y. Returns FALSE
+ * without running it while still connecting, when it would have to
+ * predict more than NET_MAX_ROLLBACK frames, once the match is over
+ * (it only listens for the peer's goodbye then), or once the session
+ * has stopped (see status).
+ */
+BOOL UpdateNetplay(NetSession *s, WORD mouseY);
+
+/* TRUE once the confirmed game is over: both peers agree on the result */
+BOOL NetplayFinished(const NetSession *s);
+
+/* Tell the peer we are leaving, with the final checksum */
+void StopNetplay(NetSession *s);
+
+#endif /* NETPLAY_H */
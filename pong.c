@@ -4,7 +4,7 @@
  *
  * A classic Pong game for Amiga 500
  * - Mouse controlled player paddle
- * - AI opponent
+ * - AI opponent, or a second player over a null-modem cable
  * - Persistent high scores
  * - OS-friendly (no hardware takeover)
  */
@@ -22,6 +22,18 @@
 #include "game.h"
 #include "input.h"
 #include "highscore.h"
+#include "timing.h"
+#include "replay.h"
+#include "rewind.h"
+#include "netplay.h"
+#include "link.h"
+#include "profile.h"
+#include "hud.h"
+
+/* Ball sub-steps per frame, 1 << PONG_SUBSTEP_SHIFT (make SUBSTEPS=n) */
+#ifndef PONG_SUBSTEP_SHIFT
+#define PONG_SUBSTEP_SHIFT 0
+#endif
 
 /* Library bases */
 struct IntuitionBase *IntuitionBase = NULL;
@@ -32,9 +44,29 @@ static GameContext gameCtx;
 static InputState inputState;
 static HighScoreTable highScores;
 
+/* Fixed-timestep clock and the state one step back, for interpolation */
+static FrameClock frameClock;
+static Ball prevBall;
+static WORD prevAIY;
+
+/* Recording of the match in progress (file is 0 when not recording) */
+static ReplayWriter replayWriter;
+
+/* Recent history of the match in progress, for the rewind key */
+static RewindBuffer rewindBuffer;
+
+/* Versus match over the serial link (netLink is NULL when not linked) */
+static NetSession netSession;
+static struct NetLink *netLink = NULL;
+static BOOL linkMatch = FALSE;      /* The match on screen is a link match */
+static const char *linkMessage = NULL;
+
 /* Name entry state */
-static char entryName[NAME_LENGTH + 1];
-static WORD entryPos = 0;
+static NameEntry nameEntry;
+
+/* Frames since the last key in name entry: the cursor blinks on it */
+#define CURSOR_BLINK 16     /* Frames on, then as many off */
+static UWORD entryFrames = 0;
 
 /* Quit flag */
 static BOOL wantQuit = FALSE;
@@ -46,15 +78,27 @@ static const char *difficultyNames[3] = { "EASY", "MEDIUM", "HARD" };
 static BOOL OpenLibraries(void);
 static void CloseLibraries(void);
 static void GameLoop(void);
+static void StartRecording(void);
+static void StopRecording(void);
+static void StartSimulation(void);
+static void RunSimulation(void);
+static WORD Interpolate(LONG from, LONG to, WORD alpha);
+static void StartLinkMatch(BOOL left);
+static void RunLinkSimulation(void);
+static void EndLinkMatch(const char *message);
+static BOOL LocalPlayerWon(void);
 static void RenderFrame(void);
 static void HandleTitleInput(void);
 static void HandlePlayingInput(void);
 static void HandlePausedInput(void);
+static void RewindGame(void);
 static void HandleGameOverInput(void);
 static void HandleHighScoreEntry(void);
 static void DrawHighScoreEntry(void);
+static void DrawNameLine(void);
 static void DrawHighScoreTable(void);
 static void DrawDifficultySelection(void);
+static void DrawLinkHelp(void);
 
 int main(void)
 {
@@ -69,6 +113,17 @@ int main(void)
         return 20;
     }
 
+    /* Start the game clock */
+    if (!InitTiming()) {
+        CleanupGraphics();
+        CloseLibraries();
+        return 20;
+    }
+
+    /* Time each frame (make PROFILE=1 builds only) */
+    PROFILE_START();
+    InitHud();
+
     /* Load high scores and settings */
     LoadHighScores(&highScores);
 
@@ -77,12 +132,19 @@ int main(void)
 
     /* Apply saved difficulty before InitGame */
     gameCtx.difficulty = (Difficulty)highScores.difficulty;
+    SetRandomSeed(&gameCtx, RANDOM_DEFAULT_SEED);
+    gameCtx.subStepShift = PONG_SUBSTEP_SHIFT;
     InitGame(&gameCtx);
 
     /* Main game loop */
     GameLoop();
 
     /* Cleanup */
+    EndLinkMatch(NULL);
+    StopRecording();
+    PROFILE_STOP();
+    CleanupHud();
+    CleanupTiming();
     CleanupGraphics();
     CloseLibraries();
 
@@ -128,8 +190,14 @@ static void GameLoop(void)
     wantQuit = FALSE;
 
     while (running) {
+        PROFILE_FRAME();
+        HudFrame();
+
         /* Process input */
+        PROFILE_BEGIN(PROFILE_INPUT);
         ProcessInput(window, &inputState);
+        PROFILE_END(PROFILE_INPUT);
+        HUD_MARK(HUD_UPDATE);
 
         /* Check for close request or quit flag */
         if ((inputState.events & INPUT_CLOSE) || wantQuit) {
@@ -137,10 +205,19 @@ static void GameLoop(void)
             continue;
         }
 
+        /* TAB shows or hides the frame-time overlay, in any state */
+        if (inputState.lastKey == '\t') {
+            ToggleHud();
+        }
+
+        /* Pauses and resumes go into the replay */
+        RecordReplayEvents(&replayWriter, inputState.events);
+
         /* Remember state before handling input */
         prevState = gameCtx.state;
 
         /* Handle input based on game state */
+        PROFILE_BEGIN(PROFILE_UPDATE);
         switch (gameCtx.state) {
             case STATE_TITLE:
                 HandleTitleInput();
@@ -148,7 +225,7 @@ static void GameLoop(void)
 
             case STATE_PLAYING:
                 HandlePlayingInput();
-                UpdateGame(&gameCtx, inputState.mouseY);
+                RunSimulation();
                 break;
 
             case STATE_PAUSED:
@@ -166,6 +243,14 @@ static void GameLoop(void)
 
         /* If state changed to a static screen, reset it */
         if (gameCtx.state != prevState) {
+            if (gameCtx.state == STATE_PLAYING) {
+                StartSimulation();
+            } else if (gameCtx.state == STATE_PAUSED) {
+                /* Nothing is moving: a good time for the disk */
+                FlushReplay(&replayWriter);
+            } else {
+                StopRecording();
+            }
             if (gameCtx.state == STATE_GAMEOVER ||
                 gameCtx.state == STATE_HIGHSCORE_ENTRY ||
                 gameCtx.state == STATE_TITLE ||
@@ -173,14 +258,166 @@ static void GameLoop(void)
                 ResetStaticScreen();
             }
         }
+        PROFILE_END(PROFILE_UPDATE);
 
         /* Render and swap buffers */
+        PROFILE_BEGIN(PROFILE_RENDER);
+        HUD_MARK(HUD_RENDER);
         RenderFrame();
+        DrawHud();
+        FlushDisplay();
+        PROFILE_END(PROFILE_RENDER);
+    }
+}
+
+/* Record the match about to be started from gameCtx */
+static void StartRecording(void)
+{
+    ReplayHeader header;
+
+    StopRecording();
+    GetReplayHeader(&gameCtx, &header);
+    OpenReplayWriter(&replayWriter, REPLAY_FILE, &header);
+}
+
+static void StopRecording(void)
+{
+    if (replayWriter.file) {
+        CloseReplayWriter(&replayWriter);
+    }
+}
+
+/* Restart the clock on entering play, so time spent paused is not made up */
+static void StartSimulation(void)
+{
+    ResetFrameClock(&frameClock);
+    prevBall = gameCtx.ball;
+    prevAIY = gameCtx.aiPaddle.y;
+}
+
+/* Run the simulation steps that fell due since the last frame */
+static void RunSimulation(void)
+{
+    WORD steps;
+
+    if (netLink) {
+        RunLinkSimulation();
+        return;
+    }
+
+    steps = AdvanceFrameClock(&frameClock);
+    while (steps-- > 0 && gameCtx.state == STATE_PLAYING) {
+        prevBall = gameCtx.ball;
+        prevAIY = gameCtx.aiPaddle.y;
+        RecordReplayStep(&replayWriter, &gameCtx, inputState.mouseY);
+        UpdateGame(&gameCtx, inputState.mouseY);
+        RecordRewind(&rewindBuffer, &gameCtx);
+    }
+}
+
+/* Connect to the other Amiga and start a versus match as one side */
+static void StartLinkMatch(BOOL left)
+{
+    netLink = OpenSerialLink(LINK_BAUD);
+    if (!netLink) {
+        linkMessage = "Serial port in use";
+        ResetStaticScreen();
+        return;
+    }
+
+    StartNetplay(&netSession, netLink, left, &gameCtx, NET_DELAY);
+    linkMatch = TRUE;
+    linkMessage = NULL;
+
+    /* Show the empty court while the other player connects */
+    StartMatch(&gameCtx);
+    RequestFullRedraw();
+}
+
+/*
+ * Run the link match for the steps that fell due. The screen shows the
+ * predicted game, but only a confirmed game over ends the match.
+ */
+static void RunLinkSimulation(void)
+{
+    WORD steps = AdvanceFrameClock(&frameClock);
+
+    while (steps-- > 0) {
+        prevBall = netSession.game.ball;
+        prevAIY = netSession.game.aiPaddle.y;
+        if (!UpdateNetplay(&netSession, inputState.mouseY)) break;
+    }
+
+    if (NetplayFinished(&netSession)) {
+        gameCtx = netSession.game;
+        EndLinkMatch(NULL);
+        return;
+    }
+
+    switch (netSession.status) {
+        case NET_CONNECTING:
+            return;
+        case NET_RUNNING:
+            gameCtx = netSession.game;
+            gameCtx.state = STATE_PLAYING;
+            return;
+        case NET_CLOSED:
+            EndLinkMatch("Other player left");
+            break;
+        case NET_DESYNC:
+            EndLinkMatch("Link games out of step");
+            break;
+        default:
+            EndLinkMatch("Link error");
+            break;
+    }
+    gameCtx.state = STATE_TITLE;
+    InitGame(&gameCtx);
+}
+
+/* Say goodbye and hang up; a message shows on the title screen */
+static void EndLinkMatch(const char *message)
+{
+    if (netLink) {
+        StopNetplay(&netSession);
+        CloseLink(netLink);
+        netLink = NULL;
+
+        /* The left player's settings came with the match: back to our own */
+        gameCtx.difficulty = (Difficulty)highScores.difficulty;
+    }
+    linkMessage = message;
+    if (message) linkMatch = FALSE;
+}
+
+/* Won the match from this side of the link (or against the AI) */
+static BOOL LocalPlayerWon(void)
+{
+    if (linkMatch && !netSession.left) {
+        return !PlayerWon(&gameCtx);
     }
+    return PlayerWon(&gameCtx);
+}
+
+/*
+ * Display position alpha/256 of the way from one step to the next,
+ * in pixels.
+ * A jump longer than any step's motion (a serve) is not blended.
+ */
+static WORD Interpolate(LONG from, LONG to, WORD alpha)
+{
+    LONG d = to - from;
+
+    if (d > 2 * BALL_MAX_SPEED || d < -2 * BALL_MAX_SPEED) {
+        return (WORD)FP_TO_INT(to);
+    }
+    return (WORD)FP_TO_INT(from + (((LONG)(WORD)d * alpha) >> 8));
 }
 
 static void RenderFrame(void)
 {
+    WORD alpha;
+
     /* Draw based on game state */
     switch (gameCtx.state) {
         case STATE_TITLE:
@@ -189,48 +426,51 @@ static void RenderFrame(void)
                 ClearDisplay();
                 DrawTitleScreen();
                 DrawDifficultySelection();
+                DrawLinkHelp();
                 DrawHighScoreTable();
             }
             break;
 
         case STATE_PLAYING:
             /* Use optimized rendering - only redraws what changed */
+            alpha = FrameClockAlpha(&frameClock);
             UpdateGameGraphics(
-                FP_TO_INT(gameCtx.ball.x), FP_TO_INT(gameCtx.ball.y),
-                gameCtx.playerPaddle.y, gameCtx.aiPaddle.y,
+                Interpolate(prevBall.x, gameCtx.ball.x, alpha),
+                Interpolate(prevBall.y, gameCtx.ball.y, alpha),
+                gameCtx.playerPaddle.y,
+                Interpolate(INT_TO_FP((LONG)prevAIY), INT_TO_FP((LONG)gameCtx.aiPaddle.y), alpha),
                 gameCtx.playerScore, gameCtx.aiScore);
             break;
 
         case STATE_PAUSED:
-            /* Only draw paused screen once */
+            /* The play screen stays up under the pause text (drawn once) */
             if (DrawStaticScreen()) {
-                ClearDisplay();
-                DrawCenterLine();
-                DrawScore(gameCtx.playerScore, gameCtx.aiScore);
-                DrawPaddle(PADDLE_OFFSET, gameCtx.playerPaddle.y, COLOR_WHITE);
-                DrawPaddle(SCREEN_WIDTH - PADDLE_OFFSET - PADDLE_WIDTH,
-                          gameCtx.aiPaddle.y, COLOR_CYAN);
-                DrawBall(FP_TO_INT(gameCtx.ball.x), FP_TO_INT(gameCtx.ball.y));
-                DrawPausedText();
+                UpdateGameGraphics(
+                    FP_TO_INT(gameCtx.ball.x), FP_TO_INT(gameCtx.ball.y),
+                    gameCtx.playerPaddle.y, gameCtx.aiPaddle.y,
+                    gameCtx.playerScore, gameCtx.aiScore);
+                ShowPauseOverlay();
             }
             break;
 
         case STATE_GAMEOVER:
             /* Only draw game over screen once */
             if (DrawStaticScreen()) {
-                ClearDisplay();
-                DrawCenterLine();
+                DrawCourt();
                 DrawScore(gameCtx.playerScore, gameCtx.aiScore);
-                DrawGameOver(PlayerWon(&gameCtx));
+                DrawGameOver(LocalPlayerWon());
             }
             break;
 
         case STATE_HIGHSCORE_ENTRY:
-            /* High score entry needs redraw for cursor */
+            /* Drawn once; then only the name line, cell by cell */
             if (DrawStaticScreen()) {
                 ClearDisplay();
                 DrawHighScoreEntry();
+            } else {
+                DrawNameLine();
             }
+            entryFrames++;
             break;
     }
 }
@@ -267,6 +507,16 @@ static void DrawDifficultySelection(void)
     }
 }
 
+static void DrawLinkHelp(void)
+{
+    const char *text = linkMessage ? linkMessage : "H/J: Host/Join link play";
+    WORD length = 0;
+
+    while (text[length]) length++;
+    DrawText((WORD)((SCREEN_WIDTH - length * 8) / 2), 172, text,
+             linkMessage ? COLOR_YELLOW : COLOR_WHITE);
+}
+
 static void HandleTitleInput(void)
 {
     UBYTE key = inputState.lastKey;
@@ -277,12 +527,16 @@ static void HandleTitleInput(void)
         wantQuit = TRUE;
     } else if (inputState.events & INPUT_CLICK) {
         /* Start new game with current difficulty */
-        SetDifficulty(&gameCtx, gameCtx.difficulty);
-        gameCtx.state = STATE_PLAYING;
-        gameCtx.playerScore = 0;
-        gameCtx.aiScore = 0;
-        ResetBall(&gameCtx);
+        StartRecording();
+        StartMatch(&gameCtx);
+        ResetRewind(&rewindBuffer);
+        RecordRewind(&rewindBuffer, &gameCtx);
         RequestFullRedraw();
+    } else if (key == 'h' || key == 'H') {
+        /* Versus over the serial link: this Amiga plays left */
+        StartLinkMatch(TRUE);
+    } else if (key == 'j' || key == 'J') {
+        StartLinkMatch(FALSE);
     } else if (key == '1') {
         /* Easy difficulty */
         if (gameCtx.difficulty != DIFFICULTY_EASY) {
@@ -311,44 +565,75 @@ static void HandleTitleInput(void)
     }
 }
 
+/* Step back through the rewind history (not in a link match) */
+static void RewindGame(void)
+{
+    GameState state = gameCtx.state;
+
+    if (linkMatch || !Rewind(&rewindBuffer, &gameCtx)) return;
+
+    /* Stay playing or paused, whatever the sample was */
+    gameCtx.state = state;
+    prevBall = gameCtx.ball;
+    prevAIY = gameCtx.aiPaddle.y;
+
+    /* The recording no longer describes this match */
+    StopRecording();
+    RedrawScore();
+}
+
 static void HandlePlayingInput(void)
 {
-    if (inputState.events & INPUT_ESC) {
+    if (netLink && (inputState.events & INPUT_ESC)) {
+        /* A link match cannot pause: leave it */
+        EndLinkMatch(NULL);
+        linkMatch = FALSE;
+        gameCtx.state = STATE_TITLE;
+        InitGame(&gameCtx);
+        ResetStaticScreen();
+    } else if (inputState.events & INPUT_ESC) {
         gameCtx.state = STATE_PAUSED;
         ResetStaticScreen();
+    } else if (inputState.lastKey == 'r' || inputState.lastKey == 'R') {
+        RewindGame();
     }
 }
 
 static void HandlePausedInput(void)
 {
     if (inputState.events & INPUT_CLICK) {
-        /* Resume game */
+        /* Resume game: only the pause text has to go */
         gameCtx.state = STATE_PLAYING;
-        RequestFullRedraw();
+        HidePauseOverlay();
     } else if (inputState.events & INPUT_ESC) {
         /* Quit to title */
         gameCtx.state = STATE_TITLE;
         InitGame(&gameCtx);
         ResetStaticScreen();
+    } else if (inputState.lastKey == 'r' || inputState.lastKey == 'R') {
+        /* Redraws the paused screen at the earlier state */
+        RewindGame();
     }
 }
 
 static void HandleGameOverInput(void)
 {
     if (inputState.events & INPUT_CLICK) {
-        /* Check for high score */
-        if (PlayerWon(&gameCtx) && IsHighScore(&highScores, gameCtx.playerScore)) {
+        /* Check for high score (not for beating a person) */
+        if (!linkMatch && PlayerWon(&gameCtx) && IsHighScore(&highScores, gameCtx.playerScore)) {
             /* Start name entry */
             gameCtx.state = STATE_HIGHSCORE_ENTRY;
-            entryPos = 0;
+            nameEntry.pos = 0;
+            entryFrames = 0;
             {
                 WORD i;
                 for (i = 0; i <= NAME_LENGTH; i++) {
-                    entryName[i] = '\0';
+                    nameEntry.name[i] = '\0';
                 }
             }
         } else {
             /* Return to title */
+            linkMatch = FALSE;
             gameCtx.state = STATE_TITLE;
             InitGame(&gameCtx);
             ResetStaticScreen();
@@ -358,48 +643,62 @@ static void HandleGameOverInput(void)
 
 static void HandleHighScoreEntry(void)
 {
-    UBYTE key = inputState.lastKey;
-
-    if (key == 0) return;
-
-    if (key == 13 || key == 10) {
-        /* Enter pressed - save score */
-        if (entryPos > 0) {
-            AddHighScore(&highScores, entryName, gameCtx.playerScore);
-        }
-        gameCtx.state = STATE_TITLE;
-        InitGame(&gameCtx);
-        ResetStaticScreen();
-    } else if (key == 8 || key == 127) {
-        /* Backspace */
-        if (entryPos > 0) {
-            entryPos--;
-            entryName[entryPos] = '\0';
-            ResetStaticScreen();  /* Redraw to show change */
+    UBYTE key;
+    WORD k;
+
+    /* Every key of the frame, in order: fast typing loses nothing */
+    for (k = 0; k < inputState.keyCount; k++) {
+        key = inputState.keys[k];
+        entryFrames = 0;     /* Cursor shows while typing */
+
+        if (key == 13 || key == 10) {
+            /* Enter pressed - save score */
+            if (nameEntry.pos > 0) {
+                AddHighScore(&highScores, nameEntry.name, gameCtx.playerScore);
+            }
+            gameCtx.state = STATE_TITLE;
+            InitGame(&gameCtx);
+            ResetStaticScreen();
+            return;
+        } else if (key == 8 || key == 127) {
+            /* Backspace */
+            if (nameEntry.pos > 0) {
+                nameEntry.pos--;
+                nameEntry.name[nameEntry.pos] = '\0';
+            }
+        } else if (key >= 32 && key < 127 && nameEntry.pos < NAME_LENGTH) {
+            /* Printable character */
+            nameEntry.name[nameEntry.pos] = (char)key;
+            nameEntry.pos++;
+            nameEntry.name[nameEntry.pos] = '\0';
         }
-    } else if (key >= 32 && key < 127 && entryPos < NAME_LENGTH) {
-        /* Printable character */
-        entryName[entryPos] = (char)key;
-        entryPos++;
-        entryName[entryPos] = '\0';
-        ResetStaticScreen();  /* Redraw to show new character */
     }
 }
 
 static void DrawHighScoreEntry(void)
 {
-    WORD i;
-    char displayName[NAME_LENGTH + 2];
-
     /* Centered text: x = (320 - strlen*8) / 2 */
     DrawText(100, 60, "NEW HIGH SCORE!", COLOR_YELLOW);  /* 15 chars */
     DrawText(96, 90, "Enter your name:", COLOR_WHITE);   /* 16 chars */
+    DrawNameLine();
+    DrawText(84, 170, "Press ENTER to save", COLOR_WHITE); /* 19 chars */
+}
+
+/*
+ * The name typed so far with the cursor after it. DrawText() only
+ * draws the cells that differ from the screen: a key or a blink of the
+ * cursor is one or two 8x8 cells.
+ */
+static void DrawNameLine(void)
+{
+    WORD i;
+    char displayName[NAME_LENGTH + 2];
+    BOOL cursorOn = (entryFrames / CURSOR_BLINK) % 2 == 0;
 
-    /* Build display string with cursor */
     for (i = 0; i < NAME_LENGTH; i++) {
-        if (i < entryPos) {
-            displayName[i] = entryName[i];
-        } else if (i == entryPos) {
+        if (i < nameEntry.pos) {
+            displayName[i] = nameEntry.name[i];
+        } else if (i == nameEntry.pos && cursorOn) {
             displayName[i] = '_';
         } else {
             displayName[i] = '.';
@@ -408,7 +707,6 @@ static void DrawHighScoreEntry(void)
     displayName[NAME_LENGTH] = '\0';
 
     DrawText(128, 120, displayName, COLOR_CYAN);         /* 8 chars */
-    DrawText(84, 170, "Press ENTER to save", COLOR_WHITE); /* 19 chars */
 }
 
 static void DrawHighScoreTable(void)
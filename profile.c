@@ -0,0 +1,357 @@
+/*
+ * profile.c - Frame-time profiler: per-phase histograms
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+#include <dos/dos.h>
+
+#include <proto/dos.h>
+
+#include "profile.h"
+
+/* The whole frame is kept after the phases */
+#define FRAME_SLOT PROFILE_PHASES
+#define SLOTS      (PROFILE_PHASES + 1)
+#define RING_MASK  (PROFILE_RING - 1)
+
+/* Clock ticks to microseconds: (ticks * scale) >> SCALE_SHIFT */
+#define SCALE_SHIFT 12
+
+typedef struct {
+    ULONG count;
+    ULONG minUs;
+    ULONG maxUs;
+    unsigned long long totalUs;
+    ULONG buckets[PROFILE_BUCKETS];
+} PhaseStats;
+
+/* One recent frame: microseconds per slot (up to 65535), and which ran */
+typedef struct {
+    ULONG frame;
+    UWORD us[SLOTS];
+    UWORD ran;
+} FrameRecord;
+
+typedef struct {
+    BPTR file;
+    WORD length;
+    BOOL failed;
+    char line[96];
+} Report;
+
+static const char *slotNames[SLOTS] = {
+    "input", "update", "render", "wait BOVP", "wait TOF", "frame"
+};
+
+static ULONG clockRate = 0;      /* 0 while not profiling */
+static ULONG scale;
+static ULONG maxTicks;           /* Longest span that scales without overflow */
+
+static ULONG beginTicks[PROFILE_PHASES];
+static ULONG frameUs[SLOTS];
+static UWORD ran;                /* Slots timed this frame, one bit each */
+static ULONG frameStart;
+static BOOL inFrame;
+
+static ULONG frames;
+static ULONG overBudget;
+static PhaseStats stats[SLOTS];
+static FrameRecord ring[PROFILE_RING];
+
+/* Spans over about a second (a disk wait) count as a second */
+static ULONG ToMicros(ULONG ticks)
+{
+    if (ticks > maxTicks) ticks = maxTicks;
+    return (ticks * scale) >> SCALE_SHIFT;
+}
+
+BOOL StartProfile(void)
+{
+    WORD i, b;
+
+    clockRate = OpenProfileClock();
+    if (clockRate == 0) return FALSE;
+
+    scale = (1000000UL << SCALE_SHIFT) / clockRate;
+    maxTicks = 0xFFFFFFFFUL / scale;
+
+    for (i = 0; i < SLOTS; i++) {
+        stats[i].count = 0;
+        stats[i].minUs = 0xFFFFFFFFUL;
+        stats[i].maxUs = 0;
+        stats[i].totalUs = 0;
+        for (b = 0; b < PROFILE_BUCKETS; b++) {
+            stats[i].buckets[b] = 0;
+        }
+        frameUs[i] = 0;
+    }
+    ran = 0;
+    inFrame = FALSE;
+    frames = 0;
+    overBudget = 0;
+    return TRUE;
+}
+
+static void AddSample(PhaseStats *s, ULONG us)
+{
+    ULONG bucket = us / PROFILE_BUCKET_US;
+
+    if (bucket >= PROFILE_BUCKETS) bucket = PROFILE_BUCKETS - 1;
+    s->buckets[bucket]++;
+    s->count++;
+    s->totalUs += us;
+    if (us < s->minUs) s->minUs = us;
+    if (us > s->maxUs) s->maxUs = us;
+}
+
+/* Add the frame just finished to the histograms and the ring */
+static void FileFrame(void)
+{
+    FrameRecord *record = &ring[frames & RING_MASK];
+    WORD i;
+
+    record->frame = frames;
+    record->ran = ran;
+    for (i = 0; i < SLOTS; i++) {
+        if (ran & (1 << i)) {
+            AddSample(&stats[i], frameUs[i]);
+        }
+        record->us[i] = (UWORD)(frameUs[i] > 0xFFFF ? 0xFFFF : frameUs[i]);
+        frameUs[i] = 0;
+    }
+    if (record->us[FRAME_SLOT] > PROFILE_BUDGET_US) overBudget++;
+
+    ran = 0;
+    frames++;
+}
+
+void ProfileFrame(void)
+{
+    ULONG now;
+
+    if (clockRate == 0) return;
+
+    now = ReadProfileClock();
+    if (inFrame) {
+        frameUs[FRAME_SLOT] = ToMicros(now - frameStart);
+        ran |= 1 << FRAME_SLOT;
+        FileFrame();
+    }
+    frameStart = now;
+    inFrame = TRUE;
+}
+
+void ProfileBegin(ProfilePhase phase)
+{
+    if (clockRate == 0) return;
+    beginTicks[phase] = ReadProfileClock();
+}
+
+void ProfileEnd(ProfilePhase phase)
+{
+    if (clockRate == 0) return;
+
+    /* A phase run more than once in a frame adds up */
+    frameUs[phase] += ToMicros(ReadProfileClock() - beginTicks[phase]);
+    ran |= 1 << phase;
+}
+
+void StopProfile(void)
+{
+    if (clockRate == 0) return;
+    CloseProfileClock();
+    clockRate = 0;
+}
+
+/* Report text is built by hand (no sprintf) and written a line at a time */
+
+static void PutText(Report *r, const char *text)
+{
+    while (*text && r->length < (WORD)sizeof(r->line) - 1) {
+        r->line[r->length++] = *text++;
+    }
+}
+
+static void PutPadded(Report *r, const char *text, WORD width, BOOL right)
+{
+    WORD length = 0;
+
+    while (text[length]) length++;
+    if (right) {
+        while (length++ < width) PutText(r, " ");
+        PutText(r, text);
+    } else {
+        PutText(r, text);
+        while (length++ < width) PutText(r, " ");
+    }
+}
+
+static void PutNumber(Report *r, ULONG n, WORD width)
+{
+    char digits[12];
+    WORD i = 11;
+
+    digits[i] = '\0';
+    do {
+        digits[--i] = (char)('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    PutPadded(r, digits + i, width, TRUE);
+}
+
+/* Microseconds as milliseconds to two places: "12.34" */
+static void PutMs(Report *r, ULONG us, WORD width)
+{
+    char text[16];
+    ULONG ms = us / 1000;
+    ULONG hundredths = (us % 1000) / 10;
+    WORD i = 12;
+
+    text[15] = '\0';
+    text[14] = (char)('0' + hundredths % 10);
+    text[13] = (char)('0' + hundredths / 10);
+    text[12] = '.';
+    do {
+        text[--i] = (char)('0' + ms % 10);
+        ms /= 10;
+    } while (ms > 0);
+    PutPadded(r, text + i, width, TRUE);
+}
+
+static void EndLine(Report *r)
+{
+    r->line[r->length++] = '\n';
+    if (Write(r->file, r->line, r->length) != r->length) {
+        r->failed = TRUE;
+    }
+    r->length = 0;
+}
+
+/* Upper edge of the bucket that 99% of samples fall in, or the max */
+static ULONG Percentile99(const PhaseStats *s)
+{
+    ULONG wanted = s->count - s->count / 100;
+    ULONG seen = 0;
+    ULONG edge;
+    WORD b;
+
+    for (b = 0; b < PROFILE_BUCKETS - 1; b++) {
+        seen += s->buckets[b];
+        if (seen >= wanted) {
+            edge = (ULONG)(b + 1) * PROFILE_BUCKET_US;
+            return edge < s->maxUs ? edge : s->maxUs;
+        }
+    }
+    return s->maxUs;
+}
+
+static void WriteSummary(Report *r)
+{
+    WORD i;
+
+    PutText(r, "Pong frame profile: ");
+    PutNumber(r, frames, 0);
+    PutText(r, " frames, ");
+    PutNumber(r, overBudget, 0);
+    PutText(r, " over the ");
+    PutMs(r, PROFILE_BUDGET_US, 0);
+    PutText(r, " ms budget");
+    EndLine(r);
+    EndLine(r);
+
+    PutText(r, "phase         count   min ms   avg ms   p99 ms   max ms");
+    EndLine(r);
+    for (i = 0; i < SLOTS; i++) {
+        const PhaseStats *s = &stats[i];
+
+        PutPadded(r, slotNames[i], 10, FALSE);
+        PutNumber(r, s->count, 9);
+        if (s->count > 0) {
+            PutMs(r, s->minUs, 9);
+            PutMs(r, (ULONG)(s->totalUs / s->count), 9);
+            PutMs(r, Percentile99(s), 9);
+            PutMs(r, s->maxUs, 9);
+        }
+        EndLine(r);
+    }
+    PutText(r, "(render includes the waits)");
+    EndLine(r);
+}
+
+static void WriteHistogram(Report *r)
+{
+    const PhaseStats *s = &stats[FRAME_SLOT];
+    WORD b;
+
+    EndLine(r);
+    PutText(r, "frame ms          frames");
+    EndLine(r);
+    for (b = 0; b < PROFILE_BUCKETS; b++) {
+        if (s->buckets[b] == 0) continue;
+
+        PutMs(r, (ULONG)b * PROFILE_BUCKET_US, 6);
+        if (b < PROFILE_BUCKETS - 1) {
+            PutText(r, " -");
+            PutMs(r, (ULONG)(b + 1) * PROFILE_BUCKET_US, 6);
+        } else {
+            PutText(r, " and up");
+        }
+        PutNumber(r, s->buckets[b], 10);
+        EndLine(r);
+    }
+}
+
+/* The frames still in the ring that went over budget, phase by phase */
+static void WriteSlowFrames(Report *r)
+{
+    ULONG first = frames > PROFILE_RING ? frames - PROFILE_RING : 0;
+    ULONG f;
+    WORD i;
+
+    EndLine(r);
+    PutText(r, "slow frames of the last ");
+    PutNumber(r, frames - first, 0);
+    PutText(r, " (ms)");
+    EndLine(r);
+    PutText(r, "     frame");
+    for (i = 0; i < SLOTS; i++) {
+        PutPadded(r, slotNames[i], 10, TRUE);
+    }
+    EndLine(r);
+
+    for (f = first; f < frames; f++) {
+        const FrameRecord *record = &ring[f & RING_MASK];
+
+        if (record->us[FRAME_SLOT] <= PROFILE_BUDGET_US) continue;
+
+        PutNumber(r, record->frame, 10);
+        for (i = 0; i < SLOTS; i++) {
+            if (record->ran & (1 << i)) {
+                PutMs(r, record->us[i], 10);
+            } else {
+                PutPadded(r, "-", 10, TRUE);
+            }
+        }
+        EndLine(r);
+    }
+}
+
+BOOL WriteProfile(const char *name)
+{
+    Report r;
+
+    if (clockRate == 0) return FALSE;
+
+    r.file = Open((CONST_STRPTR)name, MODE_NEWFILE);
+    if (!r.file) return FALSE;
+    r.length = 0;
+    r.failed = FALSE;
+
+    WriteSummary(&r);
+    WriteHistogram(&r);
+    WriteSlowFrames(&r);
+
+    Close(r.file);
+    return !r.failed;
+}
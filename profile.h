@@ -0,0 +1,77 @@
+/*
+ * profile.h - Frame-time profiler: per-phase histograms
+ * Amiga Pong - OS-friendly implementation
+ *
+ * Built in with make PROFILE=1 (PONG_PROFILE); otherwise the PROFILE_
+ * macros compile to nothing. Each phase of a frame is timed with the
+ * E clock, and at the end of the frame every phase that ran is added
+ * to its histogram (250 us buckets up to 40 ms) and to a ring of the
+ * most recent frames.
+ * Nothing is allocated. On exit the min/avg/p99/max of each phase,
+ * the frame-time histogram and the recent frames that went over the
+ * 20 ms budget are written to PROFILE_FILE.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <exec/types.h>
+
+#define PROFILE_FILE "PROGDIR:pong.profile"
+
+#define PROFILE_BUDGET_US 20000   /* One PAL frame */
+#define PROFILE_BUCKET_US 250
+#define PROFILE_BUCKETS   160     /* 0-40 ms; the last one takes anything longer */
+#define PROFILE_RING      128     /* Recent frames kept whole, a power of two */
+
+/* Phases of a frame; they may nest (the waits are inside render) */
+typedef enum {
+    PROFILE_INPUT,       /* ProcessInput() */
+    PROFILE_UPDATE,      /* State handling and UpdateGame() */
+    PROFILE_RENDER,      /* RenderFrame(), waits included */
+    PROFILE_WAIT_BOVP,   /* WaitBOVP() before moving the sprites */
+    PROFILE_WAIT_TOF,    /* WaitTOF() */
+    PROFILE_PHASES
+} ProfilePhase;
+
+/* Open the clock and clear the histograms; FALSE if there is no clock */
+BOOL StartProfile(void);
+
+/* A new frame begins: the one before it is added to the histograms */
+void ProfileFrame(void);
+
+void ProfileBegin(ProfilePhase phase);
+void ProfileEnd(ProfilePhase phase);
+
+/* Write the report; FALSE if the file could not be written */
+BOOL WriteProfile(const char *name);
+
+/* Close the clock */
+void StopProfile(void);
+
+/*
+ * Clock source: timer.device's E clock on the Amiga (eclock.c),
+ * clock_gettime() on the host (host/hostclock.c). OpenProfileClock()
+ * returns the ticks per second, or 0 if the clock could not be opened;
+ * each successful open needs a CloseProfileClock(). The overlay in
+ * hud.c reads the same clock.
+ */
+ULONG OpenProfileClock(void);
+ULONG ReadProfileClock(void);
+void CloseProfileClock(void);
+
+#ifdef PONG_PROFILE
+#define PROFILE_START()   StartProfile()
+#define PROFILE_FRAME()   ProfileFrame()
+#define PROFILE_BEGIN(p)  ProfileBegin(p)
+#define PROFILE_END(p)    ProfileEnd(p)
+#define PROFILE_STOP()    (WriteProfile(PROFILE_FILE), StopProfile())
+#else
+#define PROFILE_START()   ((void)0)
+#define PROFILE_FRAME()   ((void)0)
+#define PROFILE_BEGIN(p)  ((void)0)
+#define PROFILE_END(p)    ((void)0)
+#define PROFILE_STOP()    ((void)0)
+#endif
+
+#endif /* PROFILE_H */
@@ -0,0 +1,440 @@
+/*
+ * replay.c - Match recording as a compact input stream
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+#include <dos/dos.h>
+
+#include <proto/exec.h>
+#include <proto/dos.h>
+
+#include "replay.h"
+#include "graphics.h"
+#include "input.h"
+
+/* Mouse Y the delta chain starts from (InitInput()'s) */
+#define REPLAY_START_Y (SCREEN_HEIGHT / 2)
+
+void GetReplayHeader(const GameContext *ctx, ReplayHeader *header)
+{
+    header->version = REPLAY_VERSION;
+    header->difficulty = (UBYTE)ctx->difficulty;
+    header->subStepShift = (UBYTE)ctx->subStepShift;
+    header->keyframeShift = REPLAY_KEYFRAME_SHIFT;
+    header->rng = ctx->rng;
+}
+
+void StartReplay(GameContext *ctx, const ReplayHeader *header)
+{
+    ctx->difficulty = (Difficulty)header->difficulty;
+    ctx->subStepShift = header->subStepShift;
+    ctx->rng = header->rng;
+    StartMatch(ctx);
+}
+
+/* Writer */
+
+static void PutByte(ReplayWriter *writer, UBYTE b)
+{
+    if (writer->used >= REPLAY_RECORD_SIZE) {
+        FlushReplay(writer);
+    }
+    if (writer->used < REPLAY_RECORD_SIZE) {
+        writer->buffer[writer->used++] = b;
+    }
+}
+
+static void PutWord(ReplayWriter *writer, WORD w)
+{
+    PutByte(writer, (UBYTE)((UWORD)w >> 8));
+    PutByte(writer, (UBYTE)w);
+}
+
+static void PutLong(ReplayWriter *writer, ULONG l)
+{
+    PutWord(writer, (WORD)(l >> 16));
+    PutWord(writer, (WORD)l);
+}
+
+static void PutIdle(ReplayWriter *writer)
+{
+    if (writer->idle) {
+        PutByte(writer, writer->idle);
+        writer->idle = 0;
+    }
+}
+
+/* Keyframe for the step about to run from ctx (REPLAY_KEYFRAME_SIZE bytes) */
+static void PutKeyframe(ReplayWriter *writer, const GameContext *ctx)
+{
+    UBYTE image[GAME_IMAGE_SIZE];
+    WORD i;
+
+    PutIdle(writer);
+    writer->keyframes[writer->keyframeCount++] = writer->written + writer->used;
+
+    PutByte(writer, REPLAY_KEYFRAME);
+    PutLong(writer, writer->steps);
+    PutWord(writer, writer->lastY);
+    PackGame(ctx, image);
+    for (i = 0; i < GAME_IMAGE_SIZE; i++) {
+        PutByte(writer, image[i]);
+    }
+}
+
+BOOL OpenReplayWriter(ReplayWriter *writer, CONST_STRPTR name, const ReplayHeader *header)
+{
+    UBYTE *h = writer->buffer;
+    WORD i;
+
+    writer->failed = FALSE;
+    writer->lastY = REPLAY_START_Y;
+    writer->events = 0;
+    writer->idle = 0;
+    writer->used = REPLAY_HEADER_SIZE;
+    writer->written = 0;
+    writer->steps = 0;
+    writer->keyframeCount = 0;
+
+    writer->file = Open(name, MODE_NEWFILE);
+    if (!writer->file) {
+        return FALSE;
+    }
+
+    h[0] = (UBYTE)(REPLAY_MAGIC >> 24);
+    h[1] = (UBYTE)(REPLAY_MAGIC >> 16);
+    h[2] = (UBYTE)(REPLAY_MAGIC >> 8);
+    h[3] = (UBYTE)REPLAY_MAGIC;
+    h[4] = REPLAY_VERSION;
+    h[5] = header->difficulty;
+    h[6] = header->subStepShift;
+    h[7] = REPLAY_KEYFRAME_SHIFT;
+    for (i = 0; i < 8; i++) {
+        h[8 + i] = (UBYTE)(header->rng >> (56 - 8 * i));
+    }
+
+    return TRUE;
+}
+
+void RecordReplayEvents(ReplayWriter *writer, UBYTE events)
+{
+    writer->events |= events & (INPUT_CLICK | INPUT_ESC);
+}
+
+void RecordReplayStep(ReplayWriter *writer, const GameContext *ctx, WORD mouseY)
+{
+    WORD delta = mouseY - writer->lastY;
+    UBYTE b;
+
+    if (!writer->file) return;
+
+    if ((writer->steps & ((1L << REPLAY_KEYFRAME_SHIFT) - 1)) == 0 &&
+        writer->keyframeCount < REPLAY_MAX_KEYFRAMES) {
+        PutKeyframe(writer, ctx);
+    }
+    writer->steps++;
+
+    if (delta == 0 && writer->events == 0) {
+        if (++writer->idle == REPLAY_MAX_RUN) PutIdle(writer);
+        return;
+    }
+    PutIdle(writer);
+
+    b = REPLAY_STEP;
+    if (writer->events & INPUT_CLICK) b |= REPLAY_CLICK;
+    if (writer->events & INPUT_ESC) b |= REPLAY_ESC;
+    writer->events = 0;
+
+    if (delta >= -15 && delta <= 15) {
+        PutByte(writer, (UBYTE)(b | (delta & 0x1F)));
+    } else {
+        PutByte(writer, (UBYTE)(b | REPLAY_ABSOLUTE));
+        PutWord(writer, mouseY);
+    }
+    writer->lastY = mouseY;
+}
+
+BOOL FlushReplay(ReplayWriter *writer)
+{
+    if (!writer->file) return FALSE;
+
+    if (writer->used > 0) {
+        if (Write(writer->file, writer->buffer, writer->used) != writer->used) {
+            writer->failed = TRUE;
+        }
+        writer->written += writer->used;
+    }
+    writer->used = 0;
+    return !writer->failed;
+}
+
+BOOL CloseReplayWriter(ReplayWriter *writer)
+{
+    ULONG indexOffset;
+    UWORD k;
+    BOOL ok;
+
+    if (!writer->file) return FALSE;
+
+    PutIdle(writer);
+    PutByte(writer, REPLAY_END);
+
+    /* Trailing index and footer */
+    indexOffset = writer->written + writer->used;
+    for (k = 0; k < writer->keyframeCount; k++) {
+        PutLong(writer, writer->keyframes[k]);
+    }
+    PutLong(writer, indexOffset);
+    PutLong(writer, writer->keyframeCount);
+    PutLong(writer, REPLAY_INDEX_MAGIC);
+
+    ok = FlushReplay(writer);
+
+    Close(writer->file);
+    writer->file = 0;
+    return ok;
+}
+
+/* Reader */
+
+/* Next stream byte, refilling from the file; -1 at the end */
+static WORD GetByte(ReplayReader *reader)
+{
+    if (reader->pos >= reader->size) {
+        if (!reader->file) return -1;
+        reader->size = Read(reader->file, reader->buffer, REPLAY_BUFFER_SIZE);
+        reader->pos = 0;
+        if (reader->size <= 0) {
+            reader->size = 0;
+            return -1;
+        }
+    }
+    return reader->data[reader->pos++];
+}
+
+static BOOL GetWord(ReplayReader *reader, WORD *w)
+{
+    WORD hi = GetByte(reader);
+    WORD lo = GetByte(reader);
+
+    if (hi < 0 || lo < 0) return FALSE;
+    *w = (WORD)((hi << 8) | lo);
+    return TRUE;
+}
+
+static BOOL GetLong(ReplayReader *reader, ULONG *l)
+{
+    WORD hi, lo;
+
+    if (!GetWord(reader, &hi) || !GetWord(reader, &lo)) return FALSE;
+    *l = ((ULONG)(UWORD)hi << 16) | (UWORD)lo;
+    return TRUE;
+}
+
+/* Carry on reading from a file offset */
+static BOOL Reposition(ReplayReader *reader, ULONG offset)
+{
+    if (!reader->file) {
+        reader->pos = (LONG)offset;
+        return reader->pos <= reader->size;
+    }
+    reader->pos = 0;
+    reader->size = 0;
+    return Seek(reader->file, (LONG)offset, OFFSET_BEGINNING) >= 0;
+}
+
+/* Size of the whole replay */
+static LONG ReplaySize(ReplayReader *reader)
+{
+    if (!reader->file) return reader->size;
+    if (Seek(reader->file, 0, OFFSET_END) < 0) return -1;
+    return Seek(reader->file, 0, OFFSET_BEGINNING);
+}
+
+/*
+ * Keyframe body, the marker already read: the step it is for, the
+ * mouse Y the deltas continue from and, if ctx is given, the state
+ */
+static BOOL GetKeyframe(ReplayReader *reader, ULONG *step, GameContext *ctx)
+{
+    UBYTE image[GAME_IMAGE_SIZE];
+    WORD lastY, b, i;
+
+    if (!GetLong(reader, step) || !GetWord(reader, &lastY)) return FALSE;
+    for (i = 0; i < GAME_IMAGE_SIZE; i++) {
+        if ((b = GetByte(reader)) < 0) return FALSE;
+        image[i] = (UBYTE)b;
+    }
+
+    reader->mouseY = lastY;
+    if (ctx) UnpackGame(ctx, image);
+    return TRUE;
+}
+
+static BOOL ReadHeader(ReplayReader *reader, ReplayHeader *header)
+{
+    UBYTE h[REPLAY_HEADER_SIZE];
+    ULONG magic;
+    WORD i, b;
+
+    for (i = 0; i < REPLAY_HEADER_SIZE; i++) {
+        if ((b = GetByte(reader)) < 0) return FALSE;
+        h[i] = (UBYTE)b;
+    }
+
+    magic = ((ULONG)h[0] << 24) | ((ULONG)h[1] << 16) | ((ULONG)h[2] << 8) | h[3];
+    if (magic != REPLAY_MAGIC || h[4] < 1 || h[4] > REPLAY_VERSION ||
+        h[5] > DIFFICULTY_HARD || h[6] > MAX_SUBSTEP_SHIFT) {
+        return FALSE;
+    }
+    /* Keyframe steps are step >> shift: only the shifts we write */
+    if (h[4] >= 2 && (h[7] < 1 || h[7] > REPLAY_KEYFRAME_SHIFT)) {
+        return FALSE;
+    }
+
+    header->version = h[4];
+    header->difficulty = h[5];
+    header->subStepShift = h[6];
+    header->keyframeShift = (h[4] >= 2) ? h[7] : 0;
+    header->rng = 0;
+    for (i = 0; i < 8; i++) {
+        header->rng = (header->rng << 8) | h[8 + i];
+    }
+
+    reader->header = *header;
+    reader->mouseY = REPLAY_START_Y;
+    reader->idle = 0;
+    reader->done = FALSE;
+    return TRUE;
+}
+
+BOOL OpenReplayReader(ReplayReader *reader, CONST_STRPTR name, ReplayHeader *header)
+{
+    reader->data = reader->buffer;
+    reader->pos = 0;
+    reader->size = 0;
+
+    reader->file = Open(name, MODE_OLDFILE);
+    if (!reader->file) {
+        return FALSE;
+    }
+    if (!ReadHeader(reader, header)) {
+        CloseReplayReader(reader);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL OpenReplayMemory(ReplayReader *reader, const UBYTE *data, LONG size, ReplayHeader *header)
+{
+    reader->file = 0;
+    reader->data = data;
+    reader->pos = 0;
+    reader->size = size;
+
+    return ReadHeader(reader, header);
+}
+
+BOOL ReadReplayStep(ReplayReader *reader, WORD *mouseY, UBYTE *events)
+{
+    ULONG step;
+    WORD b;
+
+    *events = 0;
+
+    while (reader->idle == 0) {
+        if (reader->done || (b = GetByte(reader)) <= REPLAY_END) {
+            reader->done = TRUE;
+            return FALSE;
+        }
+
+        if (b == REPLAY_KEYFRAME) {
+            /* Only seeking needs the state; playback just steps over it */
+            if (!GetKeyframe(reader, &step, NULL)) {
+                reader->done = TRUE;
+                return FALSE;
+            }
+            continue;
+        }
+
+        if (b & REPLAY_STEP) {
+            if (b & REPLAY_CLICK) *events |= INPUT_CLICK;
+            if (b & REPLAY_ESC) *events |= INPUT_ESC;
+
+            if ((b & 0x1F) == REPLAY_ABSOLUTE) {
+                if (!GetWord(reader, &reader->mouseY)) {
+                    reader->done = TRUE;
+                    return FALSE;
+                }
+            } else {
+                /* Sign-extend the 5-bit delta */
+                reader->mouseY += (WORD)(((b & 0x1F) ^ 0x10) - 0x10);
+            }
+            *mouseY = reader->mouseY;
+            return TRUE;
+        }
+
+        reader->idle = (UBYTE)b;
+    }
+
+    reader->idle--;
+    *mouseY = reader->mouseY;
+    return TRUE;
+}
+
+/* File offset of keyframe k, or of the last one if there are fewer */
+static BOOL FindKeyframe(ReplayReader *reader, ULONG k, ULONG *offset)
+{
+    LONG size = ReplaySize(reader);
+    ULONG indexOffset, count, magic;
+
+    if (size < REPLAY_HEADER_SIZE + REPLAY_FOOTER_SIZE ||
+        !Reposition(reader, (ULONG)(size - REPLAY_FOOTER_SIZE)) ||
+        !GetLong(reader, &indexOffset) || !GetLong(reader, &count) ||
+        !GetLong(reader, &magic) || magic != REPLAY_INDEX_MAGIC || count == 0) {
+        return FALSE;
+    }
+
+    if (k >= count) k = count - 1;
+    return Reposition(reader, indexOffset + 4 * k) && GetLong(reader, offset);
+}
+
+LONG SeekReplay(ReplayReader *reader, GameContext *ctx, LONG step)
+{
+    ULONG offset, reached = 0;
+    WORD mouseY;
+    UBYTE events;
+    BOOL restored = FALSE;
+
+    reader->idle = 0;
+    reader->done = FALSE;
+
+    if (reader->header.keyframeShift &&
+        FindKeyframe(reader, (ULONG)step >> reader->header.keyframeShift, &offset) &&
+        Reposition(reader, offset) && GetByte(reader) == REPLAY_KEYFRAME) {
+        restored = GetKeyframe(reader, &reached, ctx);
+    }
+
+    if (!restored) {
+        /* No usable index: simulate from the start */
+        Reposition(reader, REPLAY_HEADER_SIZE);
+        reader->mouseY = REPLAY_START_Y;
+        StartReplay(ctx, &reader->header);
+        reached = 0;
+    }
+
+    while ((LONG)reached < step && ReadReplayStep(reader, &mouseY, &events)) {
+        UpdateGame(ctx, mouseY);
+        reached++;
+    }
+    return (LONG)reached;
+}
+
+void CloseReplayReader(ReplayReader *reader)
+{
+    if (reader->file) {
+        Close(reader->file);
+        reader->file = 0;
+    }
+}
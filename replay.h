@@ -0,0 +1,153 @@
+/*
+ * replay.h - Match recording as a compact input stream
+ * Amiga Pong - OS-friendly implementation
+ *
+ * A replay is a 16-byte header followed by one entry per simulation
+ * step, holding the mouse Y that step was run with and the INPUT_CLICK
+ * and INPUT_ESC events seen since the previous step:
+ *
+ *   0x00              end of the stream
+ *   0x01-0x7E         that many steps with no events and the mouse still
+ *   0x7F              a keyframe (below), then the stream carries on
+ *   1 c e d d d d d   one step: c = INPUT_CLICK, e = INPUT_ESC, and the
+ *                     mouse Y change as a 5-bit signed delta (-15..15);
+ *                     a delta of -16 means the absolute Y follows as a
+ *                     big-endian WORD
+ *
+ * Every 1 << keyframeShift steps, before the step is stored, comes a
+ * keyframe: the step number, the mouse Y the deltas continue from and
+ * the whole GameContext (ball values in 1/64 pixels, as in both FIXED
+ * formats). After the end byte a trailing index gives each keyframe's
+ * file offset, and a 12-byte footer gives the index's offset, the
+ * keyframe count and REPLAY_INDEX_MAGIC. Keyframe k is step k << shift,
+ * so SeekReplay() reaches any step with three reads and at most one
+ * keyframe interval of simulation, however long the recording is.
+ *
+ * An 11-point match is a few thousand steps, so a replay is a few
+ * kilobytes even with the mouse moving all the time. Everything is
+ * big-endian, so a replay recorded on the Amiga plays back anywhere.
+ *
+ * Playing a replay back means StartReplay() and then one UpdateGame()
+ * per step with the recorded mouse Y; the events only say where the
+ * player paused and resumed. Version 1 replays (no keyframes or index)
+ * still play; seeking in them starts from the first step.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <exec/types.h>
+#include <dos/dos.h>
+#include "game.h"
+
+#define REPLAY_MAGIC       0x50524550  /* 'PREP' */
+#define REPLAY_INDEX_MAGIC 0x50494458  /* 'PIDX' */
+#define REPLAY_VERSION     2
+
+/* Where the game records the last match played */
+#define REPLAY_FILE "PROGDIR:pong.replay"
+
+#define REPLAY_HEADER_SIZE   16
+#define REPLAY_FOOTER_SIZE   12
+#define REPLAY_KEYFRAME_SIZE (7 + GAME_IMAGE_SIZE)  /* Marker byte included */
+#define REPLAY_BUFFER_SIZE   4096   /* Reader */
+#define REPLAY_RECORD_SIZE   16384  /* Writer: a whole match, see below */
+
+/* A keyframe every 1024 steps (about 20 s); 1024 of them cover 5.8 hours */
+#define REPLAY_KEYFRAME_SHIFT 10
+#define REPLAY_MAX_KEYFRAMES  1024
+
+/* Stream bytes */
+#define REPLAY_END      0x00
+#define REPLAY_MAX_RUN  0x7E
+#define REPLAY_KEYFRAME 0x7F
+#define REPLAY_STEP     0x80
+#define REPLAY_CLICK    0x40
+#define REPLAY_ESC      0x20
+#define REPLAY_ABSOLUTE 0x10        /* The -16 delta */
+
+/* What a match depends on besides its input (see StartMatch()) */
+typedef struct {
+    UBYTE version;
+    UBYTE difficulty;
+    UBYTE subStepShift;
+    UBYTE keyframeShift; /* 1..REPLAY_KEYFRAME_SHIFT; 0 in version 1: no keyframes */
+    RandomState rng;
+} ReplayHeader;
+
+/*
+ * Buffered writer: steps collect in memory and only reach the file on
+ * FlushReplay(), which the game calls when play stops (pause or the
+ * end of the match). The buffer holds about 15000 steps with the mouse
+ * always moving, keyframes included: five minutes of play, where an
+ * 11-point match comes to about 7 KB. Only a longer stretch without a
+ * pause fills it, and then it is written out mid-play.
+ */
+typedef struct {
+    BPTR file;
+    BOOL failed;         /* A write went wrong; the replay is incomplete */
+    WORD lastY;
+    UBYTE events;        /* Events waiting for the next step */
+    UBYTE idle;          /* Idle steps not yet written */
+    UWORD used;
+    ULONG written;       /* Bytes already in the file */
+    ULONG steps;
+    UWORD keyframeCount;
+    ULONG keyframes[REPLAY_MAX_KEYFRAMES];   /* File offsets */
+    UBYTE buffer[REPLAY_RECORD_SIZE];
+} ReplayWriter;
+
+/* Streaming reader over a file or a block of memory */
+typedef struct {
+    BPTR file;           /* 0 when reading from memory */
+    const UBYTE *data;
+    LONG pos;
+    LONG size;
+    WORD mouseY;
+    UBYTE idle;          /* Idle steps still to hand out */
+    BOOL done;
+    ReplayHeader header;
+    UBYTE buffer[REPLAY_BUFFER_SIZE];
+} ReplayReader;
+
+/* Header for a match about to be started from ctx with StartMatch() */
+void GetReplayHeader(const GameContext *ctx, ReplayHeader *header);
+
+/* Start ctx on the match a header describes, as StartMatch() did */
+void StartReplay(GameContext *ctx, const ReplayHeader *header);
+
+/* Create a replay file and write its header */
+BOOL OpenReplayWriter(ReplayWriter *writer, CONST_STRPTR name, const ReplayHeader *header);
+
+/* Note input events; they are stored with the next step */
+void RecordReplayEvents(ReplayWriter *writer, UBYTE events);
+
+/* Record one simulation step about to be run from ctx with this mouse Y */
+void RecordReplayStep(ReplayWriter *writer, const GameContext *ctx, WORD mouseY);
+
+/* Write out everything recorded so far; FALSE if any write failed */
+BOOL FlushReplay(ReplayWriter *writer);
+
+/* End the stream, write the index, flush and close; FALSE if incomplete */
+BOOL CloseReplayWriter(ReplayWriter *writer);
+
+/* Open a replay file and read its header; FALSE if it is not one */
+BOOL OpenReplayReader(ReplayReader *reader, CONST_STRPTR name, ReplayHeader *header);
+
+/* Read a replay held in memory (the data must outlive the reader) */
+BOOL OpenReplayMemory(ReplayReader *reader, const UBYTE *data, LONG size, ReplayHeader *header);
+
+/* Next step's mouse Y and events; FALSE at the end of the stream */
+BOOL ReadReplayStep(ReplayReader *reader, WORD *mouseY, UBYTE *events);
+
+/*
+ * Put ctx in the state it had just before the given step (0 = the
+ * match start) and leave the reader there, by restoring the nearest
+ * keyframe at or before it and simulating the rest. Returns the step
+ * reached, which is short of the one asked for if the replay ends first.
+ */
+LONG SeekReplay(ReplayReader *reader, GameContext *ctx, LONG step);
+
+void CloseReplayReader(ReplayReader *reader);
+
+#endif /* REPLAY_H */
@@ -0,0 +1,151 @@
+/*
+ * rewind.c - Rewind history as a ring of XOR deltas
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+
+#include "rewind.h"
+
+#define RING_MASK (REWIND_BUFFER_SIZE - 1)
+
+/* Longest token stream: every byte changed, 15 to a token */
+#define MAX_DELTA (GAME_IMAGE_SIZE + (GAME_IMAGE_SIZE + 14) / 15)
+
+void ResetRewind(RewindBuffer *r)
+{
+    r->hasHead = FALSE;
+    r->sinceSample = 0;
+    r->start = 0;
+    r->end = 0;
+    r->used = 0;
+    r->entries = 0;
+    r->recorded = 0;
+}
+
+/* Run-length code the XOR of two images; returns the token bytes used */
+static WORD EncodeDelta(const UBYTE *from, const UBYTE *to, UBYTE *out)
+{
+    WORD i = 0, n = 0, skip, lit;
+
+    for (;;) {
+        skip = 0;
+        while (i < GAME_IMAGE_SIZE && from[i] == to[i] && skip < 15) {
+            i++;
+            skip++;
+        }
+        if (i == GAME_IMAGE_SIZE) break;     /* Nothing left that changed */
+
+        lit = 0;
+        while (i + lit < GAME_IMAGE_SIZE && from[i + lit] != to[i + lit] && lit < 15) {
+            lit++;
+        }
+        out[n++] = (UBYTE)((skip << 4) | lit);
+        while (lit-- > 0) {
+            out[n++] = from[i] ^ to[i];
+            i++;
+        }
+    }
+    return n;
+}
+
+static void ApplyDelta(UBYTE *image, const UBYTE *tokens, WORD length)
+{
+    WORD i = 0, n = 0, lit;
+
+    while (n < length) {
+        UBYTE t = tokens[n++];
+
+        i += t >> 4;
+        for (lit = t & 15; lit > 0 && n < length; lit--) {
+            if (i < GAME_IMAGE_SIZE) image[i] ^= tokens[n];
+            i++;
+            n++;
+        }
+    }
+}
+
+static void DropOldest(RewindBuffer *r)
+{
+    WORD size = r->ring[r->start] + 2;
+
+    r->start = (UWORD)((r->start + size) & RING_MASK);
+    r->used -= size;
+    r->entries--;
+}
+
+static void PushDelta(RewindBuffer *r, const UBYTE *tokens, WORD length)
+{
+    WORD i;
+
+    while (r->used + length + 2 > REWIND_BUFFER_SIZE) {
+        DropOldest(r);
+    }
+
+    r->ring[r->end] = (UBYTE)length;
+    for (i = 0; i < length; i++) {
+        r->ring[(r->end + 1 + i) & RING_MASK] = tokens[i];
+    }
+    r->ring[(r->end + 1 + length) & RING_MASK] = (UBYTE)length;
+
+    r->end = (UWORD)((r->end + length + 2) & RING_MASK);
+    r->used += length + 2;
+    r->entries++;
+    r->recorded += length + 2;
+}
+
+/* Take the newest delta off the ring and step the head back over it */
+static void PopDelta(RewindBuffer *r)
+{
+    UBYTE tokens[MAX_DELTA];
+    WORD length = r->ring[(r->end - 1) & RING_MASK];
+    UWORD first = (UWORD)((r->end - 1 - length) & RING_MASK);
+    WORD i;
+
+    for (i = 0; i < length; i++) {
+        tokens[i] = r->ring[(first + i) & RING_MASK];
+    }
+    ApplyDelta(r->head, tokens, length);
+
+    r->end = (UWORD)((r->end - length - 2) & RING_MASK);
+    r->used -= length + 2;
+    r->entries--;
+}
+
+void RecordRewind(RewindBuffer *r, const GameContext *ctx)
+{
+    UBYTE image[GAME_IMAGE_SIZE];
+    UBYTE tokens[MAX_DELTA];
+    WORD i;
+
+    if (r->hasHead && ++r->sinceSample < REWIND_INTERVAL) return;
+
+    PackGame(ctx, image);
+    if (r->hasHead) {
+        PushDelta(r, tokens, EncodeDelta(r->head, image, tokens));
+    }
+    for (i = 0; i < GAME_IMAGE_SIZE; i++) {
+        r->head[i] = image[i];
+    }
+    r->hasHead = TRUE;
+    r->sinceSample = 0;
+}
+
+BOOL Rewind(RewindBuffer *r, GameContext *ctx)
+{
+    if (!r->hasHead) return FALSE;
+
+    if (r->sinceSample == 0) {
+        if (r->entries == 0) return FALSE;
+        PopDelta(r);
+    }
+    UnpackGame(ctx, r->head);
+    r->sinceSample = 0;
+    return TRUE;
+}
+
+LONG RewindSteps(const RewindBuffer *r)
+{
+    if (!r->hasHead) return 0;
+    return (LONG)r->entries * REWIND_INTERVAL + r->sinceSample;
+}
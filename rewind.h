@@ -0,0 +1,59 @@
+/*
+ * rewind.h - Rewind history as a ring of XOR deltas
+ * Amiga Pong - OS-friendly implementation
+ *
+ * Every REWIND_INTERVAL steps the game is packed (PackGame()) and
+ * XORed against the previous sample. Most of the 54 bytes do not
+ * change in a fifth of a second, so the delta is run-length coded:
+ * each token byte is ssss llll, skip s unchanged bytes and then XOR
+ * the l bytes that follow. A sample comes to about 15 bytes, some 5 KB
+ * a minute.
+ *
+ * Only the newest sample is kept whole. XOR undoes itself, so stepping
+ * back is that sample XORed with the newest delta, which is then
+ * dropped; nothing is ever decoded forward, and the oldest deltas can
+ * be thrown away when the ring is full without losing anything newer.
+ * Each entry in the ring is its token length, the tokens and the
+ * length again, so it can be walked from either end.
+ */
+
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <exec/types.h>
+#include "game.h"
+
+/* Ring size, a power of two: about a minute and a half of play */
+#define REWIND_BUFFER_SIZE 8192
+
+/* Steps between samples: a rewind goes back a fifth of a second */
+#define REWIND_INTERVAL 10
+
+typedef struct {
+    UBYTE head[GAME_IMAGE_SIZE];  /* Newest sample, whole */
+    BOOL hasHead;
+    WORD sinceSample;    /* Steps run since the newest sample */
+    UWORD start;         /* Oldest entry in the ring */
+    UWORD end;           /* Just past the newest one */
+    UWORD used;          /* Bytes in use */
+    UWORD entries;
+    ULONG recorded;      /* Bytes ever added, for measuring */
+    UBYTE ring[REWIND_BUFFER_SIZE];
+} RewindBuffer;
+
+/* Forget all history (a new match) */
+void ResetRewind(RewindBuffer *r);
+
+/* Note the state after a step; every REWIND_INTERVAL steps it is kept */
+void RecordRewind(RewindBuffer *r, const GameContext *ctx);
+
+/*
+ * Put ctx back to the newest sample, or the one before it if no step
+ * has run since. FALSE if there is nothing further back.
+ */
+BOOL Rewind(RewindBuffer *r, GameContext *ctx);
+
+/* How far back the history reaches, in steps */
+LONG RewindSteps(const RewindBuffer *r);
+
+#endif /* REWIND_H */
@@ -0,0 +1,130 @@
+/*
+ * serial.c - Netplay link over serial.device (null-modem cable)
+ * Amiga Pong - OS-friendly implementation
+ *
+ * Reads never wait: SDCMD_QUERY says how much the device has
+ * buffered and only that much is read. Writes go out asynchronously
+ * from a copy; the next write first waits for the previous one, which
+ * at one packet a frame has long finished.
+ */
+
+#include <exec/types.h>
+#include <exec/memory.h>
+#include <exec/io.h>
+#include <devices/serial.h>
+
+#include <proto/exec.h>
+
+#include "link.h"
+
+/* Device read buffer: a second of packets with plenty to spare */
+#define SERIAL_BUFFER_SIZE 4096
+
+struct NetLink {
+    struct MsgPort *readPort;
+    struct MsgPort *writePort;
+    struct IOExtSer *read;
+    struct IOExtSer *write;
+    BOOL open;           /* Device opened */
+    BOOL writing;        /* A write is in flight */
+    UBYTE out[LINK_WRITE_SIZE];
+};
+
+struct NetLink *OpenSerialLink(ULONG baud)
+{
+    struct NetLink *link;
+
+    link = (struct NetLink *)AllocVec(sizeof(struct NetLink), MEMF_PUBLIC | MEMF_CLEAR);
+    if (!link) return NULL;
+
+    link->readPort = CreateMsgPort();
+    link->writePort = CreateMsgPort();
+    if (link->readPort && link->writePort) {
+        link->read = (struct IOExtSer *)CreateIORequest(link->readPort, sizeof(struct IOExtSer));
+        link->write = (struct IOExtSer *)CreateIORequest(link->writePort, sizeof(struct IOExtSer));
+    }
+    if (!link->read || !link->write) {
+        CloseLink(link);
+        return NULL;
+    }
+
+    /* No XON/XOFF: the packets are binary */
+    link->read->io_SerFlags = SERF_XDISABLED;
+    if (OpenDevice(SERIALNAME, 0, (struct IORequest *)link->read, 0) != 0) {
+        CloseLink(link);
+        return NULL;
+    }
+    link->open = TRUE;
+
+    link->read->io_Baud = baud;
+    link->read->io_RBufLen = SERIAL_BUFFER_SIZE;
+    link->read->io_ReadLen = 8;
+    link->read->io_WriteLen = 8;
+    link->read->io_StopBits = 1;
+    link->read->io_SerFlags = SERF_XDISABLED | SERF_RAD_BOOGIE;
+    link->read->IOSer.io_Command = SDCMD_SETPARAMS;
+    if (DoIO((struct IORequest *)link->read) != 0) {
+        CloseLink(link);
+        return NULL;
+    }
+
+    /* The write request shares the opened unit, with its own reply port */
+    CopyMem(link->read, link->write, sizeof(struct IOExtSer));
+    link->write->IOSer.io_Message.mn_ReplyPort = link->writePort;
+
+    return link;
+}
+
+LONG SendLink(struct NetLink *link, const UBYTE *data, LONG length)
+{
+    if (length > LINK_WRITE_SIZE) return -1;
+
+    if (link->writing) {
+        link->writing = FALSE;
+        if (WaitIO((struct IORequest *)link->write) != 0) return -1;
+    }
+
+    CopyMem((APTR)data, link->out, (ULONG)length);
+    link->write->IOSer.io_Command = CMD_WRITE;
+    link->write->IOSer.io_Data = link->out;
+    link->write->IOSer.io_Length = (ULONG)length;
+    SendIO((struct IORequest *)link->write);
+    link->writing = TRUE;
+    return length;
+}
+
+LONG ReceiveLink(struct NetLink *link, UBYTE *buffer, LONG size)
+{
+    struct IOExtSer *io = link->read;
+    ULONG waiting;
+
+    io->IOSer.io_Command = SDCMD_QUERY;
+    if (DoIO((struct IORequest *)io) != 0) return -1;
+
+    waiting = io->IOSer.io_Actual;
+    if (waiting == 0 || size <= 0) return 0;
+    if (waiting > (ULONG)size) waiting = (ULONG)size;
+
+    io->IOSer.io_Command = CMD_READ;
+    io->IOSer.io_Data = buffer;
+    io->IOSer.io_Length = waiting;
+    if (DoIO((struct IORequest *)io) != 0) return -1;
+    return (LONG)io->IOSer.io_Actual;
+}
+
+void CloseLink(struct NetLink *link)
+{
+    if (!link) return;
+
+    if (link->writing) {
+        WaitIO((struct IORequest *)link->write);
+    }
+    if (link->open) {
+        CloseDevice((struct IORequest *)link->read);
+    }
+    if (link->write) DeleteIORequest((struct IORequest *)link->write);
+    if (link->read) DeleteIORequest((struct IORequest *)link->read);
+    if (link->writePort) DeleteMsgPort(link->writePort);
+    if (link->readPort) DeleteMsgPort(link->readPort);
+    FreeVec(link);
+}
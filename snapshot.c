@@ -0,0 +1,28 @@
+/*
+ * snapshot.c - Whole-game snapshots for savestates, rewind and rollback
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+
+#include "snapshot.h"
+
+void SaveSnapshot(GameSnapshot *snap, const GameContext *ctx, const NameEntry *entry)
+{
+    snap->game = *ctx;
+    snap->entry = *entry;
+    GetRenderState(&snap->render);
+}
+
+void RestoreSnapshot(const GameSnapshot *snap, GameContext *ctx, NameEntry *entry)
+{
+    RenderState render = snap->render;
+
+    *ctx = snap->game;
+    *entry = snap->entry;
+
+    render.lastPlayerScore = -1;
+    render.lastAIScore = -1;
+    render.staticScreenDrawn = FALSE;
+    SetRenderState(&render);
+}
@@ -0,0 +1,37 @@
+/*
+ * snapshot.h - Whole-game snapshots for savestates, rewind and rollback
+ * Amiga Pong - OS-friendly implementation
+ *
+ * A GameSnapshot is everything the game needs to carry on exactly
+ * where it was: the GameContext (RNG and AI settings included), the
+ * name being typed for a high score and what the drawing code thinks
+ * is on screen. It is a fixed-size plain struct with no pointers, so
+ * it can be copied, stored or sent as it is; taking or restoring one
+ * is a few structure copies.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <exec/types.h>
+#include "game.h"
+#include "graphics.h"
+#include "highscore.h"
+
+typedef struct {
+    GameContext game;
+    NameEntry entry;
+    RenderState render;
+} GameSnapshot;
+
+/* Capture the game, name entry and render state */
+void SaveSnapshot(GameSnapshot *snap, const GameContext *ctx, const NameEntry *entry);
+
+/*
+ * Put them all back. The screen still shows whatever was drawn last,
+ * so the score and any static screen are marked for redrawing; the
+ * next frame draws them for the restored state.
+ */
+void RestoreSnapshot(const GameSnapshot *snap, GameContext *ctx, NameEntry *entry);
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,45 @@
+/*
+ * tables.h - Precomputed tables that replace divisions in the game core
+ * Amiga Pong - OS-friendly implementation
+ *
+ * The tables themselves (tables.c) are written at build time by
+ * host/gentables, which checks every entry against the division it
+ * replaces over the whole input domain before emitting anything.
+ *
+ * Rough 68000 costs: DIVU.W 76-140 cycles, DIVS.W 120-158, MULU.W and
+ * MULS.W 38-70, an indexed table read 14-18.
+ */
+
+#ifndef TABLES_H
+#define TABLES_H
+
+#include <exec/types.h>
+
+/*
+ * Intercept predictor reciprocals: recipTable[n] = 65536 / n, where n
+ * is |vx| in 1/16 pixels per frame (entries 0 and 1 saturate at 0xFFFF)
+ */
+#define RECIP_SIZE  256
+extern const UWORD recipTable[RECIP_SIZE];
+
+/*
+ * Paddle spin by hit offset: spinTable[offset + SPIN_RANGE] is
+ * CalculateSpin()'s (offset * 3.0) / (PADDLE_HEIGHT / 2), clamped to
+ * +-3.0, in the FIXED format selected by PONG_FIXED16. Offsets past
+ * +-SPIN_RANGE are saturated already.
+ */
+#define SPIN_RANGE 32
+extern const WORD spinTable[2 * SPIN_RANGE + 1];
+
+/*
+ * Multiply-shift reciprocals for r % d with r < 2^15 (NextRandom()'s
+ * range) and 1 <= d <= MODULO_MAX: q = (r * mul) >> shift is r / d.
+ */
+#define MODULO_MAX 256
+typedef struct {
+    UWORD mul;
+    UWORD shift;
+} DivMagic;
+extern const DivMagic moduloTable[MODULO_MAX + 1];
+
+#endif /* TABLES_H */
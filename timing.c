@@ -0,0 +1,124 @@
+/*
+ * timing.c - Fixed-timestep game clock driven by the vertical blank
+ * Amiga Pong - OS-friendly implementation
+ */
+
+#include <exec/types.h>
+#include <exec/interrupts.h>
+#include <exec/memory.h>
+#include <hardware/intbits.h>
+#include <graphics/gfxbase.h>
+
+#include <proto/exec.h>
+
+#include "timing.h"
+
+extern struct GfxBase *GfxBase;
+
+/* Shared with the interrupt server through is_Data */
+typedef struct {
+    volatile ULONG time;   /* Clock units since InitTiming() */
+    volatile ULONG vblanks;
+    ULONG perVBlank;       /* Units added each vertical blank */
+} VBlankClock;
+
+static struct Interrupt *vblankServer = NULL;
+static VBlankClock *vblankClock = NULL;
+
+/*
+ * Vertical blank server: exec passes is_Data in a1. Returning 0 sets
+ * the Z flag so the servers after this one still run.
+ */
+static LONG VBlankCounter(register VBlankClock *clock __asm("a1"))
+{
+    clock->time += clock->perVBlank;
+    clock->vblanks++;
+    return 0;
+}
+
+BOOL InitTiming(void)
+{
+    vblankServer = (struct Interrupt *)AllocMem(sizeof(struct Interrupt),
+                                                MEMF_PUBLIC | MEMF_CLEAR);
+    vblankClock = (VBlankClock *)AllocMem(sizeof(VBlankClock),
+                                          MEMF_PUBLIC | MEMF_CLEAR);
+    if (!vblankServer || !vblankClock) {
+        CleanupTiming();
+        return FALSE;
+    }
+
+    /* 50 Hz PAL or 60 Hz NTSC frames in 1/300 s units */
+    vblankClock->perVBlank = (GfxBase->DisplayFlags & PAL) ? CLOCK_RATE / 50
+                                                           : CLOCK_RATE / 60;
+
+    vblankServer->is_Node.ln_Type = NT_INTERRUPT;
+    vblankServer->is_Node.ln_Pri = 0;
+    vblankServer->is_Node.ln_Name = "Pong clock";
+    vblankServer->is_Data = (APTR)vblankClock;
+    vblankServer->is_Code = (VOID (*)())VBlankCounter;
+
+    AddIntServer(INTB_VERTB, vblankServer);
+    return TRUE;
+}
+
+void CleanupTiming(void)
+{
+    if (vblankServer && vblankServer->is_Code) {
+        RemIntServer(INTB_VERTB, vblankServer);
+    }
+    if (vblankServer) {
+        FreeMem(vblankServer, sizeof(struct Interrupt));
+        vblankServer = NULL;
+    }
+    if (vblankClock) {
+        FreeMem(vblankClock, sizeof(VBlankClock));
+        vblankClock = NULL;
+    }
+}
+
+ULONG ReadClock(void)
+{
+    return vblankClock ? vblankClock->time : 0;
+}
+
+ULONG ReadVBlankCount(void)
+{
+    return vblankClock ? vblankClock->vblanks : 0;
+}
+
+void ResetFrameClock(FrameClock *clock)
+{
+    clock->lastTime = ReadClock();
+    clock->accumulator = 0;
+}
+
+WORD AdvanceFrameClock(FrameClock *clock)
+{
+    ULONG now = ReadClock();
+    ULONG elapsed = now - clock->lastTime;
+    WORD steps = 0;
+
+    clock->lastTime = now;
+
+    /* Missed vblanks are caught up, but only so far */
+    if (elapsed > MAX_CATCHUP_STEPS * SIM_STEP) {
+        elapsed = MAX_CATCHUP_STEPS * SIM_STEP;
+    }
+    clock->accumulator += (WORD)elapsed;
+
+    /* Step until the simulation has reached or just passed now */
+    while (clock->accumulator > 0 && steps < MAX_CATCHUP_STEPS) {
+        clock->accumulator -= SIM_STEP;
+        steps++;
+    }
+    if (clock->accumulator > 0) {
+        clock->accumulator = 0;
+    }
+
+    return steps;
+}
+
+WORD FrameClockAlpha(const FrameClock *clock)
+{
+    return (WORD)(((clock->accumulator + SIM_STEP) << 8) / SIM_STEP);
+}
@@ -0,0 +1,52 @@
+/*
+ * timing.h - Fixed-timestep game clock driven by the vertical blank
+ * Amiga Pong - OS-friendly implementation
+ *
+ * The game simulates at SIM_RATE steps a second whatever the display
+ * runs at. A vertical blank interrupt server counts time in 1/300 s
+ * units (a PAL frame is 6, an NTSC frame 5), and each display frame
+ * the FrameClock turns the time since the last one into a number of
+ * simulation steps. The simulation runs up to one step ahead of the
+ * display, which shows the sprites interpolated between the last two
+ * steps, so a 50 Hz display sees every step exactly as it was.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <exec/types.h>
+
+#define CLOCK_RATE 300                        /* Clock units per second */
+#define SIM_RATE   50                         /* Simulation steps per second */
+#define SIM_STEP   (CLOCK_RATE / SIM_RATE)    /* Clock units per step */
+
+/* Most steps run in one display frame; time beyond that is dropped */
+#define MAX_CATCHUP_STEPS 4
+
+typedef struct {
+    ULONG lastTime;      /* Clock reading at the last AdvanceFrameClock() */
+    WORD accumulator;    /* Clock units owed to the simulation (<= 0 after a frame) */
+} FrameClock;
+
+/* Install the vertical blank counter; FALSE if it could not be */
+BOOL InitTiming(void);
+
+/* Remove the vertical blank counter */
+void CleanupTiming(void);
+
+/* Time since InitTiming() in clock units */
+ULONG ReadClock(void);
+
+/* Vertical blanks since InitTiming() */
+ULONG ReadVBlankCount(void);
+
+/* Start counting from now (game start or resume) */
+void ResetFrameClock(FrameClock *clock);
+
+/* Simulation steps due this display frame, catch-up included */
+WORD AdvanceFrameClock(FrameClock *clock);
+
+/* Display time between the last two steps, 1-256, for interpolation */
+WORD FrameClockAlpha(const FrameClock *clock);
+
+#endif /* TIMING_H */